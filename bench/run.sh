@@ -0,0 +1,248 @@
+#!/bin/sh
+# bench/run.sh - Run the benchmark suite, and output the results as JSON
+#
+# Each benchmark ('bench/*.ks') is run in a fresh process via 'bench/harness.ks', '-n' times for the
+#   timings (the minimum time and maximum RSS are kept), and once more with allocation tracing. The
+#   startup time of the interpreter is measured as well, as the benchmark 'startup'
+#
+# The output looks like:
+#
+# {
+#   "ks": "bin/ks",
+#   "version": "0.0.1",
+#   "date": "2021-01-01T00:00:00Z",
+#   "runs": 3,
+#   "results": [
+#     {"name": "calls", "time": 0.302101, "rss_kb": 4128, "allocs": 2187834, "alloc_peak": 18584},
+#     ...
+#   ]
+# }
+#
+# Each result is kept on a single line, so results can be compared with line-based tools (see '-c'). Any
+#   other statistics a benchmark records (see 'bench/harness.ks') are added as extra fields, which are
+#   compared as well
+#
+# Usage:
+#   bench/run.sh [-k KS] [-n RUNS] [-o OUT] [-c BASE] [NAME...]
+#   bench/run.sh -c BASE NEW
+#
+# Examples:
+#   # Run all benchmarks, writing results to 'new.json', and comparing to a previous build's results
+#   bench/run.sh -o new.json -c old.json
+#   # Compare two existing result files (no benchmarks are run)
+#   bench/run.sh -c old.json new.json
+#   # Run just the 'calls' and 'dict' benchmarks with another build
+#   bench/run.sh -k ../kscript-other/bin/ks calls dict
+#
+# @author: Cade Brown <cade@kscript.org>
+
+# Directory of the benchmarks
+DIR=`dirname "$0"`
+
+# Interpreter to benchmark
+KS=bin/ks
+
+# Number of runs per benchmark
+RUNS=3
+
+# Output file ('-' for stdout)
+OUT=-
+
+# Results to compare to
+BASE=
+
+
+usage() {
+    echo "Usage: $0 [-k KS] [-n RUNS] [-o OUT] [-c BASE] [NAME...]" >&2
+    echo "       $0 -c BASE NEW" >&2
+    echo "" >&2
+    echo "  -k KS        Interpreter to benchmark (default: $KS)" >&2
+    echo "  -n RUNS      Number of timed runs per benchmark (default: $RUNS)" >&2
+    echo "  -o OUT       Write JSON results to OUT (default: stdout)" >&2
+    echo "  -c BASE      Compare the results to BASE, a previous output" >&2
+    echo "" >&2
+    echo "If 'NAME's are given, only those benchmarks are run (the names are files in '$DIR', without '.ks')" >&2
+    echo "If '-c' is given along with a single '.json' file, then those results are compared and nothing is run" >&2
+    exit 1
+}
+
+while getopts "k:n:o:c:h" opt; do
+    case $opt in
+        k) KS=$OPTARG ;;
+        n) RUNS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        c) BASE=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift `expr $OPTIND - 1`
+
+
+# Print a comparison table of two result files ($1 is the base, $2 is the new results)
+compare() {
+    awk '
+    # Retrieve a numeric field from a single-line JSON object, or "" if it was not given
+    function field(line, key,    s) {
+        if (!match(line, "\"" key "\": *-?[0-9.eE+-]+")) return ""
+        s = substr(line, RSTART, RLENGTH)
+        sub(/^[^:]*: */, "", s)
+        return s
+    }
+    function name(line,    s) {
+        match(line, /"name": *"[^"]*"/)
+        s = substr(line, RSTART, RLENGTH)
+        sub(/^[^:]*: *"/, "", s)
+        sub(/"$/, "", s)
+        return s
+    }
+    function ratio(a, b) {
+        if (a == "" || b == "" || a + 0 <= 0) return "-"
+        return sprintf("%.3fx", b / a)
+    }
+    # Record the extra statistics of a result, in "bs" (base) or "ns" (new)
+    function stats(line, n,    s, k) {
+        s = line
+        while (match(s, /"[A-Za-z0-9_]+": *-?[0-9.eE+-]+/)) {
+            k = substr(s, RSTART + 1, RLENGTH)
+            s = substr(s, RSTART + RLENGTH)
+            sub(/".*/, "", k)
+            if (k == "time" || k == "rss_kb" || k == "allocs" || k == "alloc_peak") continue
+            if (nf == 1) {
+                bs[n, k] = field(line, k)
+            } else {
+                sorder[++ns] = n SUBSEP k
+                nsv[n, k] = field(line, k)
+            }
+        }
+    }
+    FNR == 1 { nf++ }
+    /"name":/ {
+        n = name($0)
+        if (nf == 1) {
+            bt[n] = field($0, "time"); br[n] = field($0, "rss_kb"); ba[n] = field($0, "allocs")
+        } else {
+            order[++nn] = n
+            nt[n] = field($0, "time"); nr[n] = field($0, "rss_kb"); na[n] = field($0, "allocs")
+        }
+        stats($0, n)
+    }
+    END {
+        printf("%-16s %10s %10s %9s %9s %12s %9s\n", "name", "base(s)", "new(s)", "time", "rss", "allocs", "allocs")
+        for (i = 1; i <= nn; i++) {
+            n = order[i]
+            if (!(n in bt)) {
+                printf("%-16s %10s %10.4f %9s %9s %12s %9s\n", n, "-", nt[n], "-", "-", na[n], "-")
+                continue
+            }
+            printf("%-16s %10.4f %10.4f %9s %9s %12s %9s\n", n, bt[n], nt[n], ratio(bt[n], nt[n]), ratio(br[n], nr[n]), na[n], ratio(ba[n], na[n]))
+            if (bt[n] > 0) { lsum += log(nt[n] / bt[n]); lnum++ }
+        }
+        if (lnum > 0) printf("\ngeometric mean of time ratios: %.3fx (<1 is faster)\n", exp(lsum / lnum))
+        if (ns > 0) {
+            printf("\n%-16s %-24s %10s %10s\n", "name", "stat", "base", "new")
+            for (i = 1; i <= ns; i++) {
+                split(sorder[i], p, SUBSEP)
+                printf("%-16s %-24s %10s %10s\n", p[1], p[2], (sorder[i] in bs) ? bs[sorder[i]] : "-", nsv[sorder[i]])
+            }
+        }
+    }
+    ' "$1" "$2"
+}
+
+# Compare only
+if [ "$BASE" != "" ] && [ $# -eq 1 ] && [ -f "$1" ]; then
+    compare "$BASE" "$1"
+    exit $?
+fi
+
+if [ ! -x "$KS" ]; then
+    echo "$0: Interpreter '$KS' was not found (run 'make' first, or pass '-k')" >&2
+    exit 1
+fi
+
+# Retrieve a numeric field from the harness output
+field() {
+    echo "$1" | sed -n "s/.*\"$2\": *\(-\{0,1\}[0-9.]*\).*/\1/p"
+}
+
+# Run the harness for a benchmark, and print the result line
+run_one() {
+    name=$1
+    shift
+    best_t=
+    max_rss=-1
+    i=0
+    while [ $i -lt $RUNS ]; do
+        res=`"$KS" "$DIR/harness.ks" "$@"` || return 1
+        t=`field "$res" time`
+        r=`field "$res" rss_kb`
+        best_t=`awk -v a="$best_t" -v b="$t" 'BEGIN { print (a == "" || b + 0 < a + 0) ? b : a }'`
+        [ "$r" -gt "$max_rss" ] && max_rss=$r
+        i=`expr $i + 1`
+    done
+    # Extra statistics (everything after the standard fields)
+    stats=`echo "$res" | sed -n 's/.*"rss_kb": *-\{0,1\}[0-9]*\(.*\)}$/\1/p'`
+    extra=
+    if [ "$name" != "startup" ]; then
+        res=`"$KS" "$DIR/harness.ks" --mem "$@"` || return 1
+        extra=", \"allocs\": `field "$res" allocs`, \"alloc_peak\": `field "$res" alloc_peak`"
+    fi
+    printf '    {"name": "%s", "time": %s, "rss_kb": %s%s%s}' "$name" "$best_t" "$max_rss" "$extra" "$stats"
+}
+
+# Benchmarks to run
+if [ $# -eq 0 ]; then
+    set -- startup `cd "$DIR" && ls *.ks | grep -v '^harness\.ks$' | sed 's/\.ks$//'`
+fi
+
+TMP=`mktemp "${TMPDIR:-/tmp}/ks-bench.XXXXXX"` || exit 1
+trap 'rm -f "$TMP"' EXIT
+
+{
+    echo "{"
+    echo "  \"ks\": \"$KS\","
+    echo "  \"version\": \"`"$KS" --version 2>&1`\","
+    echo "  \"date\": \"`date -u +%Y-%m-%dT%H:%M:%SZ`\","
+    echo "  \"runs\": $RUNS,"
+    echo "  \"results\": ["
+} > $TMP
+
+sep=
+status=0
+for name in "$@"; do
+    echo "running: $name" >&2
+    if [ "$name" = "startup" ]; then
+        line=`run_one startup --startup "'$KS' -e ''"`
+    else
+        line=`run_one "$name" "$DIR/$name.ks"`
+    fi
+    if [ $? -ne 0 ]; then
+        echo "$0: Benchmark '$name' failed" >&2
+        status=1
+        continue
+    fi
+    printf '%s%s' "$sep" "$line" >> $TMP
+    sep=",
+"
+done
+
+{
+    echo ""
+    echo "  ]"
+    echo "}"
+} >> $TMP
+
+if [ "$OUT" = "-" ]; then
+    cat $TMP
+else
+    mkdir -p `dirname "$OUT"`
+    cp $TMP "$OUT"
+    echo "wrote: $OUT" >&2
+fi
+
+if [ "$BASE" != "" ]; then
+    echo "" >&2
+    compare "$BASE" $TMP >&2
+fi
+
+exit $status
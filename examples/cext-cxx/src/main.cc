@@ -0,0 +1,55 @@
+/* main.cc - main implementation of the 'cxxdemo' package, an example of binding C++ code with 'ks/kscxx.hh'
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+
+#include <ks/kscxx.hh>
+#include <ks/cext.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#define M_NAME "cxxdemo"
+
+/* Module functions (plain C++, whose arguments are converted according to their types) */
+
+static double hyp(double x, double y) {
+    return std::sqrt(x * x + y * y);
+}
+
+static string repeat(const string& s, int n) {
+    if (n < 0) throw std::invalid_argument("'n' must not be negative");
+    string res;
+    for (int i = 0; i < n; ++i) res += s;
+    return res;
+}
+
+/* Return a new array '[0, 1, ..., n-1]', which owns the vector's memory (it isn't copied) */
+static nx_view ramp(int n) {
+    if (n < 0) throw std::invalid_argument("'n' must not be negative");
+    vector<double> res(n);
+    for (int i = 0; i < n; ++i) res[i] = i;
+    return ks::make_array(std::move(res));
+}
+
+/* Return the first element of 'xs', which is held by a 'ks::ref' */
+static ks::ref<> first(ks::ref<ks_list> xs) {
+    if (xs->len < 1) throw std::out_of_range("empty list");
+    return ks::ref<>::borrow(xs->elems[0]);
+}
+
+/* Export */
+
+static ks_module get() {
+    ks_module res = ks::make_module(M_NAME, "", "This module is an example of binding C++ functions with 'ks/kscxx.hh'", {
+        {"hyp",                    KSCXX_WRAP(hyp, M_NAME ".hyp(x, y)", "Computes the hypotenuse of a right triangle with sides 'x' and 'y'")},
+        {"repeat",                 KSCXX_WRAP(repeat, M_NAME ".repeat(s, n)", "Repeat 's', 'n' times")},
+        {"ramp",                   KSCXX_WRAP(ramp, M_NAME ".ramp(n)", "Return an array of the integers up to 'n' (as floats)")},
+        {"first",                  KSCXX_WRAP(first, M_NAME ".first(xs)", "Return the first element of the list 'xs'")},
+    });
+
+    return res;
+}
+
+/* Declares this as a C-style extension */
+KS_CEXT_DECL(get);
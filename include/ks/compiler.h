@@ -447,6 +447,9 @@ typedef struct ks_ast_s {
     /* Token describing the part of the input which the AST represents (from the parser) */
     ks_tok tok;
 
+    /* Arena the AST was allocated in (see 'ks_ast_arena()'), or NULL if it was allocated normally */
+    ks_arena arena;
+
 }* ks_ast;
 
 
@@ -883,7 +886,7 @@ typedef struct ks_code_s {
     /* List of constants that that bytecode object references */
     ks_list vc;
 
-    /* Mapping of constants to their index into 'vc' */
+    /* Mapping of '(type, constant)' to their index into 'vc' (only filled while compiling) */
     ks_dict vc_map;
 
     /* Actual instructions are stored here */
@@ -910,6 +913,9 @@ typedef struct ks_code_s {
 
     }* meta;
 
+    /* Trampoline which executes this code, or NULL if none has been created yet (see 'perf.c') */
+    void* perf_tramp;
+
 }* ks_code;
 
 
@@ -953,6 +959,13 @@ KS_API ks_ast ks_ast_newn(int kind, int n_args, ks_ast* args, kso val, ks_tok to
  */
 KS_API bool ks_ast_is_expr(int kind);
 
+/* Set the arena that new ASTs are allocated in (or NULL to allocate them normally), returning the previous one
+ *
+ * The parser uses this so that a whole program is allocated together, and freed in one shot once it has been
+ *   compiled and released
+ */
+KS_API ks_arena ks_ast_arena(ks_arena arena);
+
 
 
 /* Create a new (empty) code object with the given metadata
@@ -986,6 +999,10 @@ KS_API void ks_code_meta(ks_code self, ks_tok tok);
  */
 KS_API bool ks_code_get_meta(ks_code self, int offset, struct ks_code_meta* meta);
 
+/* Return the name of a bytecode instruction (without the 'KSB_' prefix), or NULL if 'op' is not valid
+ */
+KS_API const char* ks_code_opname(int op);
+
 /* Pushes an AST onto the 'args' list, and merges the tokens
  */
 KS_API void ks_ast_push(ks_ast self, ks_ast sub);
@@ -1024,4 +1041,7 @@ KS_API ks_code ks_compile(ks_str fname, ks_str src, ks_ast prog, ks_code from);
 /* Execute on the current thread's last frame (see 'vm.c' for semantics) */
 KS_API kso _ks_exec(ks_code bc, ks_type _in);
 
+/* Execute 'bc' with 'exec' (i.e. the VM) through its trampoline, creating it if needed (see 'perf.c') */
+KS_API kso _ks_perf_exec(ks_code bc, ks_type _in, kso (*exec)(ks_code bc, ks_type _in));
+
 #endif /* KS_COMPILER_H__ */
@@ -53,6 +53,9 @@ typedef struct ksgram_Token_s {
  *   matches are of the same length, then the one that appeared in the earlier rule takes
  *   precedence.
  * 
+ * The rules are combined into a single regex, so each token is found in one pass over the input, no matter how many
+ *   rules there are
+ * 
  * When a match is found, the corresponding action is ran. The return value is interpreted as:
  *   * 'none': skip this text
  *   * int/enum value: this is a token type, so construct a token from it
@@ -69,28 +72,25 @@ typedef struct ksgram_Lexer_s {
     /* List of tuples (regex, action) of rules the lexer has */
     ks_list rules;
 
-    /* The character input source for the Lexer 
-     * May be a FileStream
-     * TODO: add string lexing support
-     */
+    /* The character input source for the Lexer, which may be an 'io.BaseIO' (which is read in chunks) or a 'str' */
     kso src;
 
-    /* Number of characters read, but not yet claimed */
-    int n_queue;
-    /* Maximum size the queue has been allocated for */
-    int _max_n_queue;
+    /* Input which has been read, but not yet claimed, starting at 'buf[pos]' (and the allocated size of 'buf') */
+    char* buf;
+    ks_size_t pos, len, max_len;
 
-    /* List of characters being matched currently */
-    char* queue;
+    /* Whether all the input has been read */
+    bool eof;
 
     /* The line, column (in characters from start of line), and position (in bytes and characters from start of stream) */
     int line, col, pos_b, pos_c;
 
 
-    /* Internal use, for simulating the Regex */
-    ks_regex_sim0 _sim;
-
-    int _max_sim_len;
+    /* Internal use, all the rules combined (see 'ks_regex_union()'), or NULL if it needs to be rebuilt, and the
+     *   final NFA state of each rule
+     */
+    ks_regex _pat;
+    ks_cint* _ends;
 
 
 }* ksgram_Lexer;
@@ -34,6 +34,7 @@ void _ksi_rational();
 
 void _ksi_str();
 void _ksi_bytes();
+void _ksi_bytearray();
 void _ksi_regex();
 
 void _ksi_range();
@@ -76,6 +77,8 @@ void _ksi_os_path();
 void _ksi_os_walk();
 void _ksi_os_frame();
 void _ksi_os_proc();
+void _ksi_os_profile();
+void _ksi_os_memsnap();
 
 ks_module _ksi_m();
 
@@ -141,6 +144,81 @@ void _ksi_kpm_cext_project();
 
 
 
+/* Whether allocation tracing is active (see 'memtrace.c') */
+extern bool _ks_memtrace_active;
+
+/* Record an allocation, reallocation, or free (only call when '_ks_memtrace_active')
+ * Reallocations take the old address as an integer, since it is no longer valid to use as a pointer
+ */
+void _ks_memtrace_add(void* ptr, ks_size_t sz);
+void _ks_memtrace_realloc(uintptr_t optr, void* nptr, ks_size_t sz);
+void _ks_memtrace_del(void* ptr);
+
+/* Record that a block was allocated for an object of type 'tp' */
+void _ks_memtrace_settype(kso ob, ks_type tp);
+
+/* Whether code is executed through trampolines for native profilers (see 'perf.c') */
+extern bool _ks_perf_active;
+
+/* Attributes stored by shape (see 'shape.c'), for objects whose type has 'ob_slots > 0' */
+#define KSO_SLOTS(_ob) ((struct ks_slots*)((ks_uint)(_ob) + (_ob)->type->ob_slots))
+
+/* Convert to using the attribute dictionary (if not already), and return it (a borrowed reference) */
+ks_dict _kso_slots_todict(kso ob);
+
+/* Set an attribute, returning false if the attribute dictionary should be used instead */
+bool _kso_slots_set(kso ob, ks_str name, kso val);
+
+/* Release the attributes of an object being freed */
+void _kso_slots_del(kso ob);
+
+/* Append 'other' to 'self' in place, where 'self' must have no other references (and not be interned), and
+ *   be exactly of type 'str' (or 'bytes'). Space is allocated in powers of two, so appending repeatedly is
+ *   amortized O(1) (see 'types/str.c')
+ */
+void _ks_str_append(ks_str self, ks_str other);
+void _ks_bytes_append(ks_bytes self, ks_bytes other);
+
+/* Set the seed for 'ks_hash_bytes()', from the value of 'KS_HASHSEED' (a number, or 'random')
+ * This must be called before anything is hashed (see 'util.c')
+ */
+void _ks_hash_init(const char* seed);
+
+
+#ifdef KS_VMSTATS
+
+/* Virtual machine statistics, collected when built with './configure --vmstats' (see 'vm.c') */
+extern struct ksvm_stats {
+
+    /* Number of times each instruction was executed */
+    ks_uint count[256];
+
+    /* Number of times each instruction was followed by another (within the same code object),
+     *   indexed by '[first][second]'
+     */
+    ks_uint pair[256][256];
+
+    /* Total cycles (as measured by 'rdtsc') spent in each instruction, or all zeros if unavailable */
+    ks_uint cycles[256];
+
+} _ksvm_stats;
+
+/* Reset statistics to zero */
+void _ksvm_stats_reset();
+
+/* Print a summary of the statistics to 'fp' */
+void _ksvm_stats_dump(FILE* fp);
+
+#endif
+
+
+/* Set (asynchronously) when the profiler has requested a sample */
+extern volatile sig_atomic_t _ksos_profile_pending;
+
+/* Take a sample for the active profiler (should be called at a safe point, holding the GIL) */
+void _ksos_profile_sample();
+
+
 /* Initialize type */
 void _ksinit(ks_type self, ks_type base, const char* name, int sz, int attr, const char* doc, struct ks_ikv* ikv);
 
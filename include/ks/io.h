@@ -121,9 +121,17 @@ typedef struct ksio_StringIO_s {
     /* Number of bytes read and written (not rigorous, don't rely on these) */
     ks_ssize_t sz_r, sz_w;
 
+    /* For 'io.BytesIO', a 'bytes' object which shares 'data' (since its buffer was exported), or NULL
+     * While this is set, 'data' is owned by it, so it must be copied before it is modified
+     */
+    ks_bytes exp;
 
 }* ksio_StringIO;
 
+/* 'str.builder' (also 'io.StringBuilder') - a 'io.StringIO' which is only appended to, for building strings
+ */
+typedef ksio_StringIO ksio_StringBuilder;
+
 /* 'io.BytesIO' - like 'io.StringIO', but for binary data
  */
 typedef ksio_StringIO ksio_BytesIO;
@@ -227,6 +235,12 @@ KS_API bool ksio_trunc(ksio_BaseIO self, ks_cint sz);
  */
 KS_API ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data);
 
+/* Read up to 'len(buf)' bytes directly into 'buf' (which may be a view of another 'bytearray')
+ *
+ * Number of bytes read is returned (0 at the end of the stream), or negative number on an error
+ */
+KS_API ks_ssize_t ksio_readinto(ksio_BaseIO self, ks_bytearray buf);
+
 /* Read up to 'sz_c' characters (real number stored in '*num_c')
  *
  * Writes characters in UTF8 format to 'data', which should have been allocated for 'sz_c * 4' bytes
@@ -288,6 +302,10 @@ KS_API ksio_BytesIO ksio_BytesIO_new();
 KS_API ks_bytes ksio_BytesIO_get(ksio_BytesIO self);
 KS_API ks_bytes ksio_BytesIO_getf(ksio_BytesIO self);
 
+/* Make sure 'self' owns its data (i.e. it is not shared with a 'bytes' object), so that it may be modified
+ */
+KS_API void ksio_BytesIO_own(ksio_BytesIO self);
+
 /** Misc. Utils **/
 
 /* Get mode information about a given stream or mode
@@ -321,6 +339,7 @@ KS_API_DATA ks_type
     ksiot_RawIO,
     ksiot_FileIO,
     ksiot_StringIO,
+    ksiot_StringBuilder,
     ksiot_BytesIO
 ;
 
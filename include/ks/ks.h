@@ -305,6 +305,7 @@ KS_API_DATA ks_type
       kst_complex,
     kst_str,
     kst_bytes,
+    kst_bytearray,
     kst_regex,
     kst_range,
     kst_slice,
@@ -319,12 +320,19 @@ KS_API_DATA ks_type
     kst_enumerate,
 
     kst_str_iter,
+    kst_str_splititer,
     kst_bytes_iter,
+    kst_bytearray_iter,
     kst_range_iter,
     kst_list_iter,
     kst_tuple_iter,
     kst_set_iter,
     kst_dict_iter,
+    kst_dict_keys,
+    kst_dict_values,
+    kst_dict_items,
+    kst_regex_match,
+    kst_regex_iter,
 
     kst_type,
     kst_func,
@@ -525,9 +533,13 @@ struct ks_eikv {
  */
 #define KS_TFUNC(_type, _name) kso _type##_##_name##_(int _nargs, kso* _args)
 
-/* Parse function args, and returns 'NULL' from the current function if they did not parse correctly */
+/* Parse function args, and returns 'NULL' from the current function if they did not parse correctly
+ *
+ * The signature must be a string constant, since it is decoded only once per call site (see '_ks_argsc()')
+ */
 #define KS_ARGS(...) do { \
-    if (!_ks_args(_nargs, _args, __VA_ARGS__)) return NULL; \
+    static struct ks_argspec* _ks_spec = NULL; \
+    if (!_ks_argsc(&_ks_spec, _nargs, _args, __VA_ARGS__)) return NULL; \
 } while(0)
 
 /* Lock the GIL (blocking until the lock is acquired) */
@@ -628,6 +640,61 @@ KS_API void ks_free(void* ptr);
  */
 KS_API ks_ssize_t ks_nextsize(ks_ssize_t cur_sz, ks_ssize_t req);
 
+/* Create an arena, which hands out memory from large blocks, and frees all of it at once
+ *
+ * Each allocation is counted, and released with 'ks_arena_release()'. Once the arena is closed with
+ *   'ks_arena_close()', it is freed as soon as every allocation has been released
+ */
+KS_API ks_arena ks_arena_new();
+
+/* Allocate 'sz' bytes from an arena, which must not be closed */
+KS_API void* ks_arena_alloc(ks_arena self, ks_size_t sz);
+
+/* Release an allocation made from an arena */
+KS_API void ks_arena_release(ks_arena self);
+
+/* Close an arena, so no more allocations can be made from it */
+KS_API void ks_arena_close(ks_arena self);
+
+/* Start tracing allocations made with 'ks_malloc()'/friends, recording the size, type of object, and
+ *   file and line of kscript code that allocated them. Previous trace data is discarded
+ */
+KS_API void ks_memtrace_start();
+
+/* Stop tracing allocations, and discard trace data
+ */
+KS_API void ks_memtrace_stop();
+
+/* Return whether allocations are being traced
+ */
+KS_API bool ks_memtrace_is_active();
+
+/* Calculate the current and peak (high-water mark) number of bytes allocated since tracing started, and
+ *   the total number of allocations made
+ */
+KS_API void ks_memtrace_usage(ks_size_t* cur, ks_size_t* peak, ks_size_t* allocs);
+
+/* Return a dictionary of the live allocations since tracing started, with keys '(type, fname, line)' and
+ *   values of '(count, bytes)'. 'type' is the name of the type of object, or '<raw>' for other memory,
+ *   and 'fname' is 'none' if the memory was not allocated while running kscript code
+ */
+KS_API ks_dict ks_memtrace_sites();
+
+/* Start executing code objects through per-function trampolines, and writing their names and addresses to
+ *   '/tmp/perf-<pid>.map', so that native profilers (i.e. 'perf record') can attribute samples to kscript functions
+ * 
+ * Only supported on Linux (x86_64 and aarch64). Otherwise, an error is thrown and 'false' is returned
+ */
+KS_API bool ks_perf_start();
+
+/* Stop executing code through trampolines (entries already written remain valid)
+ */
+KS_API void ks_perf_stop();
+
+/* Return whether code is being executed through trampolines
+ */
+KS_API bool ks_perf_is_active();
+
 
 /** Util **/
 
@@ -636,10 +703,39 @@ KS_API ks_ssize_t ks_nextsize(ks_ssize_t cur_sz, ks_ssize_t req);
  */
 KS_API ks_ssize_t ks_nextprime(ks_ssize_t x);
 
-/* hash a sequence of bytes
+/* Hash a sequence of bytes. The result is never 0
+ *
+ * Hashes are the same in every process, unless the environment variable 'KS_HASHSEED' is set to a number
+ *   (or 'random', for a random seed) before 'ks_init()'
  */
 KS_API ks_hash_t ks_hash_bytes(ks_ssize_t len_b, const unsigned char* data);
 
+/* Find the first occurrence of 'n' (of length 'len_n') in 'h' (of length 'len_h'), returning its index
+ *   (in bytes), or -1 if it was not found. An empty 'n' is found at 0
+ */
+KS_API ks_ssize_t ks_memfind(ks_size_t len_h, const char* h, ks_size_t len_n, const char* n);
+
+/* Count the non-overlapping occurrences of 'n' in 'h' (an empty 'n' occurs 'len_h + 1' times)
+ */
+KS_API ks_ssize_t ks_memcount(ks_size_t len_h, const char* h, ks_size_t len_n, const char* n);
+
+/* Return the length (in bytes) of the ASCII prefix of 'data' (i.e. the index of the first byte '>= 0x80', or
+ *   'len_b' if it is all ASCII)
+ */
+KS_API ks_size_t ks_utf8_ascii(ks_size_t len_b, const char* data);
+
+/* Check whether 'data' is valid UTF-8, returning -1 if it is, or the index (in bytes) of the first sequence
+ *   that is invalid (i.e. a stray continuation byte, a truncated sequence, an overlong encoding, a surrogate,
+ *   or a character past U+10FFFF)
+ */
+KS_API ks_ssize_t ks_utf8_check(ks_size_t len_b, const char* data);
+
+/* Convert the ASCII letters in 'src' to upper (or lower) case, storing in 'dest' (which may be 'src'). Other
+ *   bytes (including all non-ASCII bytes) are copied as-is
+ */
+KS_API void ks_ascii_upper(ks_size_t len_b, char* dest, const char* src);
+KS_API void ks_ascii_lower(ks_size_t len_b, char* dest, const char* src);
+
 
 
 /* Converts a string (in 'str', size of 'sz', or if '-1', then it is NUL-terminated) to a 'ks_cfloat' 
@@ -670,6 +766,11 @@ KS_API bool ks_cfloat_from_str(const char* str, int sz, ks_cfloat* out);
  */
 KS_API int ks_cfloat_to_str(char* str, int sz, ks_cfloat val, bool sci, int prec, int base);
 
+/* Converts a 'ks_cfloat' to a string like 'str(float)' does (which uses scientific format for very large or small
+ *   values), returning the total number of bytes required like 'ks_cfloat_to_str()'
+ */
+KS_API int ks_cfloat_str(char* str, int sz, ks_cfloat val);
+
 /* strfromd-like wrapper
  */
 KS_API int ks_strfromd(char* str, size_t n, char* fmt, ks_cfloat val);
@@ -819,6 +920,12 @@ KS_API ks_str ks_fmtv(const char* fmt, va_list ap);
  */
 KS_API bool ks_fmt2(ksio_BaseIO bio, const char* fmt, int nargs, kso* args);
 
+/* Formatting with purely kscript objects, like 'ks_fmt2()', but with a string object as the format
+ *
+ * The parsed format is cached (keyed by 'fmt'), so formatting with the same string repeatedly doesn't re-parse it
+ */
+KS_API bool ks_fmt2s(ksio_BaseIO bio, ks_str fmt, int nargs, kso* args);
+
 
 /*** Type Functions ***/
 
@@ -908,7 +1015,34 @@ KS_API ks_str ks_str_new(ks_ssize_t len_b, const char* data);
  */
 KS_API ks_str ks_str_newn(ks_ssize_t len_b, char* data);
 
-/* Calculate the length, in characters, of a UTF-8 string
+/* Return the interned (canonical) string equal to 'self', which is added to the table of interned strings if
+ *   no such string exists yet. Interned strings are never freed
+ *
+ * Comparing interned strings is just a pointer comparison, so names (identifiers, attributes, dictionary
+ *   keys from C) are interned, so lookups are fast. Subtypes of 'str' are never interned (a copy is made)
+ * 
+ * C modules can intern their attribute names once, instead of creating a string on each call:
+ * ```
+ * static ks_str s_read = NULL;
+ * if (!s_read) s_read = ks_str_intern_c(-1, "read");
+ * kso f = kso_getattr(ob, s_read);
+ * ```
+ */
+KS_API ks_str ks_str_intern(ks_str self);
+
+/* Return the interned string with UTF-8 contents 'data' (see 'ks_str_intern()')
+ * If 'len_b < 0', it is assumed to be NUL-terminated, otherwise that is the length in bytes
+ */
+KS_API ks_str ks_str_intern_c(ks_ssize_t len_b, const char* data);
+
+/* Return the hash of 'self' (i.e. 'ks_hash_bytes()' of its contents), which is computed on first use and cached
+ *
+ * Prefer 'KS_STR_HASH(self)', which only makes a call if it has not been computed yet
+ */
+KS_API ks_hash_t ks_str_hash(ks_str self);
+#define KS_STR_HASH(_self) ((_self)->v_hash ? (_self)->v_hash : ks_str_hash(_self))
+
+/* Calculate the length, in characters, of a UTF-8 string (if 'len_b < 0', then 'data' is NUL-terminated)
  */
 KS_API ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data);
 
@@ -921,11 +1055,17 @@ KS_API bool ks_str_eq_c(ks_str L, const char* data, ks_ssize_t len_b);
 
 /* Attempts to find 'substr' in 'self' (within 'min_c' and 'max_c', inclusive and exclusive, respectively)
  *
- * 
- * Returns -1 if not found
+ * Returns the character index, or -1 if not found (an empty 'substr' is never found). If 'idx_b' is given, the
+ *   byte index is stored in it
  */
 KS_API ks_ssize_t ks_str_find(ks_str self, ks_str substr, ks_ssize_t min_c, ks_ssize_t max_c, ks_ssize_t* idx_b);
 
+/* Count the non-overlapping occurrences of 'substr' in 'self' (within 'min_c' and 'max_c', like 'ks_str_find()')
+ *
+ * An empty 'substr' is never found, so it counts 0
+ */
+KS_API ks_ssize_t ks_str_count(ks_str self, ks_str substr, ks_ssize_t min_c, ks_ssize_t max_c);
+
 
 /* Convert between strings of length 1 and ordinal codepoints
  */
@@ -938,6 +1078,14 @@ KS_API ks_list ks_str_split(ks_str self, ks_str by);
 KS_API ks_list ks_str_split_c(const char* self, const char* by);
 KS_API ks_list ks_str_split_any(ks_str self, int nby, ks_str* by);
 
+/* Find all the non-overlapping occurrences of 'sub' in 'self', storing their byte offsets in '*offs' (which
+ *   should be freed with 'ks_free()'), and returning how many there were
+ *
+ * This is useful for iterating over the parts of a string without creating them (i.e. the parts that
+ *   'ks_str_split()' would return are the bytes between the occurrences)
+ */
+KS_API ks_ssize_t ks_str_findall(ks_str self, ks_str sub, ks_ssize_t** offs);
+
 /* Convert a string to all upper-case, using 'ucd'
  */
 KS_API ks_str ks_str_upper(ks_str self);
@@ -986,6 +1134,46 @@ KS_API ks_bytes ks_bytes_newn(ks_ssize_t len_b, char* data);
 KS_API ks_bytes ks_bytes_newo(ks_type tp, kso obj);
 
 
+/* Create a new 'bytearray' with a copy of 'data' (or zeros, if 'data == NULL')
+ */
+KS_API ks_bytearray ks_bytearray_new(ks_ssize_t len_b, const void* data);
+KS_API ks_bytearray ks_bytearray_newt(ks_type tp, ks_ssize_t len_b, const void* data);
+
+/* Create a view of 'len_b' bytes of 'self', starting at 'pos', which shares its data
+ *
+ * 'self' can't be resized while the view exists
+ */
+KS_API ks_bytearray ks_bytearray_view(ks_bytearray self, ks_ssize_t pos, ks_ssize_t len_b);
+
+/* Resize 'self' to 'len_b' bytes (any new bytes are zero), or throw an error if it is a view or has views
+ */
+KS_API bool ks_bytearray_resize(ks_bytearray self, ks_ssize_t len_b);
+
+/* Append 'len_b' bytes of 'data' to the end of 'self' (amortized O(1) per byte)
+ */
+KS_API bool ks_bytearray_push(ks_bytearray self, ks_ssize_t len_b, const void* data);
+
+
+/* Retrieve the buffer of 'ob' (which must be released with 'ks_buffer_release()'), or throw an error if it doesn't
+ *   have one (or if it is read-only, and 'writable' was given)
+ */
+KS_API bool ks_buffer_get(kso ob, struct ks_buffer* buf, bool writable);
+
+/* Release the reference held by a buffer
+ */
+KS_API void ks_buffer_release(struct ks_buffer* buf);
+
+/* Fill in 'buf' as 'len_b' raw bytes at 'data', which are kept valid by 'ref' (a new reference is made)
+ *
+ * This is for exporters of 1D byte sequences
+ */
+KS_API void ks_buffer_bytes(struct ks_buffer* buf, kso ref, ks_size_t len_b, void* data, bool readonly);
+
+/* Return whether the elements of 'buf' are dense, in row-major order (i.e. it is just 'len_b' bytes at 'data')
+ */
+KS_API bool ks_buffer_contig(struct ks_buffer* buf);
+
+
 /* Create a new regular-expression from a descriptor string
  */
 KS_API ks_regex ks_regex_new(ks_str expr);
@@ -1026,6 +1214,39 @@ KS_API bool ks_regex_exact(ks_regex self, ks_str str);
  */
 KS_API bool ks_regex_matches(ks_regex self, ks_str str);
 
+/* Create a regex matching any of 'elems', where the final NFA state of 'elems[i]' is 'ends[i]' (if 'ends' is
+ *   given), and they are in increasing order
+ *
+ * This is meant for 'ks_regex_longest()', which reports which final state a match ended in
+ */
+KS_API ks_regex ks_regex_union(ks_cint n, ks_regex* elems, ks_cint* ends);
+
+/* Returns the length (in bytes) of the longest match of a regex at the start of 'data', -1 if there is none, or -2
+ *   if it depends on what follows 'data' (only when '!eof')
+ *
+ * If 'bol', then 'data' is at the start of the input. If 'tag' is given, it is set to the first final NFA state of
+ *   the match (see 'ks_regex_union()')
+ */
+KS_API ks_ssize_t ks_regex_longest(ks_regex self, ks_ssize_t len_b, const char* data, bool bol, bool eof, int* tag);
+
+/* Create an iterator over the matches of a regex in 'src', which may be a 'str' or an 'io.BaseIO' (which is read in
+ *   chunks, so it doesn't have to fit in memory)
+ */
+KS_API ks_regex_iter ks_regex_iter_new(ks_regex self, kso src);
+
+/* Returns the first match of a regex in 'src' (see 'ks_regex_iter_new()'), or 'none' if there was none
+ */
+KS_API kso ks_regex_search(ks_regex self, kso src);
+
+/* Returns a list of the text of every match of a regex in 'src' (see 'ks_regex_iter_new()')
+ */
+KS_API ks_list ks_regex_findall(ks_regex self, kso src);
+
+/* Returns 'src' with the first 'count' matches (or all, if 'count < 0') of a regex replaced with 'repl', which may be
+ *   a 'str', or a function which is called with a 'regex.match' and returns one
+ */
+KS_API ks_str ks_regex_sub(ks_regex self, kso repl, ks_str src, ks_cint count);
+
 
 
 
@@ -1244,6 +1465,22 @@ KS_API bool ks_dict_del(ks_dict self, kso key, bool* existed);
 KS_API bool ks_dict_del_h(ks_dict self, kso key, ks_hash_t hash, bool* existed);
 
 
+/* Get the next entry of the dictionary at or after '*pos' (which should start at 0), setting '*key' and '*val' to
+ *   borrowed references, and advancing '*pos' past it
+ *
+ * Returns whether there was another entry. This doesn't copy anything, so it is the fastest way to loop over a
+ *   dictionary from C (the dictionary should not have keys added or removed while doing so)
+ */
+KS_API bool ks_dict_next(ks_dict self, ks_cint* pos, kso* key, kso* val);
+
+/* Create a new iterator over 'self', yielding one of 'KS_DICT_*' for each entry
+ */
+KS_API ks_dict_iter ks_dict_iter_new(ks_dict self, int kind);
+
+/* Create a new view of 'self', which should be one of 'kst_dict_keys', 'kst_dict_values', or 'kst_dict_items'
+ */
+KS_API ks_dict_view ks_dict_view_new(ks_dict self, ks_type tp);
+
 /* Return a list of the entries array
  */
 KS_API ks_list ks_dict_calc_ents(ks_dict self);
@@ -1252,6 +1489,11 @@ KS_API ks_list ks_dict_calc_ents(ks_dict self);
  */
 KS_API ks_list ks_dict_calc_buckets(ks_dict self);
 
+/* Calculate the total and maximum probe lengths (i.e. the number of buckets after its first choice that each
+ *   key is stored in), which measure how well the hashes of the keys are distributed
+ */
+KS_API void ks_dict_calc_probes(ks_dict self, ks_cint* total, ks_cint* max);
+
 
 /* Create a new 'names' object, which wraps a dictionary
  */
@@ -1320,15 +1562,41 @@ KS_API kso kso_iter(kso ob);
  */
 KS_API kso kso_next(kso ob);
 
+/* Get the next item in an iterator, setting '*res' to a new reference, or to NULL if it was exhausted (in which
+ *   case, no exception is thrown)
+ *
+ * Returns false if an error was thrown. This is faster than 'kso_next()' for iterators that are written in C (see
+ *   'ks_type->ob_next'), so it should be preferred for loops
+ */
+KS_API bool kso_advance(kso ob, kso* res);
+
+/* Call 'f' on 'ob', like 'kso_next()', which throws an 'OutOfIterException' when it is exhausted (this is useful
+ *   for implementing '__next' on types which set 'ob_next')
+ */
+KS_API kso kso_next_f(ks_next_f f, kso ob);
+
 /* Parse a format string and values, similar to 'KS_ARGS', but for any list of argu
  */
 KS_API bool kso_parse(int nargs, kso* args, const char* fmt, ...);
 
 /* Attempt to get the '__attr__' dict from an object, returning NULL if it couldn't be determined
  * NOTE: this does NOT throw an error if it wasn't found
+ * NOTE: for objects whose attributes are stored by shape, this converts them to use a dictionary (which is slower)
  */
 KS_API ks_dict kso_try_getattr_dict(kso obj);
 
+/* Create a new root (empty) shape (see 'ks_shape')
+ */
+KS_API ks_shape ks_shape_new();
+
+/* Return the index of the attribute 'name' in a shape, or -1 if it is not present
+ */
+KS_API ks_cint ks_shape_find(ks_shape self, ks_str name);
+
+/* Return the shape with 'name' (which must not be present) added to 'self', following (or creating) a transition
+ */
+KS_API ks_shape ks_shape_add(ks_shape self, ks_str name);
+
 /* Get, set, or delete an attribute from an object
  */
 KS_API kso kso_getattr(kso ob, ks_str attr);
@@ -1363,6 +1631,7 @@ KS_API void kso_outrepr();
  */
 KS_API bool ks_sort_merge(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 KS_API bool ks_sort_insertion(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
+KS_API bool ks_sort_tim(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 
 
 /* Sorts 'elems' in place according to 'keys' (may be '==elems'), according to 'cmpfunc'
@@ -1370,6 +1639,8 @@ KS_API bool ks_sort_insertion(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
  * If `cmpfunc` is not `NULL`, then it should be a callable object which has the signature:
  *   (L, R) -> L <= R
  * And returns whether its first argument is less than or equal to its second argument
+ *
+ * The sort is stable, and if an error is thrown, 'elems' is left as some permutation of the original
  */
 KS_API bool ks_sort(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 
@@ -1469,6 +1740,12 @@ KS_API bool ks_str_citer_seek(struct ks_str_citer* cit, ks_ssize_t idx);
 /* Allocation/deallocation */
 KS_API kso _kso_new(ks_type tp);
 KS_API void _kso_del(kso ob);
+
+/* Initialize an object of type 'tp' in 'mem' (which has at least 'tp->ob_sz' bytes), and finalize one without
+ *   freeing its memory (for objects which live in memory they don't own, such as an arena)
+ */
+KS_API kso _kso_init(ks_type tp, void* mem);
+KS_API void _kso_fini(kso ob);
 KS_API kso _ks_newref(kso ob);
 KS_API void _kso_free(kso obj, const char* file, const char* func, int line);
 
@@ -1486,6 +1763,12 @@ KS_API ks_cint _ksem_iohash_c_();
 KS_API bool _ks_argsv(int kk, int nargs, kso* args, const char* fmt, va_list ap);
 KS_API bool _ks_args(int nargs, kso* args, const char* fmt, ...);
 
+/* Parse 'args' like '_ks_args()', but with 'fmt' decoded into '*spec' the first time (if it is NULL), and '*spec'
+ *   used from then on. 'fmt' must not change between calls with the same 'spec'
+ */
+struct ks_argspec;
+KS_API bool _ks_argsc(struct ks_argspec** spec, int nargs, kso* args, const char* fmt, ...);
+
 
 
 #endif /* KS_H__ */
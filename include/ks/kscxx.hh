@@ -7,6 +7,21 @@
  *   and are the 'make_*' functions. For example, 'ks::make_str' turns a C++ string into a kscript 'str'
  *   object
  * 
+ * There is also a small binding layer, which is header-only and requires C++14:
+ *
+ *   * 'ks::ref<T>' is a move-only handle, which owns a single reference to an object. Moving it transfers
+ *       the reference, so there are no extra 'KS_INCREF'/'KS_DECREF' pairs
+ *   * 'KSCXX_FUNC(fn)' generates a C function (a 'ks_cfunc') from a C++ function. The number of arguments,
+ *       their types, and their conversions are all decided at compile time from the signature of 'fn', so
+ *       there is no format string to parse (as with 'KS_ARGS'). For example:
+ *
+ *         static double hyp(double x, double y) { return sqrt(x * x + y * y); }
+ *         ...
+ *         ks_dict_set_c(mod->attr, "hyp", KSCXX_WRAP(hyp, "hyp(x, y)", "Computes the hypotenuse"));
+ *
+ *   * 'ks::make_view()' and 'ks::make_array()' turn C++ memory ('std::vector', or 'std::span' in C++20) into
+ *       'nx.view' objects, without copying the data
+ *
  * @author:    Cade Brown <cade@kscript.org>
  * @license:   GPLv3
  */
@@ -19,9 +34,23 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <tuple>
+#include <limits>
+#include <complex>
+#include <exception>
+#include <type_traits>
+
+#if __cplusplus >= 201703L
+ #include <string_view>
+#endif
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+ #include <span>
+#endif
 
 /* kscript C API */
 #include <ks/ks.h>
+#include <ks/nx.h>
 
 
 using namespace std;
@@ -68,6 +97,432 @@ static string get_string(ks_str str) {
 }
 
 
+/** Object Handles **/
+
+/* Owning handle to an object (of C type 'T', which should be 'kso' or another object pointer type)
+ *
+ * Constructing from a pointer absorbs the reference (use 'ref::borrow()' to create a new one), and the
+ *   reference is released when the handle is destroyed. Handles can't be copied, only moved, so passing
+ *   them around never touches the reference count
+ */
+template<typename T = kso>
+class ref {
+  public:
+
+    ref() noexcept : ob(NULL) {}
+
+    /* Absorb a reference to 'ob' (which may be NULL) */
+    explicit ref(T ob) noexcept : ob(ob) {}
+
+    ref(ref&& other) noexcept : ob(other.release()) {}
+
+    /* Any handle can be moved into a generic one */
+    template<typename U, typename = typename enable_if<is_same<T, kso>::value && !is_same<U, kso>::value>::type>
+    ref(ref<U>&& other) noexcept : ob((kso)other.release()) {}
+
+    ref(const ref&) = delete;
+    ref& operator=(const ref&) = delete;
+
+    ref& operator=(ref&& other) noexcept {
+        if (this != &other) reset(other.release());
+        return *this;
+    }
+
+    ~ref() {
+        if (ob) KS_DECREF(ob);
+    }
+
+    /* Create a new reference to 'ob' (which may be NULL) */
+    static ref borrow(T ob) noexcept {
+        KS_NINCREF(ob);
+        return ref(ob);
+    }
+
+    /* Return the object, without affecting the reference */
+    T get() const noexcept { return ob; }
+    T operator->() const noexcept { return ob; }
+    explicit operator bool() const noexcept { return ob != NULL; }
+
+    /* Give up the reference, and return the object */
+    T release() noexcept {
+        T res = ob;
+        ob = NULL;
+        return res;
+    }
+
+    /* Release the current reference (if any), and absorb 'val' */
+    void reset(T val = NULL) noexcept {
+        T old = ob;
+        ob = val;
+        if (old) KS_DECREF(old);
+    }
+
+  private:
+
+    /* Object being held */
+    T ob;
+
+};
+
+
+/** Conversions **/
+
+/* Conversion between C++ type 'T' and objects. Specializations have:
+ *
+ *   * 'type', the type an argument is stored as before the call
+ *   * 'bool get(kso ob, type& val, int i)', which converts argument 'i', or throws an exception and returns false
+ *   * 'kso make(T val)', which returns a new reference for a return value, or throws an exception and returns NULL
+ *
+ * Objects given as arguments are borrowed for the duration of the call, and objects returned are absorbed
+ *   (which is the same as C functions)
+ */
+template<typename T, typename = void>
+struct conv;
+
+/* Throw the error for argument 'i' being the wrong type */
+inline void throw_arg(kso ob, ks_type tp, int i) {
+    KS_THROW(kst_ArgError, "Expected argument #%i to be of type %R, but was of type '%T'", i, tp->i__fullname, ob);
+}
+
+/* Any object */
+template<>
+struct conv<kso> {
+    typedef kso type;
+    static bool get(kso ob, kso& val, int) {
+        val = ob;
+        return true;
+    }
+    static kso make(kso val) {
+        return val;
+    }
+};
+
+/* Object pointer types, which are checked against their kscript type */
+#define KSCXX_CONV_OBJ(_ctype, _tp) \
+template<> \
+struct conv<_ctype> { \
+    typedef _ctype type; \
+    static bool get(kso ob, _ctype& val, int i) { \
+        if (!kso_issub(ob->type, _tp)) { \
+            throw_arg(ob, _tp, i); \
+            return false; \
+        } \
+        val = (_ctype)ob; \
+        return true; \
+    } \
+    static kso make(_ctype val) { \
+        return (kso)val; \
+    } \
+};
+
+KSCXX_CONV_OBJ(ks_type, kst_type)
+KSCXX_CONV_OBJ(ks_str, kst_str)
+KSCXX_CONV_OBJ(ks_bytes, kst_bytes)
+KSCXX_CONV_OBJ(ks_bytearray, kst_bytearray)
+KSCXX_CONV_OBJ(ks_int, kst_int)
+KSCXX_CONV_OBJ(ks_float, kst_float)
+KSCXX_CONV_OBJ(ks_complex, kst_complex)
+KSCXX_CONV_OBJ(ks_list, kst_list)
+KSCXX_CONV_OBJ(ks_tuple, kst_tuple)
+KSCXX_CONV_OBJ(ks_set, kst_set)
+KSCXX_CONV_OBJ(ks_dict, kst_dict)
+KSCXX_CONV_OBJ(ks_func, kst_func)
+KSCXX_CONV_OBJ(ks_module, kst_module)
+KSCXX_CONV_OBJ(nx_array, nxt_array)
+KSCXX_CONV_OBJ(nx_view, nxt_view)
+
+/* Owning handles, which take a new reference to arguments, and give theirs up when returned */
+template<typename T>
+struct conv< ref<T> > {
+    typedef ref<T> type;
+    static bool get(kso ob, ref<T>& val, int i) {
+        typename conv<T>::type v;
+        if (!conv<T>::get(ob, v, i)) return false;
+        val = ref<T>::borrow(v);
+        return true;
+    }
+    static kso make(ref<T> val) {
+        return (kso)val.release();
+    }
+};
+
+template<>
+struct conv<bool> {
+    typedef bool type;
+    static bool get(kso ob, bool& val, int) {
+        return kso_truthy(ob, &val);
+    }
+    static kso make(bool val) {
+        return KSO_BOOL(val);
+    }
+};
+
+/* Integers, which are range checked */
+template<typename T>
+struct conv<T, typename enable_if<is_integral<T>::value && !is_same<T, bool>::value>::type> {
+    typedef T type;
+    static bool get(kso ob, T& val, int i) {
+        ks_cint v;
+        if (!kso_get_ci(ob, &v)) return false;
+        if ((is_signed<T>::value || sizeof(T) < sizeof(ks_cint)) && (v < (ks_cint)numeric_limits<T>::min() || v > (ks_cint)numeric_limits<T>::max())) {
+            KS_THROW(kst_OverflowError, "Argument #%i was out of range for its C++ type", i);
+            return false;
+        } else if (!is_signed<T>::value && v < 0) {
+            KS_THROW(kst_OverflowError, "Argument #%i was out of range for its C++ type", i);
+            return false;
+        }
+        val = (T)v;
+        return true;
+    }
+    static kso make(T val) {
+        if (!is_signed<T>::value && (ks_uint)val > (ks_uint)numeric_limits<ks_cint>::max()) return (kso)ks_int_newu((ks_uint)val);
+        return (kso)ks_int_new((ks_cint)val);
+    }
+};
+
+template<typename T>
+struct conv<T, typename enable_if<is_floating_point<T>::value>::type> {
+    typedef T type;
+    static bool get(kso ob, T& val, int) {
+        ks_cfloat v;
+        if (!kso_get_cf(ob, &v)) return false;
+        val = (T)v;
+        return true;
+    }
+    static kso make(T val) {
+        return (kso)ks_float_new((ks_cfloat)val);
+    }
+};
+
+/* Strings are copied (see 'string_view' for a version that doesn't) */
+template<>
+struct conv<string> {
+    typedef string type;
+    static bool get(kso ob, string& val, int i) {
+        if (!kso_issub(ob->type, kst_str)) {
+            throw_arg(ob, kst_str, i);
+            return false;
+        }
+        val.assign(((ks_str)ob)->data, ((ks_str)ob)->len_b);
+        return true;
+    }
+    static kso make(const string& val) {
+        return (kso)ks_str_new(val.size(), val.data());
+    }
+};
+
+#if __cplusplus >= 201703L
+
+/* String views point to the data of the argument, which is valid for the call */
+template<>
+struct conv<string_view> {
+    typedef string_view type;
+    static bool get(kso ob, string_view& val, int i) {
+        if (!kso_issub(ob->type, kst_str)) {
+            throw_arg(ob, kst_str, i);
+            return false;
+        }
+        val = string_view(((ks_str)ob)->data, ((ks_str)ob)->len_b);
+        return true;
+    }
+    static kso make(string_view val) {
+        return (kso)ks_str_new(val.size(), val.data());
+    }
+};
+
+#endif
+
+
+/** Functions **/
+
+/* Calls 'fn' and converts the result (of type 'R') */
+template<typename R>
+struct result {
+    template<typename F, typename... X>
+    static kso call(F fn, X&&... x) {
+        return conv<typename decay<R>::type>::make(fn(std::forward<X>(x)...));
+    }
+};
+
+template<>
+struct result<void> {
+    template<typename F, typename... X>
+    static kso call(F fn, X&&... x) {
+        fn(std::forward<X>(x)...);
+        return KSO_NONE;
+    }
+};
+
+/* Generates a C function ('func::call') for the C++ function 'fn', of type 'F'. Use 'KSCXX_FUNC()' instead of
+ *   this directly
+ *
+ * Arguments are taken by value or by 'const&', and their conversions are given by 'conv<>'. If 'fn' throws a C++
+ *   exception, it is converted to an 'Error'. Functions returning objects may also throw a kscript exception and
+ *   return NULL, just like C functions
+ */
+template<typename F, F fn>
+struct func;
+
+template<typename R, typename... A, R (*fn)(A...)>
+struct func<R (*)(A...), fn> {
+
+    /* Number of arguments */
+    static constexpr int nargs = sizeof...(A);
+
+    template<size_t... I>
+    static kso invoke(kso* args, index_sequence<I...>) {
+        tuple<typename conv<typename decay<A>::type>::type...> vals;
+
+        /* Convert in order, stopping at the first failure */
+        bool ok = true;
+        int unused[] = { 0, (ok = ok && conv<typename decay<A>::type>::get(args[I], std::get<I>(vals), (int)I), 0)... };
+        (void)unused;
+        if (!ok) return NULL;
+
+        try {
+            return result<R>::call(fn, std::move(std::get<I>(vals))...);
+        } catch (const exception& e) {
+            KS_THROW(kst_Error, "%s", e.what());
+            return NULL;
+        }
+    }
+
+    static kso call(int _nargs, kso* _args) {
+        if (_nargs != nargs) {
+            KS_THROW(kst_ArgError, "Expected %i arguments, but given %i", nargs, _nargs);
+            return NULL;
+        }
+        return invoke(_args, index_sequence_for<A...>());
+    }
+};
+
+/* C function ('ks_cfunc') for the C++ function '_fn' */
+#define KSCXX_FUNC(_fn) (&ks::func<decltype(&_fn), &_fn>::call)
+
+/* Function object for the C++ function '_fn' (see 'ksf_wrap()') */
+#define KSCXX_WRAP(_fn, _sig, _doc) ksf_wrap(KSCXX_FUNC(_fn), _sig, _doc)
+
+
+/** Arrays **/
+
+/* Data type for C++ type 'T' */
+template<typename T, typename = void>
+struct dtype;
+
+template<>
+struct dtype<bool> {
+    static nx_dtype get() { return nxd_bl; }
+};
+
+template<typename T>
+struct dtype<T, typename enable_if<is_integral<T>::value && !is_same<T, bool>::value>::type> {
+    static nx_dtype get() {
+        switch (sizeof(T)) {
+            case 1: return is_signed<T>::value ? nxd_s8 : nxd_u8;
+            case 2: return is_signed<T>::value ? nxd_s16 : nxd_u16;
+            case 4: return is_signed<T>::value ? nxd_s32 : nxd_u32;
+            default: return is_signed<T>::value ? nxd_s64 : nxd_u64;
+        }
+    }
+};
+
+template<> struct dtype<float> { static nx_dtype get() { return nxd_F; } };
+template<> struct dtype<double> { static nx_dtype get() { return nxd_D; } };
+template<> struct dtype<long double> { static nx_dtype get() { return nxd_E; } };
+template<> struct dtype< complex<float> > { static nx_dtype get() { return nxd_cF; } };
+template<> struct dtype< complex<double> > { static nx_dtype get() { return nxd_cD; } };
+template<> struct dtype< complex<long double> > { static nx_dtype get() { return nxd_cE; } };
+
+/* Make sure the 'nx' module (and its data types) are initialized, or throw an exception and return false */
+inline bool nx_ready() {
+    static ks_module mod = NULL;
+    if (!mod) {
+        ks_str name = ks_str_new(2, "nx");
+        mod = ks_import(name);
+        KS_DECREF(name);
+    }
+    return mod != NULL;
+}
+
+/* Object which owns a C++ value, which is deleted with the object */
+struct holder_s {
+    KSO_BASE
+
+    /* Value being held */
+    void* val;
+
+    /* Deletes 'val' */
+    void (*del)(void* val);
+
+};
+
+inline kso holder_free(int, kso* _args) {
+    holder_s* self = (holder_s*)_args[0];
+    self->del(self->val);
+    KSO_DEL(self);
+    return KSO_NONE;
+}
+
+inline ks_type holder_type() {
+    static ks_type tp = NULL;
+    if (!tp) {
+        tp = ks_type_new("cxx.holder", kst_object, sizeof(holder_s), -1, "Holds a C++ value", NULL);
+        kso f = ksf_wrap(holder_free, "cxx.holder.__free(self)", "");
+        ks_type_set_c(tp, "__free", f);
+        KS_DECREF(f);
+    }
+    return tp;
+}
+
+/* Return a new object which owns 'val' (which is then deleted with 'delete') */
+template<typename T>
+inline kso make_holder(T* val) {
+    holder_s* self = KSO_NEW(holder_s*, holder_type());
+    self->val = val;
+    self->del = [](void* v) { delete (T*)v; };
+    return (kso)self;
+}
+
+/* Return a view of 'data', which has 'rank' dimensions given by 'shape' (and is dense, in row-major order)
+ *
+ * Nothing is copied, so the data must be valid as long as the view is. A reference to 'ref' (which may be NULL)
+ *   is held by the view, so it can be the object that owns the data
+ */
+template<typename T>
+inline nx_view make_view(T* data, int rank, const ks_size_t* shape, kso ref) {
+    if (!nx_ready()) return NULL;
+    return nx_view_newo(nxt_view, nx_make((void*)data, dtype<typename remove_cv<T>::type>::get(), rank, (ks_size_t*)shape, NULL), ref);
+}
+
+/* Return a 1D view of 'data', without copying it (see the other 'make_view()') */
+template<typename T>
+inline nx_view make_view(vector<T>& data, kso ref) {
+    ks_size_t len = data.size();
+    return make_view(data.data(), 1, &len, ref);
+}
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+
+/* Return a 1D view of 'data', without copying it (see the other 'make_view()') */
+template<typename T, size_t N>
+inline nx_view make_view(span<T, N> data, kso ref) {
+    ks_size_t len = data.size();
+    return make_view(data.data(), 1, &len, ref);
+}
+
+#endif
+
+/* Return a 1D view which owns 'data'. The vector is moved (not copied), and is deleted with the view */
+template<typename T>
+inline nx_view make_array(vector<T>&& data) {
+    vector<T>* val = new vector<T>(std::move(data));
+    ks_size_t len = val->size();
+    kso h = make_holder(val);
+    nx_view res = make_view(val->data(), 1, &len, h);
+    KS_DECREF(h);
+    return res;
+}
+
 
 };
 
@@ -115,6 +115,10 @@
  */
 #define NX_MAXRANK 16
 
+#if NX_MAXRANK > KS_BUFFER_MAXRANK
+ #error "'NX_MAXRANK' must not be larger than 'KS_BUFFER_MAXRANK'"
+#endif
+
 /* Maximum broadcast size (i.e. maximum number of arguments to a single kernel)
  *
  */
@@ -539,6 +543,9 @@ typedef struct nx_view_s {
      */
     kso ref;
 
+    /* Whether the data must not be modified (i.e. it is the buffer of a 'bytes' object) */
+    bool readonly;
+
 }* nx_view;
 
 /* Function signature for broadcasting/function application to inputs
@@ -567,6 +574,12 @@ typedef int (*nxf_Nd)(int nargs, nx_t* args, int rank, ks_size_t* shape, void* e
  */
 KS_API nx_t nx_make(void* data, nx_dtype dtype, int rank, ks_size_t* shape, ks_ssize_t* strides);
 
+/* Create an array descriptor for the memory of a buffer (see 'ks_buffer_get()'), which is a view of it
+ *
+ * Raw bytes (i.e. 'buf->dtype == NULL') are treated as 'nx.uint8'
+ */
+KS_API nx_t nx_frombuf(struct ks_buffer* buf);
+
 
 /* Create a new array descriptor with a new axis inserted at 'axis'
  *
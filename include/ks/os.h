@@ -290,6 +290,50 @@ typedef struct ksos_proc_s {
 
 } *ksos_proc;
 
+/* 'os.memsnap' - Snapshot of traced allocations
+ *
+ * See 'ks_memtrace_start()'
+ */
+typedef struct ksos_memsnap_s {
+    KSO_BASE
+
+    /* Live allocations, as returned by 'ks_memtrace_sites()' */
+    ks_dict sites;
+
+    /* Current and peak number of bytes, and total number of allocations, when the snapshot was taken */
+    ks_cint cur, peak, allocs;
+
+}* ksos_memsnap;
+
+/* 'os.profile' - Sampling profiler for kscript code
+ *
+ * While active, a 'SIGPROF' timer periodically requests a sample, which is taken at the next
+ *   safe point in the virtual machine (i.e. between instructions, while holding the GIL). Each
+ *   sample records the call stack of every thread, mapping each frame's program counter to a
+ *   source line via 'ks_code_get_meta()'
+ * 
+ * Only one profiler may be active at a time
+ */
+typedef struct ksos_profile_s {
+    KSO_BASE
+
+    /* Interval between samples, in seconds (of CPU time) */
+    ks_cfloat interval;
+
+    /* Whether or not the profiler is currently sampling */
+    bool is_active;
+
+    /* Number of samples taken */
+    ks_cint n_samples;
+
+    /* Mapping of stacks to the number of samples which had that stack. Each key is a tuple of
+     *   strings, starting with the thread name, and then a 'name (fname:line)' string for each
+     *   frame (outermost first)
+     */
+    ks_dict stacks;
+
+}* ksos_profile;
+
 
 /* Functions */
 
@@ -454,6 +498,48 @@ KS_API bool ksos_isalive(int pid, bool* out);
  */
 KS_API bool ksos_signal(int pid, int sig);
 
+/** Memory **/
+
+/* Take a snapshot of the traced allocations (throws an error if tracing was not active)
+ */
+KS_API ksos_memsnap ksos_memsnap_new(ks_type tp);
+
+/* Return a list of the 'n' sites using the most memory, as '(type, fname, line, count, bytes)' tuples
+ *   (if 'n < 0', then all are returned)
+ */
+KS_API ks_list ksos_memsnap_top(ksos_memsnap self, ks_cint n);
+
+/* Return a list of the 'n' sites whose memory changed the most since 'old', as '(type, fname, line, count_diff, bytes_diff)'
+ *   tuples (if 'n < 0', then all are returned)
+ */
+KS_API ks_list ksos_memsnap_diff(ksos_memsnap self, ksos_memsnap old, ks_cint n);
+
+
+/** Profiling **/
+
+/* Create a new profiler which samples every 'interval' seconds (of CPU time)
+ * The profiler is not started
+ */
+KS_API ksos_profile ksos_profile_new(ks_type tp, ks_cfloat interval);
+
+/* Start sampling (throws an error if another profiler is already active)
+ */
+KS_API bool ksos_profile_start(ksos_profile self);
+
+/* Stop sampling (no-op if it was not active)
+ */
+KS_API bool ksos_profile_stop(ksos_profile self);
+
+/* Write the samples in folded stack format (one stack per line, like 'main;a (x.ks:1);b (x.ks:4) 27'),
+ *   which can be consumed by 'flamegraph.pl' and similar tools
+ */
+KS_API bool ksos_profile_folded(ksos_profile self, ksio_BaseIO io);
+
+/* Write a table of functions and their self/total sample counts, sorted by self
+ */
+KS_API bool ksos_profile_table(ksos_profile self, ksio_BaseIO io);
+
+
 /** Threading **/
 
 /* Create a new thread
@@ -474,6 +560,10 @@ KS_API bool ksos_thread_start(ksos_thread self);
  */
 KS_API bool ksos_thread_join(ksos_thread self);
 
+/* Return a list of the threads that are alive (including the main thread)
+ */
+KS_API ks_list ksos_thread_all();
+
 
 /* Create new 'os.frame'
  */
@@ -493,6 +583,18 @@ KS_API ks_str ksos_frame_get_tb(ksos_frame self);
  */
 KS_API bool ksos_frame_get_info(ksos_frame self, ks_str* fname, ks_str* func, int* line);
 
+/* Calculate the source file and (1-based) line that the given frame is currently executing
+ * A reference is NOT returned to 'fname', and this never throws (it returns false if the frame is not
+ *   executing bytecode). Unlike 'ksos_frame_get_info()', functions report the file they were defined in
+ */
+KS_API bool ksos_frame_where(ksos_frame self, ks_str* fname, int* line);
+
+/* Calculate the source file and (1-based) line where the code the given frame is executing begins (i.e. where
+ *   the function was defined), which is the same for every frame of that function
+ * Like 'ksos_frame_where()', a reference is NOT returned to 'fname', and this never throws
+ */
+KS_API bool ksos_frame_defn(ksos_frame self, ks_str* fname, int* line);
+
 
 /* Linearize the linked-list structure of the frames, returning a list of frames with 
  *   'self' at the beginning
@@ -521,7 +623,9 @@ KS_API_DATA ks_type
     ksost_thread,
     ksost_frame,
     ksost_mutex,
-    ksost_proc
+    ksost_proc,
+    ksost_profile,
+    ksost_memsnap
 ;
 
 /* Globals */
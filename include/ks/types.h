@@ -126,6 +126,9 @@ typedef ks_uint ks_size_t;
  */
 #define KS_CINT_MIN_ABS            (1 + (ks_uint)(-(KS_CINT_MIN+1)))
 
+/* Arena of memory which is freed all at once (see 'ks_arena_new()') */
+typedef struct ks_arena_s* ks_arena;
+
 
 /** Object Types **/
 
@@ -239,9 +242,16 @@ struct ks_str_s {
     /* Length, in characters, of the string */
     ks_size_t len_c;
 
-    /* Hash of the string contents (ks_hash_bytes(x->chr, x->len_b)) */
+    /* Hash of the string contents (ks_hash_bytes(x->len_b, x->data)), or 0 if it hasn't been computed yet
+     * Use 'KS_STR_HASH()' to read it
+     */
     ks_hash_t v_hash;
 
+    /* Whether this is the canonical (interned) copy of its contents (see 'ks_str_intern()')
+     * Two interned strings are equal if and only if they are the same object
+     */
+    bool interned;
+
     #if KS_STR_OFF_EVERY
 
     /*
@@ -320,6 +330,18 @@ typedef struct ks_str_iter_s {
 
 }* ks_str_iter;
 
+/* String split iterator type, which creates the parts of a string lazily */
+typedef struct ks_str_splititer_s {
+    KSO_BASE
+
+    /* String being split, and the separator */
+    ks_str of, by;
+
+    /* Current position (in bytes), or -1 if all parts have been returned */
+    ks_cint pos;
+
+}* ks_str_splititer;
+
 
 /* 'bytes' - (immutable) string of bytes
  * 
@@ -331,7 +353,7 @@ typedef struct ks_bytes_s {
     /* Length of the data */
     ks_size_t len_b;
 
-    /* Hash of the bytes contents (ks_hash_bytes(x->byt, x->len_b)) */
+    /* Hash of the bytes contents (ks_hash_bytes(x->len_b, x->data)), or 0 if it hasn't been computed yet */
     ks_hash_t v_hash;
 
     /* Array of byte data */
@@ -340,6 +362,43 @@ typedef struct ks_bytes_s {
 }* ks_bytes;
 
 
+/* 'bytearray' - mutable string of bytes
+ *
+ * Slices are views, which share the data of the array they were taken from (see 'types/bytearray.c')
+ */
+typedef struct ks_bytearray_s* ks_bytearray;
+struct ks_bytearray_s {
+    KSO_BASE
+
+    /* Length of the data */
+    ks_size_t len_b;
+
+    /* Array of byte data (for a view, this points within the data of 'base') */
+    unsigned char* data;
+
+    /* Number of bytes allocated for 'data' (0 for views) */
+    ks_size_t max_len_b;
+
+    /* The array that this is a view of, or NULL if it owns its data */
+    ks_bytearray base;
+
+    /* Number of views of this array, which must be 0 for it to be resized */
+    ks_size_t n_views;
+
+};
+
+/* 'bytearray' iterator type */
+typedef struct ks_bytearray_iter_s {
+    KSO_BASE
+
+    ks_bytearray of;
+
+    /* Current position (in bytes) that the iterator is at */
+    ks_cint pos;
+
+}* ks_bytearray_iter;
+
+
 
 /* Regex NFA types */
 enum {
@@ -407,6 +466,74 @@ struct ks_regex_nfa {
     };
 };
 
+/* Lazily built DFA for a regex (see 'types/regex.c')
+ *
+ * Each DFA state is a set of NFA states, and transitions are only computed the first time they are taken (and then
+ *   cached). Bytes which no NFA state can tell apart share a byte class, so tables are indexed by class instead of byte
+ * 
+ * Once the states use more than a set amount of memory, no more are added, and matching continues with the NFA
+ * 
+ */
+typedef struct ks_regex_dfa_s {
+
+    /* Whether the NFA start state is added after every byte (i.e. for finding matches anywhere)
+     *
+     * In this mode, states only hold what is still alive from earlier bytes, and the closure of the NFA start state
+     *   is added when stepping. So, the empty state means nothing that started before the current byte can match
+     */
+    bool unanch;
+
+    /* Closure of the NFA start state, and whether it contains the final NFA state */
+    int n_f;
+    int* f;
+    bool f_acc;
+
+    /* Number of byte classes, the class of each byte, and a byte in each class */
+    int n_cls;
+    unsigned char cls[256];
+    unsigned char rep[256];
+
+    /* Initial state at the start of the input (after line start transitions), and elsewhere */
+    int start, mid;
+
+    /* Number of states, and the array of them */
+    int n_states, max_states;
+    struct ks_regex_dfa_state {
+
+        /* Sorted array of NFA states in this state */
+        int n_nfa;
+        int* nfa;
+
+        /* Hash of 'nfa' */
+        ks_hash_t hash;
+
+        /* Whether this state contains the final NFA state */
+        bool acc;
+
+        /* First final NFA state in this state, or -1 (regexes made with 'ks_regex_union()' have one per rule) */
+        int tag;
+
+        /* State after line end transitions (-1 if not computed yet) */
+        int eol;
+
+        /* Next state for each byte class (-1 if not computed yet) */
+        int* next;
+
+    }* states;
+
+    /* Hash table of state indices (-1 for empty), with 'mask + 1' buckets */
+    int mask;
+    int* buckets;
+
+    /* Bytes used by the states, and whether the limit has been reached */
+    ks_size_t mem;
+    bool full;
+
+    /* Scratch space for building sets of NFA states */
+    bool* mark;
+
+}* ks_regex_dfa;
+
 /* regex - regular expression pattern, which can be used to match strings
  *
  */
@@ -425,6 +552,16 @@ typedef struct ks_regex_s {
     /* Initial and final states of the regular expression */
     int s0, sf;
 
+    /* DFAs for exact matching and for matching anywhere, or NULL if they have not been needed yet */
+    ks_regex_dfa dfa[2];
+
+    /* Literal that every match starts with, and the longest literal that every match contains (either may be empty)
+     *
+     * These are used to skip ahead with 'ks_memfind()' while searching
+     */
+    int n_pre, n_req;
+    char* pre, *req;
+
 }* ks_regex;
 
 /* regex.match - represents a match found while searching for a regex
@@ -436,18 +573,50 @@ typedef struct ks_regex_match_s {
     /* Pattern being matched */
     ks_regex pat;
 
-    /* Source that it was matched within */
-    ks_str src;
+    /* Text that was matched */
+    ks_str val;
 
-    /*  */
-    struct ks_regex_match_group_s {
+    /* Start (inclusive) and stop (exclusive) position, in characters from the start of the input */
+    ks_cint start, stop;
 
-        /* Start (inclusive) and stop (exclusive) position in bytes in 'src' */
-        int start, stop;
+}* ks_regex_match;
 
-    }* groups;
+/* 'regex.__finditer' - iterator over the matches of a regex, in a string or a stream
+ *
+ * Matches are leftmost-longest, and don't overlap. Streams are read in chunks, and only the part that may still be
+ *   part of a match is kept
+ */
+typedef struct ks_regex_iter_s {
+    KSO_BASE
 
-}* ks_regex_match;
+    /* Pattern being matched */
+    ks_regex pat;
+
+    /* Source being searched, either a 'str' or an 'io.BaseIO' */
+    kso src;
+
+    /* Input being searched (for a 'str' this is its data, and for a stream it is 'buf') */
+    const unsigned char* data;
+    ks_size_t len;
+
+    /* Buffer for streams, and its allocated size */
+    unsigned char* buf;
+    ks_size_t max_len;
+
+    /* Position in 'data' to search from, and its position (in characters) in the input */
+    ks_size_t pos;
+    ks_cint pos_c;
+
+    /* Position (in bytes) in the input of 'data[0]' */
+    ks_cint base_b;
+
+    /* Position in 'data' of the required literal (see 'ks_regex'), if it has been found after 'pos' */
+    ks_ssize_t req_at;
+
+    /* Whether all the input has been read, whether there are no more matches, and whether the input is all ASCII */
+    bool eof, done, ascii;
+
+}* ks_regex_iter;
 
 
 /* NFA simulator (level 0)
@@ -609,10 +778,13 @@ typedef struct ks_set_s {
     }* ents;
 
 
-    /* Length of the array of buckets, which is one of 'buckets_*' members */
+    /* Length of the array of buckets, which is one of 'buckets_*' members (always 0 or a power of two) */
     ks_size_t len_buckets;
 
-    /* Union of different bucket arrays, discriminated based on size */
+    /* Union of different bucket arrays, discriminated based on size
+     * Each is followed (in the same allocation) by 'len_buckets' bytes, which are the high bits of the hash
+     *   of the entry in each bucket, so most non-matching buckets can be skipped without reading the entries
+     */
     union {
 
         /* when 'len_buckets - 1 <= KS_SINT8_MAX' */ 
@@ -640,6 +812,11 @@ typedef struct ks_set_iter_s {
     /* Current position (in ents) */
     ks_cint pos;
 
+    /* 'of->len_real' and 'of->len_ents' when the iterator was created, which are checked on each step to detect
+     *   the set being modified while iterating
+     */
+    ks_size_t len_real, len_ents;
+
 }* ks_set_iter;
 
 
@@ -669,10 +846,13 @@ typedef struct ks_dict_s {
     }* ents;
 
 
-    /* Length of the array of buckets, which is one of 'buckets_*' members */
+    /* Length of the array of buckets, which is one of 'buckets_*' members (always 0 or a power of two) */
     ks_size_t len_buckets;
 
-    /* Union of different bucket arrays, discriminated based on size */
+    /* Union of different bucket arrays, discriminated based on size
+     * Each is followed (in the same allocation) by 'len_buckets' bytes, which are the high bits of the hash
+     *   of the entry in each bucket, so most non-matching buckets can be skipped without reading the entries
+     */
     union {
 
         /* when 'len_buckets - 1 <= KS_SINT8_MAX' */
@@ -692,6 +872,16 @@ typedef struct ks_dict_s {
 }* ks_dict;
 
 
+/* What a dictionary iterator yields for each entry */
+enum {
+    /* The key */
+    KS_DICT_KEYS = 0,
+    /* The value */
+    KS_DICT_VALUES,
+    /* A tuple of '(key, val)' */
+    KS_DICT_ITEMS,
+};
+
 /* 'dict.__iter' iterator type */
 typedef struct ks_dict_iter_s {
     KSO_BASE
@@ -701,8 +891,28 @@ typedef struct ks_dict_iter_s {
     /* Current position (in ents) */
     ks_cint pos;
 
+    /* What is yielded (one of 'KS_DICT_*') */
+    int kind;
+
+    /* 'of->len_real' and 'of->len_ents' when the iterator was created, which are checked on each step to detect
+     *   the dictionary being modified while iterating (replacing the value of an existing key is allowed)
+     */
+    ks_size_t len_real, len_ents;
+
 }* ks_dict_iter;
 
+/* 'dict.__keys', 'dict.__values', and 'dict.__items' - views of the entries of a dictionary
+ *
+ * These don't copy anything, so they reflect later changes to the dictionary
+ */
+typedef struct ks_dict_view_s {
+    KSO_BASE
+
+    /* Dictionary being viewed */
+    ks_dict of;
+
+}* ks_dict_view;
+
 
 
 /* 'names' - attribute-based namespace
@@ -786,6 +996,87 @@ typedef struct ks_Exception_s {
 
 }* ks_Exception;
 
+
+/* ks_shape - layout of the attributes of instances (sometimes called a hidden class)
+ *
+ * Instances of user-defined types store their attributes in an array, and a shape maps attribute names to
+ *   indices in that array. Each type has a root (empty) shape, and adding an attribute to an instance moves it
+ *   along a transition to the shape with that attribute added (which is shared by all instances that had the
+ *   same attributes added in the same order). So, most instances of a type have the same shape, and an attribute
+ *   is at the same index in all of them
+ *
+ * Shapes are never freed, and are not objects (see 'shape.c')
+ */
+typedef struct ks_shape_s {
+
+    /* Number of attributes, and their (interned) names (holds references), where 'names[i]' is stored at 'vals[i]' */
+    ks_cint len;
+    ks_str* names;
+
+    /* Transitions to shapes with one more attribute, which is 'next[i]->names[len]' */
+    ks_cint n_next;
+    struct ks_shape_s** next;
+
+}* ks_shape;
+
+/* Attributes of an instance, when its type stores them by shape (see 'ks_type->ob_slots') */
+struct ks_slots {
+
+    /* Current shape, or NULL if the attributes are in the attribute dictionary instead
+     * (once an instance has too many attributes, or its '.__attr' dictionary is requested)
+     */
+    ks_shape shape;
+
+    /* Values of the attributes (holds references), of length 'shape->len' */
+    kso* vals;
+
+};
+
+/* Maximum rank of a buffer */
+#define KS_BUFFER_MAXRANK 16
+
+/* Buffer of an object, which describes its memory so that it can be shared without copying (see 'buffer.c')
+ *
+ * The memory is an array of 'rank' dimensions, with the elements described by 'dtype'. The element at index
+ *   '(i_0, i_1, ...)' is at the address 'data + i_0 * strides[0] + i_1 * strides[1] + ...'
+ */
+struct ks_buffer {
+
+    /* Object which keeps the memory valid (and in place) for as long as the buffer is used (a reference is held,
+     *   and released by 'ks_buffer_release()')
+     */
+    kso ref;
+
+    /* Pointer to the first element */
+    void* data;
+
+    /* Total number of bytes of the elements */
+    ks_size_t len_b;
+
+    /* Data type of the elements (an 'nx.dtype'), or NULL if they are raw bytes */
+    kso dtype;
+
+    /* Size of each element, in bytes */
+    ks_size_t size;
+
+    /* Number of dimensions, and the length (in elements) and stride (in bytes) of each of them */
+    int rank;
+    ks_size_t shape[KS_BUFFER_MAXRANK];
+    ks_ssize_t strides[KS_BUFFER_MAXRANK];
+
+    /* Whether the memory must not be modified */
+    bool readonly;
+
+};
+
+/* Fill in the buffer of 'ob', or throw an error and return false (see 'ks_type->ob_buffer') */
+typedef bool (*ks_buffer_f)(kso ob, struct ks_buffer* buf);
+
+/* Get the next object from the iterator 'it', setting '*res' to a new reference, or to NULL if it is exhausted
+ *   (in which case, nothing is thrown). Returns false if an error was thrown (see 'ks_type->ob_next')
+ */
+typedef bool (*ks_next_f)(kso it, kso* res);
+
 struct ks_type_s {
     KSO_BASE
 
@@ -805,6 +1096,25 @@ struct ks_type_s {
     /* Integer sizes and attribute dictionary offsets of instances */
     ks_cint ob_sz, ob_attr;
 
+    /* Offset of the 'struct ks_slots' in instances (or <= 0 if attributes are only stored in the dictionary), and
+     *   the root shape for instances of this type
+     * If this is given, the dictionary at 'ob_attr' is NULL until it is needed
+     */
+    ks_cint ob_slots;
+    ks_shape ob_shape;
+
+    /* Exports the buffer of instances (or NULL if they don't have one). This is not a special attribute, so it
+     *   must be set in C, after the type is initialized
+     */
+    ks_buffer_f ob_buffer;
+
+    /* Advances instances, which are iterators (or NULL if they only have '__next'). This is what 'kso_next()' and
+     *   the VM use, so iterators written in C don't go through a function call, or throw an exception at the end
+     * It must be set in C, after the type is initialized, and is cleared when '__next' is assigned (so subtypes
+     *   which override '__next' will use that instead)
+     */
+    ks_next_f ob_next;
+
     /* Number of objects created and deleted */
     ks_cint num_obs_new, num_obs_del;
 
@@ -1,157 +1,259 @@
 /* args.c - implementation of C-style function signature argument parsing
+ *
+ * A signature is a string of space-separated entries, such as "self:* ?n:cint *rest", which is decoded into an
+ *   array of 'struct ks_argspec_ent' before any arguments are looked at. 'KS_ARGS' keeps a 'static' spec at each
+ *   call site (see '_ks_argsc()'), so the string is decoded only the first time the function is called, and every
+ *   call after that is just a loop over the entries. 'kso_parse()' and '_ks_args()' may be given strings that
+ *   aren't constant, so they decode them on every call
+ *
+ * Specs are only created while the GIL is held, and are never freed (they are as static as the format strings
+ *   they came from)
  *
  * @author: Cade Brown <cade@kscript.org>
  */
 #include <ks/impl.h>
 
-bool kso_parse(int nargs, kso* args, const char* fmt, ...) {
-    va_list ap;
-    va_start(ap, fmt);
-    bool res = _ks_argsv(1, nargs, args, fmt, ap);
-    va_end(ap);
-    return res;
-}
 
-bool _ks_args(int nargs, kso* args, const char* fmt, ...) {
-    va_list ap;
-    va_start(ap, fmt);
-    bool res = _ks_argsv(0, nargs, args, fmt, ap);
-    va_end(ap);
-    return res;
-}
+/* Internals */
 
-bool _ks_argsv(int kk, int nargs, kso* args, const char* fmt, va_list ap) {
-    const char* o_fmt = fmt;
+/* Maximum number of entries for a signature which is decoded on every call, without allocating */
+#define ARGS_MAX 32
 
-    bool res = true;
+/* Kinds of entries */
+enum {
+    /* 'name', any object */
+    ARG_OBJ = 0,
+    /* 'name:*', an object of a type given in the arguments */
+    ARG_TYPE,
+    /* 'name:cint', converted to a 'ks_cint' */
+    ARG_CINT,
+    /* 'name:cfloat', converted to a 'ks_cfloat' */
+    ARG_CFLOAT,
+    /* 'name:bool', converted to a 'bool' */
+    ARG_BOOL,
+    /* '*name', the rest of the arguments */
+    ARG_REST,
+};
 
-    /* Current argument index being consumed */
-    int cai = 0;
+/* Decoded entry of a signature */
+struct ks_argspec_ent {
 
-    while (*fmt) {
-        const char* cfmt = fmt;
-        while (*fmt && *fmt == ' ') fmt++;
+    /* Kind of entry (see 'ARG_*') */
+    unsigned char kind;
 
-        /* '*name' -> absorb all remaining into this name  
-         * '?name' -> optional argument
-         */
-        bool is_vararg = *fmt == '*', is_opt = *fmt == '?'; 
-        if (is_vararg || is_opt) fmt++;
+    /* Whether the argument is optional ('?name') */
+    bool opt;
+
+    /* Length of 'name', in bytes */
+    int name_len;
+
+    /* Name of the argument (not NUL-terminated, points into the format string) */
+    const char* name;
+
+};
 
+/* Decoded signature */
+struct ks_argspec {
+
+    /* Number of entries */
+    int n;
+
+    /* Array of entries */
+    struct ks_argspec_ent ents[];
+
+};
+
+/* Decode 'fmt' into 'ents' (if non-NULL, with room for 'max' entries), and return the number of entries
+ * If that is more than 'max', only the first 'max' were stored
+ */
+static int spec_decode(const char* fmt, struct ks_argspec_ent* ents, int max) {
+    int n = 0;
+    while (true) {
         /* Spaces are allowed between the entries */
         while (*fmt == ' ') fmt++;
+        if (!*fmt) break;
+
+        struct ks_argspec_ent ent;
+
+        /* '*name' -> absorb all remaining into this name
+         * '?name' -> optional argument
+         */
+        bool is_rest = *fmt == '*';
+        ent.opt = *fmt == '?';
+        if (is_rest || ent.opt) fmt++;
+        while (*fmt == ' ') fmt++;
 
         /* Parse argument name */
-        const char* an = fmt;
-        int an_c = 0;
-        while (*fmt && *fmt != ':' && *fmt != ' ') {
-            an_c++;
+        ent.name = fmt;
+        while (*fmt && *fmt != ':' && *fmt != ' ') fmt++;
+        ent.name_len = (int)(fmt - ent.name);
+
+        ent.kind = is_rest ? ARG_REST : ARG_OBJ;
+        if (!is_rest && *fmt == ':') {
             fmt++;
+            if (*fmt == '*') {
+                fmt++;
+                ent.kind = ARG_TYPE;
+            } else if (strncmp(fmt, "cint", 4) == 0) {
+                fmt += 4;
+                ent.kind = ARG_CINT;
+            } else if (strncmp(fmt, "cfloat", 6) == 0) {
+                fmt += 6;
+                ent.kind = ARG_CFLOAT;
+            } else if (strncmp(fmt, "bool", 4) == 0) {
+                fmt += 4;
+                ent.kind = ARG_BOOL;
+            } else {
+                assert(false && "'KS_ARGS'/similar was given a bad C-style format string");
+            }
         }
 
-        if (is_vararg) {
-            /* Store the rest in these two */
+        if (ents && n < max) ents[n] = ent;
+        n++;
+
+        /* Nothing may come after the rest */
+        if (is_rest) break;
+    }
+    return n;
+}
 
+/* Create a spec for 'fmt' */
+static struct ks_argspec* spec_new(const char* fmt) {
+    int n = spec_decode(fmt, NULL, 0);
+    struct ks_argspec* self = ks_malloc(sizeof(*self) + sizeof(*self->ents) * n);
+    self->n = spec_decode(fmt, self->ents, n);
+    return self;
+}
+
+/* Parse 'args' according to 'n' entries in 'ents' (with 'kk' and 'fmt' as in '_ks_argsv()') */
+static bool spec_parse(int n, const struct ks_argspec_ent* ents, int kk, int nargs, kso* args, const char* fmt, va_list ap) {
+    /* Current argument index being consumed */
+    int cai = 0, i;
+
+    for (i = 0; i < n; ++i) {
+        const struct ks_argspec_ent* ent = &ents[i];
+        if (ent->kind == ARG_REST) {
+            /* Store the rest in these two, and we are done */
             int* to_nargs = va_arg(ap, int*);
             kso** to_args = va_arg(ap, kso**);
 
             *to_nargs = nargs - cai;
             *to_args = &args[cai];
 
-            cai += *to_nargs;
+            cai = nargs;
+            break;
+        }
 
-            /* Done, we consumed the rest */
+        if (cai >= nargs) {
+            if (ent->opt) break;
+            if (kk == 0) {
+                KS_THROW(kst_ArgError, "Missing arguments, only given %i", nargs);
+            } else {
+                KS_THROW(kst_ArgError, "Missing values for value string '%s'", fmt);
+            }
+            return false;
+        }
+
+        /* Consume one more argument */
+        kso cargin = args[cai++];
+        kso* cargto = va_arg(ap, kso*);
+
+        switch (ent->kind) {
+        case ARG_OBJ:
+            *cargto = cargin;
             break;
 
-        } else {
+        case ARG_TYPE: {
+            ks_type req = va_arg(ap, ks_type);
+            assert(req->type == kst_type);
 
-            if (cai >= nargs) {
-                if (is_opt) break;
+            if (!kso_issub(cargin->type, req)) {
                 if (kk == 0) {
-                    KS_THROW(kst_ArgError, "Missing arguments, only given %i", nargs);
+                    KS_THROW(kst_ArgError, "Expected argument '%.*s' to be of type %R, but was of type '%T'", ent->name_len, ent->name, req->i__fullname, cargin);
                 } else {
-                    KS_THROW(kst_ArgError, "Missing values for value string '%s'", o_fmt);
+                    KS_THROW(kst_ArgError, "Expected value '%.*s' to be of type %R, but was of type '%T' (in value string '%s')", ent->name_len, ent->name, req->i__fullname, cargin, fmt);
                 }
-                res = false;
-                break;
+                return false;
             }
-            /* Consume one more argument */
-            kso cargin = args[cai++];
-            kso* cargto = va_arg(ap, kso*);
-
-            if (*fmt == ':') {
-                fmt++;
+            *cargto = cargin;
+            break;
+        }
 
-                if (*fmt == '*') {
-                    fmt++;
-                    ks_type req = va_arg(ap, ks_type);
-                    assert(req->type == kst_type);
-
-                    if (!kso_issub(cargin->type, req)) {
-                        if (kk == 0) {
-                            KS_THROW(kst_ArgError, "Expected argument '%.*s' to be of type %R, but was of type '%T'", an_c, an, req->i__fullname, cargin);
-                        } else {
-                            KS_THROW(kst_ArgError, "Expected value '%.*s' to be of type %R, but was of type '%T' (in value string '%s')", an_c, an, req->i__fullname, cargin, o_fmt);
-                        }
-                        res = false;
-                        break;
-                    }
-
-
-                } else if (strncmp(fmt, "cint", 4) == 0) {
-                    fmt += 4;
-
-                    if (!kso_get_ci(cargin, (ks_cint*)cargto)) {
-                        kso_catch_ignore();
-                        if (kk == 0) {
-                            KS_THROW(kst_Error, "Argument '%.*s' (of type '%T') could not be converted to a C-style int", an_c, an, cargin);
-                        } else {
-                            KS_THROW(kst_Error, "Value '%.*s' (of type '%T') could not be converted to a C-style int", an_c, an, cargin);
-                        }
-                        res = false;
-                        break;
-                    }
-                    continue;
-                } else if (strncmp(fmt, "cfloat", 6) == 0) {
-                    fmt += 6;
-
-                    if (!kso_get_cf(cargin, (ks_cfloat*)cargto)) {
-                        kso_catch_ignore();
-                        if (kk == 0) {
-                            KS_THROW(kst_Error, "Argument '%.*s' (of type '%T') could not be converted to a C-style float", an_c, an, cargin);
-                        } else {
-                            KS_THROW(kst_Error, "Value '%.*s' (of type '%T') could not be converted to a C-style float", an_c, an, cargin);
-                        }
-                        res = false;
-                        break;
-                    }
-                    continue;
-                } else if (strncmp(fmt, "bool", 4) == 0) {
-                    fmt += 4;
-
-                    if (!kso_truthy(cargin, (bool*)cargto)) {
-                        res = false;
-                        break;
-                    }
-                    continue;
+        case ARG_CINT:
+            if (!kso_get_ci(cargin, (ks_cint*)cargto)) {
+                kso_catch_ignore();
+                if (kk == 0) {
+                    KS_THROW(kst_Error, "Argument '%.*s' (of type '%T') could not be converted to a C-style int", ent->name_len, ent->name, cargin);
+                } else {
+                    KS_THROW(kst_Error, "Value '%.*s' (of type '%T') could not be converted to a C-style int", ent->name_len, ent->name, cargin);
+                }
+                return false;
+            }
+            break;
 
+        case ARG_CFLOAT:
+            if (!kso_get_cf(cargin, (ks_cfloat*)cargto)) {
+                kso_catch_ignore();
+                if (kk == 0) {
+                    KS_THROW(kst_Error, "Argument '%.*s' (of type '%T') could not be converted to a C-style float", ent->name_len, ent->name, cargin);
                 } else {
-                    assert(false && "'KS_ARGS'/similar was given a bad C-style format string");
+                    KS_THROW(kst_Error, "Value '%.*s' (of type '%T') could not be converted to a C-style float", ent->name_len, ent->name, cargin);
                 }
+                return false;
             }
+            break;
 
-            *cargto = cargin;
+        case ARG_BOOL:
+            if (!kso_truthy(cargin, (bool*)cargto)) return false;
+            break;
         }
     }
 
-    if (res && cai != nargs) {
+    if (cai != nargs) {
         KS_THROW(kst_ArgError, "Given extra arguments, only expected %i, but given %i", cai, nargs);
-        res = false;
+        return false;
     }
-    /* Success/Fail */
+    return true;
+}
+
+
+/* C-API */
+
+bool kso_parse(int nargs, kso* args, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    bool res = _ks_argsv(1, nargs, args, fmt, ap);
+    va_end(ap);
+    return res;
+}
+
+bool _ks_args(int nargs, kso* args, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    bool res = _ks_argsv(0, nargs, args, fmt, ap);
+    va_end(ap);
     return res;
 }
 
+bool _ks_argsc(struct ks_argspec** spec, int nargs, kso* args, const char* fmt, ...) {
+    if (!*spec) *spec = spec_new(fmt);
 
+    va_list ap;
+    va_start(ap, fmt);
+    bool res = spec_parse((*spec)->n, (*spec)->ents, 0, nargs, args, fmt, ap);
+    va_end(ap);
+    return res;
+}
 
+bool _ks_argsv(int kk, int nargs, kso* args, const char* fmt, va_list ap) {
+    struct ks_argspec_ent ents[ARGS_MAX];
+    int n = spec_decode(fmt, ents, ARGS_MAX);
+    if (n <= ARGS_MAX) return spec_parse(n, ents, kk, nargs, args, fmt, ap);
 
+    /* Too long for the stack, so decode it again into a temporary array */
+    struct ks_argspec_ent* big = ks_smalloc(sizeof(*big) * n);
+    spec_decode(fmt, big, n);
+    bool res = spec_parse(n, big, kk, nargs, args, fmt, ap);
+    ks_free(big);
+    return res;
+}
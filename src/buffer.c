@@ -0,0 +1,60 @@
+/* buffer.c - the buffer protocol, for sharing the memory of objects without copying
+ *
+ * Types which hold raw memory (such as 'bytes', 'bytearray', 'io.BytesIO', and 'nx.array') export it by setting
+ *   'tp->ob_buffer', which fills in a 'struct ks_buffer' describing the memory. Consumers (such as 'nx.view()',
+ *   'io.FileIO.write()', and 'ffi' calls) can then use the memory directly, as long as they hold the buffer
+ *
+ * The buffer holds a reference to 'buf->ref', which is what keeps the memory valid. For most types, this is just
+ *   the object itself, but types whose memory may move (such as 'bytearray') return an object which prevents that
+ *   (such as a view) instead
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+
+/* C-API */
+
+bool ks_buffer_get(kso ob, struct ks_buffer* buf, bool writable) {
+    ks_buffer_f f = ob->type->ob_buffer;
+    if (!f) {
+        KS_THROW(kst_TypeError, "'%T' object does not support the buffer protocol", ob);
+        return false;
+    }
+    if (!f(ob, buf)) return false;
+
+    if (writable && buf->readonly) {
+        ks_buffer_release(buf);
+        KS_THROW(kst_TypeError, "'%T' object has a read-only buffer", ob);
+        return false;
+    }
+    return true;
+}
+
+void ks_buffer_release(struct ks_buffer* buf) {
+    KS_NDECREF(buf->ref);
+    buf->ref = NULL;
+}
+
+void ks_buffer_bytes(struct ks_buffer* buf, kso ref, ks_size_t len_b, void* data, bool readonly) {
+    KS_INCREF(ref);
+    buf->ref = ref;
+    buf->data = data;
+    buf->len_b = len_b;
+    buf->dtype = NULL;
+    buf->size = 1;
+    buf->rank = 1;
+    buf->shape[0] = len_b;
+    buf->strides[0] = 1;
+    buf->readonly = readonly;
+}
+
+bool ks_buffer_contig(struct ks_buffer* buf) {
+    ks_ssize_t stride = buf->size;
+    int i;
+    for (i = buf->rank - 1; i >= 0; --i) {
+        if (buf->shape[i] > 1 && buf->strides[i] != stride) return false;
+        stride *= buf->shape[i];
+    }
+    return true;
+}
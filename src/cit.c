@@ -27,22 +27,18 @@ kso ks_cit_next(ks_cit* cit) {
     /* Don't yield anymore if something has been sent */
     if (cit->exc || !cit->it) return NULL;
 
-    kso res = kso_next(cit->it);
-    if (res) {
-        /* Returns the reference */
-        return res;
-    } else {
-        ksos_thread th = ksos_thread_get();
-        if (th->exc->type == kst_OutOfIterException) {
-            /* Out of elements, which is fine */
-            kso_catch_ignore();
-            KS_DECREF(cit->it);
-            cit->it = NULL;
-            return NULL;
-        } else {
-            /* Had other exception */
-            cit->exc = true;
-            return NULL;
-        }
+    kso res;
+    if (!kso_advance(cit->it, &res)) {
+        /* Had an exception */
+        cit->exc = true;
+        return NULL;
+    } else if (!res) {
+        /* Out of elements, which is fine */
+        KS_DECREF(cit->it);
+        cit->it = NULL;
+        return NULL;
     }
+
+    /* Returns the reference */
+    return res;
 }
@@ -990,8 +990,8 @@ static bool compile(struct compiler* co, ks_str fname, ks_str src, ks_code code,
             }
 
             int tj_l = BC_N;
+            /* Pops the type and (if it matched) pushes the exception, so the stack length is unchanged */
             EMITI(KSB_TRY_CATCH, -1);
-            LEN -= 1;
             int tj_f = BC_N;
             
             
@@ -1335,6 +1335,9 @@ ks_code ks_compile(ks_str fname, ks_str src, ks_ast prog, ks_code from) {
     /* Default of 'ret none' */
     ks_code_emito(res, KSB_PUSH, KSO_NONE);
     ks_code_emit(res, KSB_RET);
+
+    /* The constant map is only needed while compiling (and is shared with all inner functions) */
+    ks_dict_clear(res->vc_map);
     return res;
 }
 
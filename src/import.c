@@ -148,7 +148,7 @@ static ks_module import_path(ks_str p, ks_str name, kso dir) {
 /* C-API */
 
 ks_module ks_import(ks_str name) {
-    ks_module res = (ks_module)ks_dict_get_ih(base_cache, (kso)name, name->v_hash);
+    ks_module res = (ks_module)ks_dict_get_ih(base_cache, (kso)name, KS_STR_HASH(name));
     if (res) return res;
 
     /* Builtin module */
@@ -250,12 +250,12 @@ ks_module ks_import(ks_str name) {
     }
 
     /* Found module, so set in the cache and return */
-    ks_dict_set_h(base_cache, (kso)name, name->v_hash, (kso)res);
+    ks_dict_set_h(base_cache, (kso)name, KS_STR_HASH(name), (kso)res);
     return res;
 }
 
 ks_module ks_import_sub(ks_module of, ks_str sub) {
-    ks_module res = (ks_module)ks_dict_get_h(of->attr, (kso)sub, sub->v_hash);
+    ks_module res = (ks_module)ks_dict_get_h(of->attr, (kso)sub, KS_STR_HASH(sub));
     if (res) return res;
 
     ks_str k = ks_str_new(-1, "__dir");
@@ -58,9 +58,18 @@ static ks_module
 ;
 
 
+#ifdef KS_VMSTATS
+static void vmstats_atexit() {
+    _ksvm_stats_dump(stderr);
+}
+#endif
+
 KS_API bool ks_init() {
     if (has_init) return true;
 
+    /* Hashes must be seeded before any strings are created */
+    _ks_hash_init(getenv("KS_HASHSEED"));
+
     kst_func->ob_sz = sizeof(struct ks_func_s);
     kst_func->ob_attr = offsetof(struct ks_func_s, attr);
     kst_str->ob_sz = sizeof(struct ks_str_s);
@@ -68,8 +77,8 @@ KS_API bool ks_init() {
 
     /* Initialize types */
 
-    /* String constants */
-    #define _CONST(_v, _s) _v = ks_str_new(sizeof(_s) - 1, _s);
+    /* String constants (interned, so lookups with names from source code are fast) */
+    #define _CONST(_v, _s) _v = ks_str_intern_c(sizeof(_s) - 1, _s);
 
 #define _KSACT(_attr) _CONST(_ksva##_attr, #_attr);
 _KS_DO_SPEC(_KSACT)
@@ -110,6 +119,7 @@ _KS_DO_SPEC(_KSACT)
 
     _ksi_str();
     _ksi_bytes();
+    _ksi_bytearray();
     _ksi_regex();
 
     _ksi_slice();
@@ -187,6 +197,7 @@ _KS_DO_SPEC(_KSACT)
 
         {"str",                    (kso)kst_str},
         {"bytes",                  (kso)kst_bytes},
+        {"bytearray",              (kso)kst_bytearray},
         {"regex",                  (kso)kst_regex},
 
         {"slice",                  (kso)kst_slice},
@@ -286,6 +297,16 @@ _KS_DO_SPEC(_KSACT)
         kso_catch_ignore();
     }
 
+    /* Write a perf map, if requested (see 'perf.c') */
+    if (getenv("KS_PERF") && !ks_perf_start()) {
+        kso_catch_ignore_print();
+    }
+
+    #ifdef KS_VMSTATS
+    /* Report instruction statistics at exit, if requested */
+    if (getenv("KS_VMSTATS")) atexit(vmstats_atexit);
+    #endif
+
     return has_init = true;
 }
 
@@ -106,6 +106,24 @@ static bool do_f(ks_str fname) {
     return true;
 }
 
+/* Stop the profiler, write folded stacks to 'fname', and print a summary table */
+static bool do_profile_end(ksos_profile prof, ks_str fname) {
+    if (!ksos_profile_stop(prof)) return false;
+
+    FILE* fp = fopen(fname->data, "w");
+    if (!fp) {
+        KS_THROW(kst_IOError, "Failed to open %R for writing profile: %s", fname, strerror(errno));
+        return false;
+    }
+
+    ksio_FileIO fio = ksio_FileIO_wrap(ksiot_FileIO, fp, true, fname, _ksv_w);
+    bool res = ksos_profile_folded(prof, (ksio_BaseIO)fio);
+    KS_DECREF(fio);
+    if (!res) return false;
+
+    return ksos_profile_table(prof, (ksio_BaseIO)ksos_stderr);
+}
+
 /** Action **/
 
 static KS_FUNC(import) {
@@ -134,6 +152,15 @@ static KS_FUNC(verbose) {
 
     return KSO_NONE;
 }
+static KS_FUNC(perf) {
+    kso parser;
+    ks_str name, arg;
+    KS_ARGS("parser name:* arg:*", &parser, &name, kst_str, &arg, kst_str);
+
+    if (!ks_perf_start()) return NULL;
+
+    return KSO_NONE;
+}
 
 
 int main(int argc, char** argv) {
@@ -152,21 +179,25 @@ int main(int argc, char** argv) {
 
     kso on_import = ksf_wrap(import_, "on_import(name)", "Imports a module name to the global interpreter vars");
     kso on_verbose = ksf_wrap(verbose_, "on_verbose(name)", "Increases verbosity");
+    kso on_perf = ksf_wrap(perf_, "on_perf(name)", "Starts writing a perf map");
 
     ksga_opt(p, "import", "Imports a module name before running anything", "-i,--import", on_import, KSO_NONE);
     ksga_flag(p, "verbose", "Increase the default verbosity", "-v,--verbose", on_verbose);
     ksga_opt(p, "expr", "Compiles and runs an expression", "-e,--expr", NULL, KSO_NONE);
     ksga_opt(p, "code", "Compiles and runs code", "-c,--code", NULL, KSO_NONE);
+    ksga_opt(p, "profile", "Profiles the program, writing folded stacks to the given file (and a summary to stderr)", "--profile", NULL, KSO_NONE);
+    ksga_flag(p, "perf", "Executes functions through trampolines, and writes '/tmp/perf-<pid>.map' so that 'perf' can show kscript functions", "--perf", on_perf);
     ksga_pos(p, "args", "File to run and arguments given to it", NULL, -1);
 
     KS_DECREF(on_import);
     KS_DECREF(on_verbose);
+    KS_DECREF(on_perf);
 
     ks_dict args = ksga_parse(p, ksos_argv);
     kso_exit_if_err();
 
     /* Get arguments */
-    kso expr = ks_dict_get_c(args, "expr"), code = ks_dict_get_c(args, "code");
+    kso expr = ks_dict_get_c(args, "expr"), code = ks_dict_get_c(args, "code"), profile = ks_dict_get_c(args, "profile");
     ks_list newargv = (ks_list)ks_dict_get_c(args, "args");
     kso_exit_if_err();
 
@@ -188,6 +219,14 @@ int main(int argc, char** argv) {
     KS_DECREF(p);
     bool res = false;
 
+    ksos_profile prof = NULL;
+    if (profile != KSO_NONE) {
+        prof = ksos_profile_new(ksost_profile, 0.001);
+        if (!ksos_profile_start(prof)) {
+            kso_exit_if_err();
+        }
+    }
+
     if (expr == KSO_NONE && code == KSO_NONE) {
         /* Run file */
         ks_str fname = (ks_str)ksos_argv->elems[0];
@@ -210,9 +249,20 @@ int main(int argc, char** argv) {
         KS_THROW(kst_Error, "Given both '-e' and '-c'");
     }
 
+    if (prof) {
+        /* Only write results if the program succeeded, so the original error is reported */
+        if (res) {
+            res = do_profile_end(prof, (ks_str)profile);
+        } else {
+            ksos_profile_stop(prof);
+        }
+        KS_DECREF(prof);
+    }
+
 
     KS_DECREF(expr);
     KS_DECREF(code);
+    KS_DECREF(profile);
     KS_DECREF(newargv);
     KS_DECREF(args);
     kso_exit_if_err();
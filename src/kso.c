@@ -185,7 +185,7 @@ bool kso_hash(kso ob, ks_hash_t* val) {
         *val = mpz_fdiv_ui(v->val, KS_HASH_P);
         return true;
     } else if (kso_isinst(ob, kst_str) && ob->type->i__hash == kst_str->i__hash) {
-        *val = ((ks_str)ob)->v_hash;
+        *val = KS_STR_HASH((ks_str)ob);
         return true;
     } else if (kso_isinst(ob, kst_tuple) && ob->type->i__hash == kst_tuple->i__hash) {
         *val = 0;
@@ -418,7 +418,7 @@ bool kso_is_complex(kso obj) {
     return kso_issub(obj->type, kst_complex) || obj->type->i__complex;
 }
 bool kso_is_iterable(kso obj) {
-    return obj->type->i__iter || obj->type->i__next;
+    return obj->type->i__iter || obj->type->i__next || obj->type->ob_next;
 }
 
 bool kso_is_callable(kso obj) {
@@ -427,7 +427,9 @@ bool kso_is_callable(kso obj) {
 
 
 ks_dict kso_try_getattr_dict(kso obj) {
-    if (obj->type->ob_attr > 0) {
+    if (obj->type->ob_slots > 0) {
+        return _kso_slots_todict(obj);
+    } else if (obj->type->ob_attr > 0) {
         return *(ks_dict*)((ks_uint)obj + obj->type->ob_attr);
     } else return NULL;
 }
@@ -458,14 +460,24 @@ kso kso_getattr(kso ob, ks_str attr) {
         }
     }
 
-    ks_dict attrdict = kso_try_getattr_dict(ob);
-    if (attrdict) {
-        if (ks_str_eq_c(attr, "__attr", 6)) {
-            return KS_NEWREF(attrdict);
+    if (ob->type->ob_attr > 0 && ks_str_eq_c(attr, "__attr", 6)) {
+        return KS_NEWREF(kso_try_getattr_dict(ob));
+    }
+
+    /* Attributes stored by shape */
+    if (ob->type->ob_slots > 0) {
+        struct ks_slots* slots = KSO_SLOTS(ob);
+        if (slots->shape) {
+            ks_cint i = ks_shape_find(slots->shape, attr);
+            if (i >= 0) return KS_NEWREF(slots->vals[i]);
         }
+    }
+
+    ks_dict attrdict = ob->type->ob_attr > 0 ? *(ks_dict*)((ks_uint)ob + ob->type->ob_attr) : NULL;
+    if (attrdict) {
 
         /* Search for it */
-        kso res = ks_dict_get_ih(attrdict, (kso)attr, attr->v_hash);
+        kso res = ks_dict_get_ih(attrdict, (kso)attr, KS_STR_HASH(attr));
         if (res) {
             return res;
         }
@@ -486,7 +498,7 @@ kso kso_getattr(kso ob, ks_str attr) {
     return NULL;
 }
 kso kso_getattr_c(kso ob, const char* attr) {
-    ks_str k = ks_str_new(-1, attr);
+    ks_str k = ks_str_intern_c(-1, attr);
     kso r = kso_getattr(ob, k);
     KS_DECREF(k);
     return r;
@@ -508,11 +520,15 @@ bool kso_setattr(kso ob, ks_str attr, kso val) {
         }
     }
 
+    if (ob->type->ob_slots > 0) {
+        if (_kso_slots_set(ob, attr, val)) return true;
+    }
+
     ks_dict attrdict = kso_try_getattr_dict(ob);
     if (attrdict) {
 
         /* Search for it */
-        if (ks_dict_set_h(attrdict, (kso)attr, attr->v_hash, val)) {
+        if (ks_dict_set_h(attrdict, (kso)attr, KS_STR_HASH(attr), val)) {
             return true;
         } else {
             kso_catch_ignore();
@@ -831,17 +847,17 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
                     int n_va = nargs - (n_before + n_after);
 
                     for (i = 0; i < n_before; ++i) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, args[i]);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), args[i]);
                         assert(b);
                     }
                     ks_list vas = ks_list_new(n_va, args + i);
-                    ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, (kso)vas);
+                    ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), (kso)vas);
                     i += n_va;
                     KS_DECREF(vas);
 
                     int j;
                     for (j = n_before+1; i < nargs; ++i, ++j) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[j].name, f->bfunc.pars[j].name->v_hash, args[i]);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[j].name, KS_STR_HASH(f->bfunc.pars[j].name), args[i]);
                         assert(b);
                     }
 
@@ -855,7 +871,7 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
                     KS_THROW(kst_ArgError, "Expected between %i and %i arguments, but got %i", f->bfunc.n_req, f->bfunc.n_pars, nargs);
                 } else {
                     for (i = 0; i < f->bfunc.n_pars; ++i) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, i < nargs ? args[i] : f->bfunc.pars[i].defa);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), i < nargs ? args[i] : f->bfunc.pars[i].defa);
                         assert(b);
                     }
 
@@ -1041,7 +1057,7 @@ kso kso_call(kso func, int nargs, kso* args) {
 kso kso_iter(kso ob) {
     if (ob->type->i__iter) {
         return kso_call(ob->type->i__iter, 1, &ob);
-    } else if (ob->type->i__next) {
+    } else if (ob->type->i__next || ob->type->ob_next) {
         /* Already is iterable */
         return KS_NEWREF(ob);
     }
@@ -1050,114 +1066,33 @@ kso kso_iter(kso ob) {
     return NULL;
 }
 
-kso kso_next(kso ob) {
-    if (kso_issub(ob->type, kst_str_iter) && ob->type->i__next == kst_str_iter->i__next) {
-        /* String iteration */
-        ks_str_iter it = (ks_str_iter)ob;
-        if (it->pos >= it->of->len_b) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-
-        /* Otherwise, continue and skip UTF-8 continuations */
-        int ct = 0;
-        do {
-            ct++;
-        } while (ct < 4 && (((unsigned char*)it->of->data)[it->pos + ct] & 0x80) != 0);
-        assert(ct > 0);
-        ks_str res = ks_str_new(ct, it->of->data + it->pos);
-        it->pos += ct;
-        return (kso)res;
-    } else if (kso_issub(ob->type, kst_list_iter) && ob->type->i__next == kst_list_iter->i__next) {
-        ks_list_iter it = (ks_list_iter)ob;
-        if (it->pos >= it->of->len) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-
-        return KS_NEWREF(it->of->elems[it->pos++]);
-    } else if (kso_issub(ob->type, kst_tuple_iter) && ob->type->i__next == kst_tuple_iter->i__next) {
-        ks_tuple_iter it = (ks_tuple_iter)ob;
-        if (it->pos >= it->of->len) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-
-        return KS_NEWREF(it->of->elems[it->pos++]);
-    } else if (kso_issub(ob->type, kst_set_iter) && ob->type->i__next == kst_set_iter->i__next) {
-        ks_set_iter it = (ks_set_iter)ob;
-        if (it->pos >= it->of->len_ents) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-        while (!it->of->ents[it->pos].key) it->pos++;
-        if (it->pos >= it->of->len_ents) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-        return KS_NEWREF(it->of->ents[it->pos++].key);
-    } else if (kso_issub(ob->type, kst_dict_iter) && ob->type->i__next == kst_dict_iter->i__next) {
-        ks_dict_iter it = (ks_dict_iter)ob;
-        if (it->pos >= it->of->len_ents) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-        while (!it->of->ents[it->pos].key) it->pos++;
-        if (it->pos >= it->of->len_ents) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-        return KS_NEWREF(it->of->ents[it->pos++].key);
-    } else if (kso_issub(ob->type, kst_range_iter) && ob->type->i__next == kst_range_iter->i__next) {
-        /* Range iterator */
-        ks_range_iter it = (ks_range_iter)ob;
-        if (it->done) {
-            KS_OUTOFITER();
-            return NULL;
-        }
-
-        /* Shortcut for speedup */
-        if (it->use_ci) {
-            ks_cint n_cur = it->_ci.cur + it->_ci.step;
-            int cmp_ce = (it->_ci.cur > it->_ci.end) - (it->_ci.cur < it->_ci.end);
-
-            if (cmp_ce == 0 || (it->cmp_step_0 > 0 && cmp_ce > 0) || (it->cmp_step_0 < 0 && cmp_ce < 0)) {
-                it->done = true;
-                KS_OUTOFITER();
-                return NULL;
-            }
-
-            ks_int res = ks_int_new(it->_ci.cur);
-            it->_ci.cur = n_cur;
-
-            return (kso)res;
-        }
-
-        /* Determine the next value */
-        if (it->cur) {
-
-            ks_int newcur = (ks_int)ks_bop_add((kso)it->cur, (kso)it->of->step);
-            if (!newcur) return NULL;
-            assert(newcur->type == kst_int);
-            KS_DECREF(it->cur);
-            it->cur = (ks_int)newcur;
-
-        } else {
-            it->cur = (ks_int)KS_NEWREF(it->of->start);
-        }
+bool kso_advance(kso ob, kso* res) {
+    if (ob->type->ob_next) {
+        return ob->type->ob_next(ob, res);
+    }
 
-        /* Do bounds check */
-        int cmp_ce = ks_int_cmp(it->cur, it->of->end);
+    *res = kso_next(ob);
+    if (*res) return true;
 
-        /* Do check with step direction */
-        if (cmp_ce == 0 || (it->cmp_step_0 > 0 && cmp_ce > 0) || (it->cmp_step_0 < 0 && cmp_ce < 0)) {
-            it->done = true;
-            KS_OUTOFITER();
-            return NULL;
-        }
+    ksos_thread th = ksos_thread_get();
+    if (th->exc->type == kst_OutOfIterException) {
+        /* Out of elements, which is fine */
+        kso_catch_ignore();
+        return true;
+    }
+    return false;
+}
 
-        return KS_NEWREF(it->cur);
+kso kso_next_f(ks_next_f f, kso ob) {
+    kso res;
+    if (!f(ob, &res)) return NULL;
+    if (!res) KS_OUTOFITER();
+    return res;
+}
 
+kso kso_next(kso ob) {
+    if (ob->type->ob_next) {
+        return kso_next_f(ob->type->ob_next, ob);
     } else if (ob->type->i__next) {
         return kso_call(ob->type->i__next, 1, &ob);
     } else {
@@ -1270,7 +1205,14 @@ void kso_exit_if_err() {
 
 kso _kso_new(ks_type tp) {
     assert(tp->ob_sz > 0);
-    kso res = ks_zmalloc(1, tp->ob_sz);
+    kso res = _kso_init(tp, ks_zmalloc(1, tp->ob_sz));
+    if (_ks_memtrace_active) _ks_memtrace_settype(res, tp);
+
+    return res;
+}
+
+kso _kso_init(ks_type tp, void* mem) {
+    kso res = mem;
     memset(res, 0, tp->ob_sz);
 
     KS_INCREF(tp);
@@ -1279,7 +1221,10 @@ kso _kso_new(ks_type tp) {
 
     tp->num_obs_new++;
 
-    if (tp->ob_attr > 0) {
+    if (tp->ob_slots > 0) {
+        /* Start with no attributes (the dictionary is created if needed) */
+        KSO_SLOTS(res)->shape = tp->ob_shape;
+    } else if (tp->ob_attr > 0) {
         /* Initialize attribute dictionary */
         ks_dict* attr = (ks_dict*)(((ks_uint)res + tp->ob_attr));
         *attr = ks_dict_new(NULL);
@@ -1289,12 +1234,19 @@ kso _kso_new(ks_type tp) {
 }
 
 void _kso_del(kso ob) {
+    _kso_fini(ob);
+    ks_free(ob);
+}
+
+void _kso_fini(kso ob) {
     if (ob->refs < 0) {
         printf("BAD REFS ON: '%s' obj: %lli\n", ob->type->i__fullname->data, (long long int)ob->refs);
         exit(1);
     }
 
-    if (ob->type->ob_attr > 0) {
+    if (ob->type->ob_slots > 0) {
+        _kso_slots_del(ob);
+    } else if (ob->type->ob_attr > 0) {
         /* Initialize attribute dictionary */
         ks_dict* attr = (ks_dict*)(((ks_uint)ob + ob->type->ob_attr));
     
@@ -1303,8 +1255,6 @@ void _kso_del(kso ob) {
 
     ob->type->num_obs_del++;
     KS_DECREF(ob->type);
-
-    ks_free(ob);
 }
 
 kso _ks_newref(kso ob) {
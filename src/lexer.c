@@ -11,21 +11,55 @@
 
 /** Internals/Utilities **/
 
+/* Character classes for ASCII, so the common cases are a single table lookup */
+enum {
+    CC_BIN    = 0x01,
+    CC_OCT    = 0x02,
+    CC_DEC    = 0x04,
+    CC_HEX    = 0x08,
+    CC_NAME_S = 0x10,
+    CC_NAME_M = 0x20,
+    CC_SPACE  = 0x40,
+};
+
+/* Table of 'CC_*' flags for each ASCII character (filled on first use) */
+static unsigned char cc_tbl[128];
+static bool cc_init = false;
+
+static void cc_fill() {
+    int i;
+    for (i = 0; i < 128; ++i) {
+        int f = 0;
+        if ('0' <= i && i <= '1') f |= CC_BIN;
+        if ('0' <= i && i <= '7') f |= CC_OCT;
+        if ('0' <= i && i <= '9') f |= CC_DEC | CC_HEX | CC_NAME_M;
+        if (('a' <= i && i <= 'f') || ('A' <= i && i <= 'F')) f |= CC_HEX;
+        if (('a' <= i && i <= 'z') || ('A' <= i && i <= 'Z') || i == '_') f |= CC_NAME_S | CC_NAME_M;
+        if (i == ' ' || i == '\t' || i == '\v' || i == '\f' || i == '\r') f |= CC_SPACE;
+        cc_tbl[i] = f;
+    }
+    cc_init = true;
+}
+
+/* Test if a character is in a class (only ASCII characters ever are) */
+#define CC_IS(_c, _f) ((_c) >= 0 && (_c) < 128 && (cc_tbl[(_c)] & (_f)))
+
 /* Test if a character is a valid digit in base 'b' */
 static bool is_digit(ks_ucp c, int b) {
-    /**/ if (b == 2) return '0' <= c && c <= '1';
-    else if (b == 8) return '0' <= c && c <= '7';
-    else if (b == 10) return '0' <= c && c <= '9';
-    else if (b == 16) return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+    /**/ if (b == 2) return CC_IS(c, CC_BIN);
+    else if (b == 8) return CC_IS(c, CC_OCT);
+    else if (b == 10) return CC_IS(c, CC_DEC);
+    else if (b == 16) return CC_IS(c, CC_HEX);
     else {
         assert(false);
+        return false;
     }
 }
 
 /* Test if a character is a valid start of an identifier */
 static bool is_name_s(ks_ucp c) {
-    if (c < 128) {
-        if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_') return true;
+    if (c >= 0 && c < 128) {
+        return cc_tbl[c] & CC_NAME_S;
     } else {
         /* TODO: unicode */
         struct ksucd_info info;
@@ -39,10 +73,8 @@ static bool is_name_s(ks_ucp c) {
 
 /* Test if a character is a valid middle of an identifier */
 static bool is_name_m(ks_ucp c) {
-    if (is_name_s(c)) return true;
-    if (is_digit(c, 10)) return true;
-
-    return false;
+    if (c >= 0 && c < 128) return cc_tbl[c] & CC_NAME_M;
+    return is_name_s(c);
 }
 
 
@@ -71,6 +103,8 @@ ks_tok ks_tok_combo(ks_tok a, ks_tok b) {
 
 
 ks_str ks_tok_str(ks_str src, ks_tok tok) {
+    /* Identifiers are interned, since they are used as keys */
+    if (tok.kind == KS_TOK_NAME) return ks_str_intern_c(tok.epos - tok.spos, src->data + tok.spos);
     return ks_str_new(tok.epos - tok.spos, src->data + tok.spos);
 }
 
@@ -129,8 +163,11 @@ ks_ssize_t ks_lex(ks_str fname, ks_str src, ks_tok** toksp) {
 
     int sz = src->len_b;
     ks_ucp c = 0;
+    int cn = 0;
     char utf8[5];
 
+    if (!cc_init) cc_fill();
+
     /* Output (along with '*toks') */
     ks_ssize_t n_toks = 0, max_n_toks = 0;
 
@@ -161,16 +198,14 @@ ks_ssize_t ks_lex(ks_str fname, ks_str src, ks_tok** toksp) {
         } else { \
             col++; \
         } \
-        int _n = 0; \
-        KS_UCP_FROM_UTF8(c, (src->data + pos), _n); \
-        pos += _n; \
+        pos += cn; \
         _UPDATEC(); \
     } while (0)
 
+    /* Decode the character at 'pos' into 'c', and its length into 'cn' */
     #define _UPDATEC() do { \
-        int _n = 0; \
-        KS_UCP_FROM_UTF8(c, (src->data + pos), _n); \
-        if (_n < 1) { \
+        KS_UCP_FROM_UTF8(c, (src->data + pos), cn); \
+        if (cn < 1) { \
             bad = MAKE(KS_TOK_MANY); \
             KS_THROW_SYNTAX(fname, src, bad, "Bad characters in string"); \
             return -1; \
@@ -178,12 +213,12 @@ ks_ssize_t ks_lex(ks_str fname, ks_str src, ks_tok** toksp) {
     } while (0)
 
     /* Get whether the next part of the input is a given C string */
-    #define NEXTIS(_cstr) (strncmp(src->data + pos, _cstr, sizeof(_cstr) - 1) == 0)
+    #define NEXTIS(_cstr) (src->data[pos] == (_cstr)[0] && strncmp(src->data + pos, _cstr, sizeof(_cstr) - 1) == 0)
 
     _UPDATEC();
     while (pos < sz) {
         /* Strip whitespace */
-        while (pos < sz && (c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r')) {
+        while (pos < sz && CC_IS(c, CC_SPACE)) {
             ADV();
         }
 
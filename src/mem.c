@@ -18,6 +18,8 @@ void* ks_malloc(ks_size_t sz) {
         /* Failed to allocate requested bytes */
     }
 
+    if (_ks_memtrace_active) _ks_memtrace_add(res, sz);
+
     return res;
 }
 void* ks_smalloc(ks_size_t sz) {
@@ -42,10 +44,17 @@ void* ks_zmalloc(ks_size_t sz, ks_size_t num) {
 }
 
 void* ks_realloc(void* ptr, ks_size_t sz) {
+    /* Remember the old address, since 'ptr' can't be used after it has been reallocated ('volatile' so that the
+     *   conversion happens before the call, instead of being moved after it)
+     */
+    volatile uintptr_t optr = (uintptr_t)ptr;
     void* res = realloc(ptr, sz);
 
     if (!res && sz > 0) {
         /* Failed to allocate requested bytes */
+    } else if (_ks_memtrace_active) {
+        if (optr) _ks_memtrace_realloc(optr, res, sz);
+        else _ks_memtrace_add(res, sz);
     }
 
     return res;
@@ -57,6 +66,7 @@ void* ks_zrealloc(void* ptr, ks_size_t sz, ks_size_t num) {
 
 void ks_free(void* ptr) {
     if (!ptr) return;
+    if (_ks_memtrace_active) _ks_memtrace_del(ptr);
 
     free(ptr);
 }
@@ -74,3 +84,76 @@ ks_ssize_t ks_nextsize(ks_ssize_t cur_sz, ks_ssize_t req) {
     }
 }
 
+
+
+/* Arenas */
+
+/* Size of the blocks arenas allocate (larger allocations get a block of their own) */
+#define ARENA_BLK (64 * 1024)
+
+/* Alignment of allocations from arenas */
+#define ARENA_ALIGN 16
+
+struct ks_arena_s {
+
+    /* Number of allocations which haven't been released */
+    ks_size_t live;
+
+    /* Whether the arena has been closed */
+    bool closed;
+
+    /* Most recent block (each block begins with a pointer to the previous one) */
+    void* blk;
+
+    /* Free space in the most recent block */
+    char* pos, *end;
+
+};
+
+/* Free an arena and its blocks */
+static void arena_del(ks_arena self) {
+    void* blk = self->blk;
+    while (blk) {
+        void* prev = *(void**)blk;
+        ks_free(blk);
+        blk = prev;
+    }
+    ks_free(self);
+}
+
+ks_arena ks_arena_new() {
+    ks_arena self = ks_smalloc(sizeof(*self));
+    self->live = 0;
+    self->closed = false;
+    self->blk = NULL;
+    self->pos = self->end = NULL;
+    return self;
+}
+
+void* ks_arena_alloc(ks_arena self, ks_size_t sz) {
+    assert(!self->closed);
+    sz = (sz + ARENA_ALIGN - 1) & ~(ks_size_t)(ARENA_ALIGN - 1);
+    if ((ks_size_t)(self->end - self->pos) < sz) {
+        ks_size_t bsz = ARENA_ALIGN + sz > ARENA_BLK ? ARENA_ALIGN + sz : ARENA_BLK;
+        void* blk = ks_smalloc(bsz);
+        *(void**)blk = self->blk;
+        self->blk = blk;
+        self->pos = (char*)blk + ARENA_ALIGN;
+        self->end = (char*)blk + bsz;
+    }
+
+    void* res = self->pos;
+    self->pos += sz;
+    self->live++;
+    return res;
+}
+
+void ks_arena_release(ks_arena self) {
+    assert(self->live > 0);
+    if (--self->live == 0 && self->closed) arena_del(self);
+}
+
+void ks_arena_close(ks_arena self) {
+    self->closed = true;
+    if (self->live == 0) arena_del(self);
+}
@@ -0,0 +1,360 @@
+/* memtrace.c - allocation tracing, for finding memory usage and growth
+ *
+ * When active, each block allocated by 'ks_malloc()'/friends is recorded in a table keyed on the pointer,
+ *   along with its size and the site that allocated it. A site is the type of object (if it was allocated
+ *   via '_kso_new()', otherwise 'NULL' for raw memory), and the file and line of the kscript code that was
+ *   executing (found from the current thread's innermost bytecode frame)
+ *
+ * The tables here are allocated with the C library directly (not 'ks_malloc()'), so that tracing does not
+ *   recurse. Since allocations are made while holding the GIL, no additional locking is done
+ *
+ * Blocks allocated before tracing started are not tracked, and are ignored when freed
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+
+/* Internals */
+
+bool _ks_memtrace_active = false;
+
+/* If true, new allocations are not recorded (but frees still are) */
+static bool is_paused = false;
+
+/* Where an allocation came from */
+struct site {
+
+    /* Type of object (or NULL for raw memory), and file it was from (or NULL if not from kscript code)
+     * Both hold references
+     */
+    ks_type tp;
+    ks_str fname;
+    int line;
+
+    /* Number of live blocks and their total size */
+    ks_size_t count, bytes;
+
+};
+
+/* Live block */
+struct block {
+
+    /* Pointer to the memory (or NULL if this entry is empty, or 'TOMB' if it has been deleted) */
+    void* ptr;
+
+    ks_size_t sz;
+
+    /* Index into 'sites' */
+    int site;
+
+};
+
+/* Marker for a deleted block */
+#define TOMB ((void*)1)
+
+/* Array of sites, and an open-addressing table of indices into them (-1 for empty) */
+static int n_sites = 0, max_sites = 0;
+static struct site* sites = NULL;
+static int len_site_idx = 0;
+static int* site_idx = NULL;
+
+/* Open-addressing table of blocks (always a power of two) */
+static ks_size_t len_blocks = 0, n_blocks = 0, n_used = 0;
+static struct block* blocks = NULL;
+
+/* Current and peak (high-water mark) number of bytes tracked, and total number of allocations */
+static ks_size_t cur_bytes = 0, peak_bytes = 0, n_allocs = 0;
+
+
+/* Hash a pointer */
+static ks_size_t ptr_hash(void* ptr) {
+    ks_uint x = (ks_uint)ptr;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    return (ks_size_t)x;
+}
+
+static ks_size_t site_hash(ks_type tp, ks_str fname, int line) {
+    return ptr_hash(tp) * 31 + ptr_hash(fname) * 7 + line;
+}
+
+/* Find (or create) the site index */
+static int get_site(ks_type tp, ks_str fname, int line) {
+    if (2 * (n_sites + 1) > len_site_idx) {
+        /* Rehash */
+        int nlen = len_site_idx ? 2 * len_site_idx : 64, i;
+        int* nidx = malloc(sizeof(*nidx) * nlen);
+        if (!nidx) return -1;
+        for (i = 0; i < nlen; ++i) nidx[i] = -1;
+        for (i = 0; i < n_sites; ++i) {
+            ks_size_t j = site_hash(sites[i].tp, sites[i].fname, sites[i].line) & (nlen - 1);
+            while (nidx[j] >= 0) j = (j + 1) & (nlen - 1);
+            nidx[j] = i;
+        }
+        free(site_idx);
+        site_idx = nidx;
+        len_site_idx = nlen;
+    }
+
+    ks_size_t j = site_hash(tp, fname, line) & (len_site_idx - 1);
+    while (site_idx[j] >= 0) {
+        struct site* s = &sites[site_idx[j]];
+        if (s->tp == tp && s->fname == fname && s->line == line) return site_idx[j];
+        j = (j + 1) & (len_site_idx - 1);
+    }
+
+    if (n_sites >= max_sites) {
+        int nmax = max_sites ? 2 * max_sites : 64;
+        struct site* nsites = realloc(sites, sizeof(*nsites) * nmax);
+        if (!nsites) return -1;
+        sites = nsites;
+        max_sites = nmax;
+    }
+
+    int res = n_sites++;
+    if (tp) KS_INCREF(tp);
+    if (fname) KS_INCREF(fname);
+    sites[res].tp = tp;
+    sites[res].fname = fname;
+    sites[res].line = line;
+    sites[res].count = sites[res].bytes = 0;
+    site_idx[j] = res;
+    return res;
+}
+
+/* Find the block entry for 'ptr', or NULL if it is not tracked */
+static struct block* find_block(void* ptr) {
+    if (!blocks) return NULL;
+    ks_size_t j = ptr_hash(ptr) & (len_blocks - 1);
+    while (blocks[j].ptr) {
+        if (blocks[j].ptr == ptr) return &blocks[j];
+        j = (j + 1) & (len_blocks - 1);
+    }
+    return NULL;
+}
+
+static bool grow_blocks() {
+    ks_size_t nlen = len_blocks ? 2 * len_blocks : 1024, i;
+    /* Don't grow if it was just full of deleted entries */
+    if (len_blocks && 2 * n_blocks < len_blocks) nlen = len_blocks;
+    struct block* nb = calloc(nlen, sizeof(*nb));
+    if (!nb) return false;
+    for (i = 0; i < len_blocks; ++i) {
+        if (blocks[i].ptr && blocks[i].ptr != TOMB) {
+            ks_size_t j = ptr_hash(blocks[i].ptr) & (nlen - 1);
+            while (nb[j].ptr) j = (j + 1) & (nlen - 1);
+            nb[j] = blocks[i];
+        }
+    }
+    free(blocks);
+    blocks = nb;
+    len_blocks = nlen;
+    n_used = n_blocks;
+    return true;
+}
+
+/* Calculate where the current thread is executing
+ * If 'optr' is being reallocated and is the frame array itself, then it is being resized (and is not valid)
+ */
+static void get_where(void* optr, ks_str* fname, int* line) {
+    *fname = NULL;
+    *line = 0;
+    if (!ksg_main_thread) return;
+
+    ksos_thread th = ksos_thread_get();
+    if (!th || (optr && (void*)th->frames->elems == optr)) return;
+
+    ks_cint i;
+    for (i = th->frames->len - 1; i >= 0; --i) {
+        if (ksos_frame_where((ksos_frame)th->frames->elems[i], fname, line)) return;
+    }
+}
+
+/* Record 'ptr', which was allocated (or reallocated from 'optr' if it was not being tracked) */
+static void add(void* optr, void* ptr, ks_size_t sz) {
+    if (!ptr || is_paused) return;
+
+    /* Stale entry (i.e. it was released with 'free()' directly) */
+    if (find_block(ptr)) _ks_memtrace_del(ptr);
+    if (2 * (n_used + 1) > len_blocks && !grow_blocks()) return;
+
+    ks_str fname;
+    int line;
+    get_where(optr, &fname, &line);
+    int si = get_site(NULL, fname, line);
+    if (si < 0) return;
+
+    ks_size_t j = ptr_hash(ptr) & (len_blocks - 1);
+    while (blocks[j].ptr && blocks[j].ptr != TOMB) j = (j + 1) & (len_blocks - 1);
+    if (!blocks[j].ptr) n_used++;
+    blocks[j].ptr = ptr;
+    blocks[j].sz = sz;
+    blocks[j].site = si;
+    n_blocks++;
+
+    sites[si].count++;
+    sites[si].bytes += sz;
+    cur_bytes += sz;
+    if (cur_bytes > peak_bytes) peak_bytes = cur_bytes;
+    n_allocs++;
+}
+
+void _ks_memtrace_add(void* ptr, ks_size_t sz) {
+    add(NULL, ptr, sz);
+}
+
+void _ks_memtrace_del(void* ptr) {
+    struct block* b = find_block(ptr);
+    if (!b) return;
+
+    sites[b->site].count--;
+    sites[b->site].bytes -= b->sz;
+    cur_bytes -= b->sz;
+
+    b->ptr = TOMB;
+    n_blocks--;
+}
+
+void _ks_memtrace_realloc(uintptr_t optr, void* nptr, ks_size_t sz) {
+    /* Only used as a key (the memory itself has been freed if it moved) */
+    void* ptr = (void*)optr;
+    struct block* b = find_block(ptr);
+    if (!b) {
+        /* Treat as a new allocation (if not paused) */
+        add(ptr, nptr, sz);
+        return;
+    }
+
+    /* Keep the original site */
+    int si = b->site;
+    ks_size_t osz = b->sz;
+    if (ptr == nptr) {
+        b->sz = sz;
+    } else {
+        b->ptr = TOMB;
+        n_blocks--;
+        if (2 * (n_used + 1) > len_blocks && !grow_blocks()) {
+            sites[si].count--;
+            sites[si].bytes -= osz;
+            cur_bytes -= osz;
+            return;
+        }
+        ks_size_t j = ptr_hash(nptr) & (len_blocks - 1);
+        while (blocks[j].ptr && blocks[j].ptr != TOMB) j = (j + 1) & (len_blocks - 1);
+        if (!blocks[j].ptr) n_used++;
+        blocks[j].ptr = nptr;
+        blocks[j].sz = sz;
+        blocks[j].site = si;
+        n_blocks++;
+    }
+
+    sites[si].bytes += sz - osz;
+    cur_bytes += sz - osz;
+    if (cur_bytes > peak_bytes) peak_bytes = cur_bytes;
+}
+
+void _ks_memtrace_settype(kso ob, ks_type tp) {
+    struct block* b = find_block(ob);
+    if (!b) return;
+
+    struct site* s = &sites[b->site];
+    int si = get_site(tp, s->fname, s->line);
+    if (si < 0) return;
+
+    /* NOTE: 'get_site()' may have moved the array */
+    sites[b->site].count--;
+    sites[b->site].bytes -= b->sz;
+    sites[si].count++;
+    sites[si].bytes += b->sz;
+    b->site = si;
+}
+
+/* Clear all entries */
+static void clear_all() {
+    int i;
+    for (i = 0; i < n_sites; ++i) {
+        KS_NDECREF(sites[i].tp);
+        KS_NDECREF(sites[i].fname);
+    }
+    free(sites);
+    free(site_idx);
+    free(blocks);
+    sites = NULL;
+    site_idx = NULL;
+    blocks = NULL;
+    n_sites = max_sites = len_site_idx = 0;
+    len_blocks = n_blocks = n_used = 0;
+    cur_bytes = peak_bytes = n_allocs = 0;
+}
+
+
+/* C-API */
+
+void ks_memtrace_start() {
+    if (_ks_memtrace_active) return;
+    clear_all();
+    _ks_memtrace_active = true;
+}
+
+void ks_memtrace_stop() {
+    if (!_ks_memtrace_active) return;
+    _ks_memtrace_active = false;
+    clear_all();
+}
+
+bool ks_memtrace_is_active() {
+    return _ks_memtrace_active;
+}
+
+void ks_memtrace_usage(ks_size_t* cur, ks_size_t* peak, ks_size_t* allocs) {
+    *cur = cur_bytes;
+    *peak = peak_bytes;
+    *allocs = n_allocs;
+}
+
+ks_dict ks_memtrace_sites() {
+    /* Don't trace our own allocations, but still process frees */
+    is_paused = true;
+
+    ks_dict res = ks_dict_new(NULL);
+
+    int i;
+    for (i = 0; i < n_sites; ++i) {
+        struct site* s = &sites[i];
+        if (s->count == 0) continue;
+        ks_tuple key = ks_tuple_newn(3, (kso[]){
+            s->tp ? KS_NEWREF(s->tp->i__fullname) : (kso)ks_str_new(-1, "<raw>"),
+            s->fname ? KS_NEWREF(s->fname) : KSO_NONE,
+            (kso)ks_int_new(s->line),
+        });
+        ks_tuple val = ks_tuple_newn(2, (kso[]){
+            (kso)ks_int_new(s->count),
+            (kso)ks_int_new(s->bytes),
+        });
+
+        /* Sites with the same key (i.e. files which were loaded twice) are merged */
+        ks_hash_t hash = 0;
+        kso_hash((kso)key, &hash);
+        kso prev = ks_dict_get_ih(res, (kso)key, hash);
+        if (prev) {
+            ks_cint pc, pb;
+            kso_get_ci(((ks_tuple)prev)->elems[0], &pc);
+            kso_get_ci(((ks_tuple)prev)->elems[1], &pb);
+            KS_DECREF(prev);
+            KS_DECREF(val);
+            val = ks_tuple_newn(2, (kso[]){
+                (kso)ks_int_new(s->count + pc),
+                (kso)ks_int_new(s->bytes + pb),
+            });
+        }
+
+        ks_dict_set_h(res, (kso)key, hash, (kso)val);
+        KS_DECREF(key);
+        KS_DECREF(val);
+    }
+
+    is_paused = false;
+    return res;
+}
@@ -173,8 +173,12 @@ bool ksffi_unwrap(ks_type tp, kso obj, void* val) {
         } else if (kso_issub(obj->type, kst_str)) {
             *(void**)val = ((ks_str)obj)->data;
             return true;
-        } else if (kso_issub(obj->type, kst_bytes)) {
-            *(void**)val = ((ks_bytes)obj)->data;
+        } else if (obj->type->ob_buffer) {
+            /* Point to the memory of the buffer (which the caller keeps alive, by holding 'obj') */
+            struct ks_buffer buf;
+            if (!ks_buffer_get(obj, &buf, false)) return false;
+            *(void**)val = buf.data;
+            ks_buffer_release(&buf);
             return true;
         } else {
             ks_cint v;
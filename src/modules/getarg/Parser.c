@@ -188,7 +188,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                             s = (ks_str)ns;
                         }
                         bool has;
-                        if (!ks_dict_has_h(res, (kso)a.name, a.name->v_hash, &has)) {
+                        if (!ks_dict_has_h(res, (kso)a.name, KS_STR_HASH(a.name), &has)) {
                             assert(false);
                         }
                         if (has && (a.trans == KSO_NONE || kso_issub(a.trans->type, kst_type))) {
@@ -200,7 +200,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                             return NULL;
                         }
 
-                        ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)s);
+                        ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)s);
                         KS_DECREF(s);
                     }
                 }
@@ -232,7 +232,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
     for (j = 0; j < self->n_flag; ++j) {
         struct ksga_flag a = self->flag[j];
         ks_int v = ks_int_new(flag_ct[j]);
-        ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)v);
+        ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)v);
         KS_DECREF(v);
     }
 
@@ -243,13 +243,13 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
         struct ksga_opt a = self->opt[j];
 
         bool has;
-        if (!ks_dict_has_h(res, (kso)a.name, a.name->v_hash, &has)) {
+        if (!ks_dict_has_h(res, (kso)a.name, KS_STR_HASH(a.name), &has)) {
             assert(false);
         }
 
         if (!has) {
             if (a.defa) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, a.defa);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), a.defa);
             } else {
                 KS_THROW(kst_Error, "Required option %R (%R) was not given", a.name, a.opts);
                 KS_DECREF(res);
@@ -313,9 +313,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
 
             KS_DECREF(tmp);
@@ -362,9 +362,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
             KS_DECREF(tmp);
         }
@@ -392,7 +392,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                 }
             }
 
-            ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+            ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             KS_DECREF(tmp);
         }
 
@@ -420,9 +420,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
             KS_DECREF(tmp);
         }
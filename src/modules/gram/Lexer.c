@@ -11,6 +11,12 @@
 
 /* Constants/Definitions/Utilities */
 
+/* Size of chunks read from the source */
+#define CHUNK_SZ (64 * 1024)
+
+/* Whether a byte is in the middle of a UTF-8 character */
+#define IS_CONT(_c) (((_c) & 0xC0) == 0x80)
+
 /* C-API Interface */
 
 ksgram_Lexer ksgram_Lexer_new(kso src) {
@@ -19,19 +25,27 @@ ksgram_Lexer ksgram_Lexer_new(kso src) {
 
     self->rules = ks_list_new(0, NULL);
 
-    /* Begin with empty queue */
-    self->queue = NULL;
-    self->n_queue = 0;
-
     KS_INCREF(src);
     self->src = src;
 
+    if (kso_issub(src->type, kst_str)) {
+        /* Strings are all read at once */
+        ks_str s = (ks_str)src;
+        self->buf = ks_malloc(s->len_b + 1);
+        memcpy(self->buf, s->data, s->len_b);
+        self->len = self->max_len = s->len_b;
+        self->eof = true;
+    } else {
+        self->buf = NULL;
+        self->len = self->max_len = 0;
+        self->eof = false;
+    }
+    self->pos = 0;
+
     self->line = self->pos_b = self->pos_c = self->col = 0;
 
-    self->_sim.n_states = 0;
-    self->_sim.states = NULL;
-    self->_sim.cur = self->_sim.next = NULL;
-    self->_max_sim_len = 0;
+    self->_pat = NULL;
+    self->_ends = NULL;
 
     return self;
 }
@@ -40,9 +54,62 @@ bool ksgram_Lexer_addrule(ksgram_Lexer self, ks_regex regex, kso action) {
     ks_tuple rule = ks_tuple_new(2, (kso[]){ (kso)regex, (kso)action });
     ks_list_push(self->rules, (kso)rule);
     KS_DECREF(rule);
+
+    /* Rebuild the combined regex next time */
+    KS_NDECREF(self->_pat);
+    self->_pat = NULL;
+    return true;
 }
 
 
+/* Combine all the rules into a single regex */
+static void I_build(ksgram_Lexer self) {
+    ks_cint i, n = self->rules->len;
+    ks_regex* elems = ks_malloc(sizeof(*elems) * n);
+    for (i = 0; i < n; ++i) {
+        elems[i] = (ks_regex)((ks_tuple)self->rules->elems[i])->elems[0];
+    }
+
+    self->_ends = ks_realloc(self->_ends, sizeof(*self->_ends) * n);
+    self->_pat = ks_regex_union(n, elems, self->_ends);
+    ks_free(elems);
+}
+
+/* Read another chunk of input, after discarding what has been claimed */
+static bool I_fill(ksgram_Lexer self) {
+    if (self->pos > 0) {
+        memmove(self->buf, self->buf + self->pos, self->len - self->pos);
+        self->len -= self->pos;
+        self->pos = 0;
+    }
+
+    /* Read at least as much as is kept, so tokens longer than a chunk are still linear */
+    ks_size_t sz = self->len > CHUNK_SZ ? self->len : CHUNK_SZ;
+    if (self->len + sz > self->max_len) {
+        self->max_len = ks_nextsize(self->max_len, self->len + sz);
+        self->buf = ks_realloc(self->buf, self->max_len);
+    }
+
+    ks_ssize_t rsz = ksio_readb((ksio_BaseIO)self->src, sz, self->buf + self->len);
+    if (rsz < 0) return false;
+    if (rsz == 0) self->eof = true;
+    self->len += rsz;
+    return true;
+}
+
+/* Return the index of the rule whose final state is 'tag' */
+static ks_cint I_rule(ksgram_Lexer self, int tag) {
+    ks_cint lo = 0, hi = self->rules->len - 1;
+    while (lo < hi) {
+        ks_cint mid = (lo + hi) / 2;
+        if (self->_ends[mid] < tag) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
 
 /* Generate one token and return the object
  * If the lexer is out of input, it will return NULL and set '*is_out',
@@ -50,151 +117,100 @@ bool ksgram_Lexer_addrule(ksgram_Lexer self, ks_regex regex, kso action) {
  */
 static kso I_token(ksgram_Lexer self, bool* is_out) {
     while (true) {
-        /* Maximum match so far (rule index, byte length) */
-        int maxi = -1, maxl = 0;
         *is_out = false;
 
-        int i, j;
-        for (i = 0; i < self->rules->len; ++i) {
-            /* Get the rule we are simulating */
-            ks_regex rule = (ks_regex)((ks_tuple)self->rules->elems[i])->elems[0];
-
-            /* Empty the simulator */
-            if (rule->n_states > self->_max_sim_len) {
-                self->_max_sim_len = rule->n_states;
-                self->_sim.cur = ks_zrealloc(self->_sim.cur, sizeof(*self->_sim.cur), self->_max_sim_len);
-                self->_sim.next = ks_zrealloc(self->_sim.next, sizeof(*self->_sim.next), self->_max_sim_len);
-            }
-
-            self->_sim.n_states = rule->n_states;
-            self->_sim.states = rule->states;
-
-            for (j = 0; j < self->_sim.n_states; ++j) self->_sim.cur[j] = self->_sim.next[j] = false;
-
-            self->_sim.cur[rule->s0] = true;
-
-            /* Position from the start of self->queue */
-            int pos = 0;
-
-            bool src_out = false;
-            while (!src_out) {
-                char utf8[5];
-                ks_ucp c = 0;
-                if (pos >= self->n_queue) {
-                    assert (pos == self->n_queue);
-                    /* Out of the queue, so we need to read another character */
-                    ks_ssize_t numc = 0;
-                    ks_ssize_t rsz = ksio_reads(self->src, 1, utf8, &numc);
-                    if (rsz < 1 || numc < 1) {
-                        kso_catch_ignore();
-                        src_out = true;
-                        break;
-                    }
-                    int _n;
-                    KS_UCP_FROM_UTF8(c, utf8, _n);
-
-                    /* Reallocate queue buffer, if needed */
-                    self->n_queue += 1;
-                    if (self->n_queue > self->_max_n_queue) {
-                        self->_max_n_queue = ks_nextsize(self->_max_n_queue, self->n_queue);
-                        self->queue = ks_realloc(self->queue, self->_max_n_queue);
-                    }
-
-                    /* Append to queue */
-                    self->queue[pos] = c;
-                    pos++;
-
-                } else {
-                    /* Read from existing queue */
-                    c = self->queue[pos];
-                    pos++;
-                }
-
-
-                /* Update state variables */
-                /* TODO: add an 'onchar()' method to allow custom handling of newlines */
-                if (c == '\n') {
-                    self->line++;
-                    self->col = 0;
-                } else {
-                    self->col++;
-                }
-
-
-                /* Now, simulate the NFA */
-                if (ks_regex_sim0_step(&self->_sim, c) == 0) break;
-
-                /* Now, check if we have exceeded the maximum length */
-                if (pos > maxl) {
-                    /* If so, see if we are in a matching state  */
-                    if (self->_sim.cur[rule->sf]) {
-                        maxi = i;
-                        maxl = pos;
-                    }
-                }
-            }
-        }
-
-        /* Done with all the rules */
-        if (maxi < 0) {
-            /* No match was found */
-            if (self->n_queue == 0) {
+        if (self->pos == self->len) {
+            if (self->eof) {
                 /* Just out of input, but no error */
                 *is_out = true;
                 return NULL;
-            } else {
-                KS_THROW(kst_Error, "Unexpected character(s): '%.*s'", self->n_queue, self->queue);
-                return NULL;
             }
-        } else {
-            /* We've found a match, and we know which is the longest */
-
-            /* Construct a string from the match */
-            ks_str val = ks_str_new(maxl, self->queue);
+            if (!I_fill(self)) return NULL;
+            continue;
+        }
 
-            /* Shift the queue over and consume the tokens */
-            self->n_queue -= maxl;
-            for (i = 0; i < self->n_queue; ++i) {
-                self->queue[i] = self->queue[i + maxl];
+        /* Find the longest match of any rule, and which rule it was for */
+        ks_ssize_t len = -1;
+        int tag = -1;
+        if (self->rules->len > 0) {
+            if (!self->_pat) I_build(self);
+            len = ks_regex_longest(self->_pat, self->len - self->pos, self->buf + self->pos, self->pos_b == 0, self->eof, &tag);
+            if (len == -2) {
+                /* Need more input to tell */
+                if (!I_fill(self)) return NULL;
+                continue;
             }
+        }
+
+        if (len <= 0) {
+            /* No (non-empty) match was found */
+            const char* p = self->buf + self->pos;
+            int n = 1;
+            while (self->pos + n < self->len && IS_CONT(p[n])) n++;
+            KS_THROW(kst_Error, "Unexpected character(s): '%.*s'", n, p);
+            return NULL;
+        }
 
-            /* Determine the action for the rule that matched */
-            kso action = ((ks_tuple)self->rules->elems[maxi])->elems[1];
+        /* We've found a match, and we know which is the longest */
+        ks_cint maxi = I_rule(self, tag);
+
+        /* Construct a string from the match */
+        const char* p = self->buf + self->pos;
+        ks_str val = ks_str_new(len, p);
+
+        /* Update state variables */
+        /* TODO: add an 'onchar()' method to allow custom handling of newlines */
+        int sline = self->line, scol = self->col, spos_b = self->pos_b, spos_c = self->pos_c;
+        ks_ssize_t i;
+        for (i = 0; i < len; ++i) {
+            if (p[i] == '\n') {
+                self->line++;
+                self->col = 0;
+                self->pos_c++;
+            } else if (!IS_CONT(p[i])) {
+                self->col++;
+                self->pos_c++;
+            }
+        }
+        self->pos_b += len;
+        self->pos += len;
 
+        /* Determine the action for the rule that matched */
+        kso action = ((ks_tuple)self->rules->elems[maxi])->elems[1];
 
-            if (action == KSO_NONE) {
-                /* Skip the token */
-            } else if (kso_is_callable(action)) {
-                /* Call the action with the available match */
 
-                kso res = kso_call(action, 1, (kso[]){ (kso)val });
-                if (!res) {
-                    KS_DECREF(val);
-                    return NULL;
-                }
+        if (action == KSO_NONE) {
+            /* Skip the token */
+        } else if (kso_is_callable(action)) {
+            /* Call the action with the available match */
 
-                if (res == KSO_NONE) {
-                    KS_DECREF(res);
-                } else {
-                    KS_DECREF(val);
-                    return res;
-                }
-            } else {
-                /* Assume the action is a token type to return */
-                ksgram_Token res = ksgram_Token_new(ksgramt_Token, action, val, 0, 0, 0, 0, 0, 0, 0, 0);
+            kso res = kso_call(action, 1, (kso[]){ (kso)val });
+            if (!res) {
                 KS_DECREF(val);
-                return (kso)res;
+                return NULL;
+            }
 
-                /*
-                KS_THROW(kst_Error, "Expected either an integral value, or callable for a token action, but got '%T' object", action);
+            if (res == KSO_NONE) {
+                KS_DECREF(res);
+            } else {
                 KS_DECREF(val);
-                return NULL;
-                */
+                return res;
             }
+        } else {
+            /* Assume the action is a token type to return */
+            ksgram_Token res = ksgram_Token_new(ksgramt_Token, action, val, sline, scol, self->line, self->col, spos_b, spos_c, len, self->pos_c - spos_c);
+            KS_DECREF(val);
+            return (kso)res;
 
-            /* If it has gotten here, we need to just repeat because we've skipped the token */
+            /*
+            KS_THROW(kst_Error, "Expected either an integral value, or callable for a token action, but got '%T' object", action);
             KS_DECREF(val);
+            return NULL;
+            */
         }
+
+        /* If it has gotten here, we need to just repeat because we've skipped the token */
+        KS_DECREF(val);
     }
 
     assert(false);
@@ -265,7 +281,10 @@ static KS_TFUNC(T, free) {
     KS_ARGS("self:*", &self, ksgramt_Lexer);
 
     KS_DECREF(self->rules);
-    ks_free(self->queue);
+    KS_DECREF(self->src);
+    KS_NDECREF(self->_pat);
+    ks_free(self->_ends);
+    ks_free(self->buf);
 
     KSO_DEL(self);
 
@@ -48,7 +48,7 @@ bool ksio_close(ksio_BaseIO self) {
 
         return true;
     } else {
-        ks_str key = ks_str_new(-1, "close");
+        ks_str key = ks_str_intern_c(-1, "close");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -131,7 +131,7 @@ bool ksio_seek(ksio_BaseIO self, ks_cint pos, int whence) {
         KS_THROW(kst_IOError, "Failed to seek %R: String-based IOs cannot be seek'd; use byte-based IOs", self);
         return false;
     } else {
-        ks_str key = ks_str_new(-1, "seek");
+        ks_str key = ks_str_intern_c(-1, "seek");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -181,7 +181,7 @@ ks_cint ksio_tell(ksio_BaseIO self) {
         ksio_StringIO sio = (ksio_StringIO)self;
         return sio->pos_c;
     } else {
-        ks_str key = ks_str_new(-1, "tell");
+        ks_str key = ks_str_intern_c(-1, "tell");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -241,7 +241,7 @@ bool ksio_eof(ksio_BaseIO self, bool* out) {
         *out = sio->pos_b < sio->len_b;
         return true;
     } else {
-        ks_str key = ks_str_new(-1, "eof");
+        ks_str key = ks_str_intern_c(-1, "eof");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -290,6 +290,7 @@ bool ksio_trunc(ksio_BaseIO self, ks_cint sz) {
         return true;
     } else if (kso_issub(self->type, ksiot_BytesIO)) {
         ksio_BytesIO bio = (ksio_BytesIO)self;
+        ksio_BytesIO_own(bio);
 
         if (sz > bio->len_b) {
             if (sz > bio->max_len_b) {
@@ -320,7 +321,7 @@ bool ksio_trunc(ksio_BaseIO self, ks_cint sz) {
         }
         return true;
     } else {
-        ks_str key = ks_str_new(-1, "trunc");
+        ks_str key = ks_str_intern_c(-1, "trunc");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -351,7 +352,8 @@ ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data) {
         /* Update state variables */
         fio->sz_r += real_sz;
 
-        if (real_sz == 0 && sz_b != 0) {
+        /* Reading nothing at the end of the file is not an error */
+        if (real_sz == 0 && sz_b != 0 && ferror(fio->fp)) {
             KS_THROW_ERRNO(eno, "Failed to read from %R", self);
             return -1;
         }
@@ -395,9 +397,24 @@ ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data) {
 
         return rsz;
 
+    } else if (kso_issub(self->type, ksiot_StringIO)) {
+        ksio_StringIO sio = (ksio_StringIO)self;
+
+        /* Number of bytes to read (which may end in the middle of a character) */
+        ks_ssize_t rsz = sio->len_b - sio->pos_b, i;
+        if (rsz > sz_b) rsz = sz_b;
+
+        memcpy(data, sio->data + sio->pos_b, rsz);
+        for (i = 0; i < rsz; ++i) {
+            if ((((unsigned char*)data)[i] & 0xC0) != 0x80) sio->pos_c++;
+        }
+        sio->pos_b += rsz;
+
+        return rsz;
+
 
     } else {
-        ks_str key = ks_str_new(-1, "read");
+        ks_str key = ks_str_intern_c(-1, "read");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -413,6 +430,11 @@ ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data) {
             KS_THROW(kst_TypeError, "'%T.read()' returned non-bytes object of type '%T'", bio);
             KS_DECREF(bio);
             return -1;
+        } else if (bio->len_b > sz_b) {
+            /* Callers only have room for 'sz_b' bytes */
+            KS_THROW(kst_IOError, "'%T.read()' returned %l bytes, but only %l were requested", self, (ks_cint)bio->len_b, (ks_cint)sz_b);
+            KS_DECREF(bio);
+            return -1;
         }
 
         ks_ssize_t real_sz = bio->len_b;
@@ -426,6 +448,18 @@ ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data) {
     return -1;
 }
 
+ks_ssize_t ksio_readinto(ksio_BaseIO self, ks_bytearray buf) {
+    /* Hold the buffer while reading, so the array can't be resized (and moved) by another thread while the GIL
+     *   is released
+     */
+    struct ks_buffer b;
+    if (!ks_buffer_get((kso)buf, &b, true)) return -1;
+
+    ks_ssize_t res = ksio_readb(self, b.len_b, b.data);
+    ks_buffer_release(&b);
+    return res;
+}
+
 ks_ssize_t ksio_reads(ksio_BaseIO self, ks_ssize_t sz_c, void* data, ks_ssize_t* num_c) {
     if (kso_issub(self->type, ksiot_FileIO)) {
         ksio_FileIO fio = (ksio_FileIO)self;
@@ -519,7 +553,7 @@ ks_ssize_t ksio_reads(ksio_BaseIO self, ks_ssize_t sz_c, void* data, ks_ssize_t*
 
         return sz_b;
     } else {
-        ks_str key = ks_str_new(-1, "read");
+        ks_str key = ks_str_intern_c(-1, "read");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return -1;
@@ -577,15 +611,16 @@ bool ksio_writeb(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
         KS_GIL_LOCK();
         if (real_sz < 0) {
             KS_THROW_ERRNO(eno, "Failed to write to %R", self);
-            return -1;
+            return false;
         }
 
         /* Update state variables */
-        rio->sz_r += real_sz;
+        rio->sz_w += real_sz;
 
-        return real_sz;
+        return true;
     } else if (kso_issub(self->type, ksiot_BytesIO) || kso_issub(self->type, ksiot_StringIO)) {
         ksio_StringIO sio = (ksio_StringIO)self;
+        ksio_BytesIO_own(sio);
 
         /* We always write to the end */
         if (sio->len_b + sz_b >= sio->max_len_b) {
@@ -604,7 +639,7 @@ bool ksio_writeb(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
 
         return true;
     } else {
-        ks_str key = ks_str_new(-1, "write");
+        ks_str key = ks_str_intern_c(-1, "write");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return false;
@@ -661,6 +696,7 @@ bool ksio_writes(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
         return real_sz;
     } else if (kso_issub(self->type, ksiot_BytesIO) || kso_issub(self->type, ksiot_StringIO)) {
         ksio_StringIO sio = (ksio_StringIO)self;
+        ksio_BytesIO_own(sio);
 
         /* We always write to the end */
         if (sio->len_b + sz_b >= sio->max_len_b) {
@@ -679,7 +715,7 @@ bool ksio_writes(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
 
         return sz_b;
     } else {
-        ks_str key = ks_str_new(-1, "write");
+        ks_str key = ks_str_intern_c(-1, "write");
         kso rf = kso_getattr(self, key);
         KS_DECREF(key);
         if (!rf) return false;
@@ -743,6 +779,17 @@ static KS_TFUNC(T, read) {
     return NULL;
 }
 
+static KS_TFUNC(T, readinto) {
+    ksio_BaseIO self;
+    ks_bytearray buf;
+    KS_ARGS("self:* buf:*", &self, ksiot_BaseIO, &buf, kst_bytearray);
+
+    ks_ssize_t res = ksio_readinto(self, buf);
+    if (res < 0) return NULL;
+
+    return (kso)ks_int_new(res);
+}
+
 static KS_TFUNC(T, write) {
     ksio_BaseIO self;
     kso msg;
@@ -803,7 +850,7 @@ static KS_TFUNC(T, printf) {
     kso* args;
     KS_ARGS("self:* fmt:* *args", &self, ksiot_BaseIO, &fmt, kst_str, &nargs, &args);
 
-    if (!ks_fmt2(self, fmt->data, nargs, args)) {
+    if (!ks_fmt2s(self, fmt, nargs, args)) {
         return NULL;
     }
 
@@ -845,74 +892,114 @@ static KS_TFUNC(TI, init) {
     return KSO_NONE;
 }
 
-static KS_TFUNC(TI, next) {
-    _iter self;
-    KS_ARGS("self:*", &self, ksiot_BaseIO_iter);
+/* Make a line from 'sz' bytes of 'data', which may end in a line break (which is removed) */
+static kso I_line(bool is_b, ks_ssize_t sz, const char* data) {
+    if (sz > 0 && data[sz - 1] == '\n') {
+        sz--;
+        if (sz > 0 && data[sz - 1] == '\r') sz--;
+    }
+    return is_b ? (kso)ks_bytes_new(sz, data) : (kso)ks_str_new(sz, data);
+}
+
+static bool TI_next(kso ob, kso* res) {
+    _iter self = (_iter)ob;
+    *res = NULL;
 
     bool is_r, is_w, is_b;
     if (!ksio_info(self->of, &is_r, &is_w, &is_b)) {
-        return NULL;
-    }
-
-    /*
-    bool g;
-    if (!ksio_is_open(self->of, &g)) return NULL;
-    if (!g) {
-        KS_OUTOFITER();
-        return NULL;
+        return false;
     }
-    */
 
+    if (self->of->type == ksiot_StringIO || self->of->type == ksiot_BytesIO) {
+        /* The data is in memory, so search for the end of the line directly */
+        ksio_StringIO sio = (ksio_StringIO)self->of;
+        if (sio->pos_b >= sio->len_b) return true;
 
+        const char* st = (const char*)sio->data + sio->pos_b;
+        const char* nl = memchr(st, '\n', sio->len_b - sio->pos_b);
+        ks_ssize_t sz = nl ? nl - st + 1 : sio->len_b - sio->pos_b;
 
-    char* data = NULL;
-    ks_ssize_t num_c, rsz = 0;
+        *res = I_line(is_b, sz, st);
+        if (!*res) return false;
 
-    while (true) {
-        data = ks_realloc(data, rsz + 4);
-        ks_ssize_t csz = 0;
+        sio->pos_b += sz;
+        sio->sz_r += sz;
         if (is_b) {
-            csz = ksio_readb(self->of, 1, data + rsz);
+            sio->pos_c = sio->pos_b;
         } else {
-            csz = ksio_reads(self->of, 1, data + rsz, &num_c);
+            /* Line breaks are a single character per byte */
+            sio->pos_c += ((ks_str)*res)->len_c + sz - ((ks_str)*res)->len_b;
         }
+        return true;
+    }
 
-        rsz += csz;
-        if (csz < 0) {
-            ks_free(data);
-            return NULL;
-        } else if (csz == 0) {
-            if (rsz == 0) {
-                ks_free(data);
-                KS_OUTOFITER();
-                return NULL;
-            }
+    char* data = NULL;
+    ks_ssize_t rsz = 0, max_rsz = 0;
 
-            kso res = NULL;
-            if (is_b) {
-                res = (kso)ks_bytes_new(rsz, data);
-            } else {
-                res = (kso)ks_str_new(rsz, data);
+    if (kso_issub(self->of->type, ksiot_FileIO)) {
+        /* Read bytes until the line break (which is never part of a multi-byte UTF-8 sequence, so this works in
+         *   text mode too) */
+        ksio_FileIO fio = (ksio_FileIO)self->of;
+
+        /* 'ks_*' allocations must be made with the GIL held, so the line is read into plain memory */
+        KS_GIL_UNLOCK();
+        int c;
+        bool oom = false;
+        while ((c = fgetc(fio->fp)) != EOF) {
+            if (rsz >= max_rsz) {
+                max_rsz = ks_nextsize(max_rsz, rsz + 80);
+                char* ndata = realloc(data, max_rsz);
+                if (!ndata) {
+                    oom = true;
+                    break;
+                }
+                data = ndata;
             }
-            ks_free(data);
-            return (kso)res;
-        } else if (data[rsz - csz] == '\n') {
-            rsz--;
-            if (rsz > 0 && data[rsz - 1] == '\r') {
-                rsz--;
+            data[rsz++] = c;
+            if (c == '\n') break;
+        }
+        KS_GIL_LOCK();
+        if (oom) {
+            KS_CRASH("Failed to allocate memory");
+        }
+
+        fio->sz_r += rsz;
+        if (rsz > 0) *res = I_line(is_b, rsz, data);
+        free(data);
+        return rsz == 0 || *res != NULL;
+    } else {
+        /* Read one character at a time */
+        while (true) {
+            if (rsz + 4 > max_rsz) {
+                max_rsz = ks_nextsize(max_rsz, rsz + 80);
+                data = ks_realloc(data, max_rsz);
             }
-            kso res = NULL;
+            ks_ssize_t csz = 0, num_c;
             if (is_b) {
-                res = (kso)ks_bytes_new(rsz, data);
+                csz = ksio_readb(self->of, 1, data + rsz);
             } else {
-                res = (kso)ks_str_new(rsz, data);
+                csz = ksio_reads(self->of, 1, data + rsz, &num_c);
             }
-            ks_free(data);
-            return (kso)res;
+            if (csz < 0) {
+                ks_free(data);
+                return false;
+            }
+
+            rsz += csz;
+            if (csz == 0 || data[rsz - csz] == '\n') break;
         }
     }
-    assert(false);
-    return NULL;
+
+    if (rsz > 0) *res = I_line(is_b, rsz, data);
+    ks_free(data);
+    return rsz == 0 || *res != NULL;
+}
+
+static KS_TFUNC(TI, next) {
+    _iter self;
+    KS_ARGS("self:*", &self, ksiot_BaseIO_iter);
+
+    return kso_next_f(TI_next, (kso)self);
 }
 
 
@@ -929,6 +1016,7 @@ void _ksi_io_BaseIO() {
         {"__init",                 ksf_wrap(TI_init_, TI_NAME ".__init(self, of)", "")},
         {"__next",                 ksf_wrap(TI_next_, TI_NAME ".__next(self)", "")},
     ));
+    ksiot_BaseIO_iter->ob_next = TI_next;
 
     _ksinit(ksiot_BaseIO, kst_object, T_NAME, sizeof(struct kso_s), -1, "Abstract base type of other IO objects", KS_IKV(
         {"__bool",                 ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
@@ -941,6 +1029,7 @@ void _ksi_io_BaseIO() {
         {"eof",                    ksf_wrap(T_eof_, T_NAME ".eof(self)", "Calculate whether the stream has hit the EOF indicator")},
 
         {"read",                   ksf_wrap(T_read_, T_NAME ".read(self, sz=-1)", "Reads a message from the stream")},
+        {"readinto",               ksf_wrap(T_readinto_, T_NAME ".readinto(self, buf)", "Reads up to 'len(buf)' bytes from the stream directly into 'buf' (a 'bytearray', or a view of one), and returns how many were read (0 at the end of the stream)")},
         {"write",                  ksf_wrap(T_write_, T_NAME ".write(self, msg)", "Writes a messate to the stream")},
 
 
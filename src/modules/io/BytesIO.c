@@ -20,6 +20,7 @@ ksio_BytesIO ksio_BytesIO_new() {
     self->sz_r = self->sz_w = false;
 
     self->data = NULL;
+    self->exp = NULL;
 
     return self;
 }
@@ -29,7 +30,10 @@ ks_bytes ksio_BytesIO_get(ksio_BytesIO self) {
 }
 ks_bytes ksio_BytesIO_getf(ksio_BytesIO self) {
     ks_bytes res = NULL;
-    if (self->refs == 1) {
+    if (self->exp && self->exp->len_b == self->len_b) {
+        /* The exported bytes are still the whole contents */
+        res = (ks_bytes)KS_NEWREF(self->exp);
+    } else if (self->refs == 1 && !self->exp) {
         /* optimization: own the data, since we are about to free it */
         res = ks_bytes_newn(self->len_b, self->data);
         self->data = NULL;
@@ -41,6 +45,40 @@ ks_bytes ksio_BytesIO_getf(ksio_BytesIO self) {
     return res;
 }
 
+void ksio_BytesIO_own(ksio_BytesIO self) {
+    if (!self->exp) return;
+
+    /* Copy the data, and leave the original to the exported 'bytes' */
+    unsigned char* data = ks_malloc(self->max_len_b > 0 ? self->max_len_b : 1);
+    memcpy(data, self->data, self->len_b);
+    self->data = data;
+
+    KS_DECREF(self->exp);
+    self->exp = NULL;
+}
+
+
+/* Internals */
+
+/* Export the buffer of a 'io.BytesIO' (see 'ks_type->ob_buffer'), which is its contents
+ *
+ * The data is given to a 'bytes' object (without copying it), which is shared until the next time the 'io.BytesIO'
+ *   is modified (see 'ksio_BytesIO_own()')
+ */
+static bool export_buf(kso ob, struct ks_buffer* buf) {
+    ksio_BytesIO self = (ksio_BytesIO)ob;
+    if (!self->exp) {
+        if (self->len_b == 0) {
+            ks_buffer_bytes(buf, ob, 0, self->data, true);
+            return true;
+        }
+        self->exp = ks_bytes_newn(self->len_b, (char*)self->data);
+    }
+
+    ks_buffer_bytes(buf, (kso)self->exp, self->exp->len_b, self->exp->data, true);
+    return true;
+}
+
 
 /* Type Functions */
 
@@ -48,7 +86,11 @@ static KS_TFUNC(T, free) {
     ksio_BytesIO self;
     KS_ARGS("self:*", &self, ksiot_BytesIO);
 
-    ks_free(self->data);
+    if (self->exp) {
+        KS_DECREF(self->exp);
+    } else {
+        ks_free(self->data);
+    }
     KSO_DEL(self);
 
     return KSO_NONE;
@@ -66,6 +108,30 @@ static KS_TFUNC(T, get) {
     return (kso)ksio_BytesIO_get(self);
 }
 
+static KS_TFUNC(T, write) {
+    ksio_BytesIO self;
+    kso msg;
+    KS_ARGS("self:* msg", &self, ksiot_BytesIO, &msg);
+
+    /* Write from the buffer directly, without copying */
+    if (msg->type->ob_buffer) {
+        struct ks_buffer buf;
+        if (!ks_buffer_get(msg, &buf, false)) return NULL;
+        if (ks_buffer_contig(&buf)) {
+            bool res = ksio_writeb((ksio_BaseIO)self, buf.len_b, buf.data);
+            ks_buffer_release(&buf);
+            return res ? KSO_NONE : NULL;
+        }
+        ks_buffer_release(&buf);
+    }
+
+    ks_bytes vm = kso_bytes(msg);
+    if (!vm) return NULL;
+    bool res = ksio_writeb((ksio_BaseIO)self, vm->len_b, vm->data);
+    KS_DECREF(vm);
+    return res ? KSO_NONE : NULL;
+}
+
 
 /* Export */
 
@@ -78,7 +144,10 @@ void _ksi_io_BytesIO() {
 
         {"__bytes",              ksf_wrap(T_bytes_, T_NAME ".__bytes(self)", "")},
         {"get",                  ksf_wrap(T_get_, T_NAME ".get(self)", "Gets the current bytes being built")},
+        {"write",                ksf_wrap(T_write_, T_NAME ".write(self, msg)", "Writes 'msg' (a 'bytes', or any object with a buffer) to the end")},
 
 
     ));
+
+    ksiot_BytesIO->ob_buffer = export_buf;
 }
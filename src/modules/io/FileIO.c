@@ -138,6 +138,8 @@ static KS_TFUNC(T, read) {
         ks_ssize_t bsz = KSIO_BUFSIZ, rsz = 0;
         void* dest = NULL;
         while (rsz < sz) {
+            /* Don't read past 'sz' */
+            if (bsz > sz - rsz) bsz = sz - rsz;
             dest = ks_realloc(dest, rsz + bsz);
             ks_ssize_t csz = ksio_readb((ksio_BaseIO)self, bsz, ((char*)dest) + rsz);
             if (csz < 0) {
@@ -177,10 +179,20 @@ static KS_TFUNC(T, write) {
     kso msg;
     KS_ARGS("self:* msg", &self, ksiot_FileIO, &msg);
     if (self->mb) {
-        /* Write bytes */
+        /* Write bytes (from the buffer of 'msg' directly, without copying) */
+        if (msg->type->ob_buffer) {
+            struct ks_buffer buf;
+            if (!ks_buffer_get(msg, &buf, false)) return NULL;
+            if (ks_buffer_contig(&buf)) {
+                bool res = ksio_writeb((ksio_BaseIO)self, buf.len_b, buf.data);
+                ks_buffer_release(&buf);
+                return res ? KSO_NONE : NULL;
+            }
+            ks_buffer_release(&buf);
+        }
         ks_bytes vm = kso_bytes(msg);
         if (!vm) return NULL;
-        if (ksio_writeb((ksio_BaseIO)self, vm->len_b, vm->data) < 0) {
+        if (!ksio_writeb((ksio_BaseIO)self, vm->len_b, vm->data)) {
             KS_DECREF(vm);
             return NULL;
         }
@@ -6,6 +6,38 @@
 #include <ks/impl.h>
 
 #define T_NAME "io.StringIO"
+#define TB_NAME "str.builder"
+
+
+/* Internals */
+
+/* Append a string to the end (which is where a builder always writes) */
+static void sio_adds(ksio_StringIO self, ks_str s) {
+    if (self->len_b + s->len_b >= self->max_len_b) {
+        self->max_len_b = ks_nextsize(self->max_len_b, self->len_b + s->len_b + 1);
+        self->data = ks_realloc(self->data, self->max_len_b);
+    }
+    memcpy(self->data + self->len_b, s->data, s->len_b);
+
+    self->len_b += s->len_b;
+    self->len_c += s->len_c;
+    self->pos_b = self->len_b;
+    self->pos_c = self->len_c;
+}
+
+/* Append 'str(ob)' to the end */
+static bool sio_add(ksio_StringIO self, kso ob) {
+    if (kso_issub(ob->type, kst_str)) {
+        sio_adds(self, (ks_str)ob);
+        return true;
+    }
+
+    ks_str s = ks_fmt("%S", ob);
+    if (!s) return false;
+    sio_adds(self, s);
+    KS_DECREF(s);
+    return true;
+}
 
 
 /* C-API */
@@ -81,11 +113,72 @@ static KS_TFUNC(T, get) {
 
 
 
+/** Builder **/
+
+static KS_TFUNC(TB, init) {
+    ksio_StringBuilder self;
+    int nargs;
+    kso* args;
+    KS_ARGS("self:* *args", &self, ksiot_StringBuilder, &nargs, &args);
+
+    self->len_b = self->len_c = 0;
+    self->pos_b = self->pos_c = 0;
+
+    int i;
+    for (i = 0; i < nargs; ++i) {
+        if (!sio_add(self, args[i])) return NULL;
+    }
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TB, str) {
+    ksio_StringBuilder self;
+    KS_ARGS("self:*", &self, ksiot_StringBuilder);
+
+    return (kso)ksio_StringIO_get(self);
+}
+
+static KS_TFUNC(TB, len) {
+    ksio_StringBuilder self;
+    KS_ARGS("self:*", &self, ksiot_StringBuilder);
+
+    return (kso)ks_int_new(self->len_c);
+}
+
+static KS_TFUNC(TB, add) {
+    ksio_StringBuilder self;
+    int nargs;
+    kso* args;
+    KS_ARGS("self:* *args", &self, ksiot_StringBuilder, &nargs, &args);
+
+    int i;
+    for (i = 0; i < nargs; ++i) {
+        if (!sio_add(self, args[i])) return NULL;
+    }
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TB, clear) {
+    ksio_StringBuilder self;
+    KS_ARGS("self:*", &self, ksiot_StringBuilder);
+
+    self->len_b = self->len_c = 0;
+    self->pos_b = self->pos_c = 0;
+
+    return KSO_NONE;
+}
+
+
 /* Export */
 
 static struct ks_type_s tp;
 ks_type ksiot_StringIO = &tp;
 
+static struct ks_type_s tp_builder;
+ks_type ksiot_StringBuilder = &tp_builder;
+
 void _ksi_io_StringIO() {
     _ksinit(ksiot_StringIO, ksiot_BaseIO, T_NAME, sizeof(struct ksio_StringIO_s), -1, "In-memory string-based input/output which can append and build strings", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
@@ -94,4 +187,15 @@ void _ksi_io_StringIO() {
         {"get",                  ksf_wrap(T_get_, T_NAME ".get(self)", "Gets the current string being built")},
 
     ));
+
+    _ksinit(ksiot_StringBuilder, ksiot_StringIO, TB_NAME, sizeof(struct ksio_StringIO_s), -1, "Builds a string by appending to it, which is amortized O(1) per append (unlike 's = s + x', which may copy 's')\n\n    The result is created (with a single copy) by 'str(self)'", KS_IKV(
+        {"__init",               ksf_wrap(TB_init_, TB_NAME ".__init(self, *args)", "")},
+        {"__str",                ksf_wrap(TB_str_, TB_NAME ".__str(self)", "")},
+        {"__len",                ksf_wrap(TB_len_, TB_NAME ".__len(self)", "")},
+
+        {"add",                  ksf_wrap(TB_add_, TB_NAME ".add(self, *args)", "Appends 'str(x)' for each argument")},
+        {"clear",                ksf_wrap(TB_clear_, TB_NAME ".clear(self)", "Removes everything, keeping the allocated space")},
+    ));
+
+    ks_type_set_c(kst_str, "builder", (kso)ksiot_StringBuilder);
 }
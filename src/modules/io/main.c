@@ -55,6 +55,7 @@ ks_module _ksi_io() {
         {"RawIO",                  KS_NEWREF(ksiot_RawIO)},
         {"FileIO",                 KS_NEWREF(ksiot_FileIO)},
         {"StringIO",               KS_NEWREF(ksiot_StringIO)},
+        {"StringBuilder",          KS_NEWREF(ksiot_StringBuilder)},
         {"BytesIO",                KS_NEWREF(ksiot_BytesIO)},
 
         /* Functions */
@@ -65,6 +65,28 @@ static bool add_str(ksio_BaseIO self, kso obj);
 static bool add_repr(ksio_BaseIO self, kso obj);
 
 
+/* Write the digits of 'val' (in lower case) to 'tmp', which must have room for 'sizeof(long) * 8 + 2' bytes, and
+ *   return the number of bytes written
+ */
+static int add_long_digits(char* tmp, long val, int base) {
+    unsigned long uv = val < 0 ? -(unsigned long)val : (unsigned long)val;
+    int i = 0, j, k;
+    if (val < 0) tmp[i++] = '-';
+    j = i;
+    do {
+        tmp[i++] = "0123456789abcdefghijklmnopqrstuvwxyz"[uv % base];
+        uv /= base;
+    } while (uv > 0);
+
+    /* Reverse digits */
+    for (k = i - 1; j < k; j++, k--) {
+        char t = tmp[j];
+        tmp[j] = tmp[k];
+        tmp[k] = t;
+    }
+    return i;
+}
+
 /* Base method to add a C-style integer to the output */
 static bool add_int(ksio_BaseIO self, ks_cint val, int base, struct sbfield sbf) {
 
@@ -178,6 +200,12 @@ static bool add_O(ksio_BaseIO self, kso obj) {
 
 /* Add integer type */
 static bool add_O_int(ksio_BaseIO self, ks_int val) {
+    if (mpz_fits_slong_p(val->val)) {
+        /* Convert on the stack */
+        char tmp[72];
+        return ksio_addbuf(self, add_long_digits(tmp, mpz_get_si(val->val), 10), tmp);
+    }
+
     int base = 10;
     ks_size_t mlb = 16 + mpz_sizeinbase(val->val, base);
     char* buf = ks_malloc(mlb);
@@ -199,8 +227,21 @@ static bool add_O_int(ksio_BaseIO self, ks_int val) {
 }
 
 
-/* Add integer type */
+/* Add float type (the same as 'str(float)') */
+static bool add_O_float(ksio_BaseIO self, ks_float val) {
+    char tmp[256];
+    int sz = ks_cfloat_str(tmp, sizeof(tmp) - 1, val->val);
+    if (sz >= sizeof(tmp) - 1) {
+        char* atmp = ks_malloc(sz + 5);
+        sz = ks_cfloat_str(atmp, sz + 4, val->val);
+        bool res = ksio_addbuf(self, sz, atmp);
+        ks_free(atmp);
+        return res;
+    }
+    return ksio_addbuf(self, sz, tmp);
+}
 
+/* Add list type */
 static bool add_O_list(ksio_BaseIO self, ks_list val) {
     if (!ksio_addbuf(self, 1, "[")) return false;
 
@@ -265,15 +306,14 @@ static bool add_O_dict(ksio_BaseIO self, ks_dict val) {
     if (kso_inrepr((kso)val)) {
         ksio_addbuf(self, 3, "...");
     } else {
-        ks_size_t i, ct = 0;
-        for (i = 0; i < val->len_ents; ++i) {
-            if (val->ents[i].key) {
-                if (ct > 0) ksio_addbuf(self, 2, ", ");
-                if (!add_repr(self, val->ents[i].key)) return false;
-                ksio_addbuf(self, 2, ": ");
-                if (!add_repr(self, val->ents[i].val)) return false;
-                ct++;
-            }
+        ks_cint pos = 0, ct = 0;
+        kso k, v;
+        while (ks_dict_next(val, &pos, &k, &v)) {
+            if (ct > 0) ksio_addbuf(self, 2, ", ");
+            if (!add_repr(self, k)) return false;
+            ksio_addbuf(self, 2, ": ");
+            if (!add_repr(self, v)) return false;
+            ct++;
         }
         kso_outrepr();
     }
@@ -282,6 +322,37 @@ static bool add_O_dict(ksio_BaseIO self, ks_dict val) {
     return true;
 }
 
+/* Add a view of a dictionary, like 'dict.__keys([...])', without copying it */
+static bool add_O_dict_view(ksio_BaseIO self, ks_dict_view val) {
+    if (!add_str(self, (kso)val->type->i__fullname)) return false;
+    if (!ksio_addbuf(self, 2, "([")) return false;
+    if (kso_inrepr((kso)val->of)) {
+        ksio_addbuf(self, 3, "...");
+    } else {
+        ks_cint pos = 0, ct = 0;
+        kso k, v;
+        while (ks_dict_next(val->of, &pos, &k, &v)) {
+            if (ct > 0) ksio_addbuf(self, 2, ", ");
+            if (val->type == kst_dict_keys) {
+                if (!add_repr(self, k)) return false;
+            } else if (val->type == kst_dict_values) {
+                if (!add_repr(self, v)) return false;
+            } else {
+                ksio_addbuf(self, 1, "(");
+                if (!add_repr(self, k)) return false;
+                ksio_addbuf(self, 2, ", ");
+                if (!add_repr(self, v)) return false;
+                ksio_addbuf(self, 1, ")");
+            }
+            ct++;
+        }
+        kso_outrepr();
+    }
+
+    if (!ksio_addbuf(self, 2, "])")) return false;
+    return true;
+}
+
 static bool add_O_path(ksio_BaseIO self, ksos_path val) {
     if (val->str_ != NULL) {
         return add_str(self, (kso)val->str_);
@@ -355,8 +426,8 @@ static bool add_str(ksio_BaseIO self, kso obj) {
         return true;
     } else if (kso_isinst(obj, kst_int) && obj->type->i__str == kst_int->i__str) {
         return add_O_int(self, (ks_int)obj);
-    /*} else if (kso_isinst(obj, kst_float) && obj->type->i__str == kst_float->i__str) {
-        return add_float(self, ((ks_float)obj)->val, 10, SBFIELD_DEFAULT);*/
+    } else if (kso_isinst(obj, kst_float) && obj->type->i__str == kst_float->i__str) {
+        return add_O_float(self, (ks_float)obj);
     } else if (kso_isinst(obj, kst_list) && obj->type->i__str == kst_list->i__str) {
         return add_O_list(self, (ks_list)obj);
     } else if (kso_isinst(obj, kst_tuple) && obj->type->i__str == kst_tuple->i__str) {
@@ -365,6 +436,8 @@ static bool add_str(ksio_BaseIO self, kso obj) {
         return add_O_set(self, (ks_set)obj);
     } else if (kso_isinst(obj, kst_dict) && obj->type->i__str == kst_dict->i__str) {
         return add_O_dict(self, (ks_dict)obj);
+    } else if (obj->type == kst_dict_keys || obj->type == kst_dict_values || obj->type == kst_dict_items) {
+        return add_O_dict_view(self, (ks_dict_view)obj);
 
     } else if (kso_isinst(obj, ksost_path) && obj->type->i__str == ksost_path->i__str) {
         return add_O_path(self, (ksos_path)obj);
@@ -446,8 +519,8 @@ static bool add_repr(ksio_BaseIO self, kso obj) {
         return true;
     } else if (kso_isinst(obj, kst_int) && obj->type->i__repr == kst_int->i__repr) {
         return add_O_int(self, (ks_int)obj);
-    /*} else if (kso_isinst(obj, kst_float) && obj->type->i__str == kst_float->i__str) {
-        return add_float(self, ((ks_float)obj)->val, 10, SBFIELD_DEFAULT);*/
+    } else if (kso_isinst(obj, kst_float) && obj->type->i__repr == kst_float->i__repr) {
+        return add_O_float(self, (ks_float)obj);
     } else if (kso_isinst(obj, kst_list) && obj->type->i__str == kst_list->i__str) {
         return add_O_list(self, (ks_list)obj);
     } else if (kso_isinst(obj, kst_tuple) && obj->type->i__str == kst_tuple->i__str) {
@@ -456,6 +529,8 @@ static bool add_repr(ksio_BaseIO self, kso obj) {
         return add_O_set(self, (ks_set)obj);
     } else if (kso_isinst(obj, kst_dict) && obj->type->i__str == kst_dict->i__str) {
         return add_O_dict(self, (ks_dict)obj);
+    } else if (obj->type == kst_dict_keys || obj->type == kst_dict_values || obj->type == kst_dict_items) {
+        return add_O_dict_view(self, (ks_dict_view)obj);
 
 
     } else if (obj->type->i__repr != kst_object->i__repr) {
@@ -654,429 +729,396 @@ bool ksio_fmtv(ksio_BaseIO self, const char* fmt, va_list ap) {
     return true;
 }
 
-bool ks_fmt2(ksio_BaseIO bio, const char* fmt, int nargs, kso* args) {
+/* Conversion in a compiled format template, which comes after a run of literal bytes */
+struct fmt_ins {
+
+    /* Offset and length (in bytes) of the literal run before the conversion */
+    int lit_off, lit_len;
+
+    /* Conversion specifier (i.e. 's', 'i', '%'), 0 if this is just the trailing literal run, or -1 if the format
+     *   string ended in the middle of a specifier
+     */
+    int c;
+
+    /* '+', '-', ' ', and '0' flags respectively */
+    bool fP, fM, fS, fZ;
+
+    /* Width and precision (-1==default,-2=='*' argument) */
+    int width, prec;
+
+};
+
+/* Compiled format template, for 'ks_fmt2()' and friends */
+struct fmt_tmpl {
+
+    /* Number of instructions */
+    int n;
 
-    int fmt_len = strlen(fmt);
-    int p = 0, l = 0;
-    int ai = 0;
-    kso a;
+    /* Array of instructions */
+    struct fmt_ins ins[];
+
+};
+
+/* Number of entries in the template cache (must be a power of two) */
+#define FMT_CACHE_N 64
+
+/* Cache of compiled templates, keyed by the format string. Entries hold a reference to the string, which is what
+ *   keeps the literal runs (which point into 'fmt->data') valid
+ * 
+ * Only used while the GIL is held
+ */
+static struct {
+    ks_str fmt;
+    struct fmt_tmpl* tmpl;
+} fmt_cache[FMT_CACHE_N];
+
+/* Runs of padding characters */
+static const char fmt_spaces[] = "                                ";
+static const char fmt_zeros[]  = "00000000000000000000000000000000";
+
+/* Decode 'fmt' into 'ins' (if non-NULL), and return the number of instructions
+ *
+ * Errors (such as unknown specifiers) are not reported here, since they depend on the arguments given, so they
+ *   are reported by 'fmt_run()' in the order they are reached
+ */
+static int fmt_decode(const char* fmt, int fmt_len, struct fmt_ins* ins) {
+    int p = 0, l, n = 0;
     while (p < fmt_len) {
+        struct fmt_ins it;
         l = p;
         while (p < fmt_len && fmt[p] != '%') {
             p++;
         }
-        ksio_addbuf(bio, p - l, fmt + l);
+        it.lit_off = l;
+        it.lit_len = p - l;
+        it.c = 0;
+        it.fP = it.fM = it.fS = it.fZ = false;
+        it.width = it.prec = -1;
 
-        if (fmt[p] == '%') {
+        if (p < fmt_len) {
             /* Parse printf-style formatting: 
              * %[+- 0]*<width>?(\.<prec>)?<spec>
              */
-            char c = fmt[++p];
-
-            /* '+', '-', ' ', and '0' flags respectively */
-            bool fP = false, fM = false, fS = false, fZ = false;
+            char c = ++p < fmt_len ? fmt[p] : 0;
             while (true) {
                 if (c == '+') {
-                    fP = true;
+                    it.fP = true;
                 } else if (c == '-') {
-                    fM = true;
+                    it.fM = true;
                 } else if (c == ' ') {
-                    fS = true;
+                    it.fS = true;
                 } else if (c == '0') {
-                    fZ = true;
+                    it.fZ = true;
                 } else break;
 
                 /* Advance character */
-                c = fmt[++p];
+                c = ++p < fmt_len ? fmt[p] : 0;
             }
 
-            /* Parse width and precision */
-            int width = -1, prec = -1;
-
             /* <width> */
             if (c == '*') {
-                if (ai >= nargs) {
-                    KS_THROW(kst_Error, "More format specifiers than arguments");
-                    return false;
-                }
-                ks_cint cv;
-                if (!kso_get_ci(args[ai++], &cv)) {
-                    return false;
-                }
-                width = cv;
-                c = fmt[++p];
+                it.width = -2;
+                c = ++p < fmt_len ? fmt[p] : 0;
             } else if (c >= '0' && c <= '9') {
-                width = 0;
+                it.width = 0;
                 while (c >= '0' && c <= '9') {
-                    width = 10 * width + (c - '0');
-                    c = fmt[++p];
+                    it.width = 10 * it.width + (c - '0');
+                    c = ++p < fmt_len ? fmt[p] : 0;
                 }
             }
 
             /* .<prec> */
             if (c == '.') {
-                c = fmt[++p];
+                c = ++p < fmt_len ? fmt[p] : 0;
                 if (c == '*') {
-                    if (ai >= nargs) {
-                        KS_THROW(kst_Error, "More format specifiers than arguments");
-                        return false;
-                    }
-
-                    ks_cint cv;
-                    if (!kso_get_ci(args[ai++], &cv)) {
-                        return false;
-                    }
-                    prec = cv;
-                    c = fmt[++p];
+                    it.prec = -2;
+                    c = ++p < fmt_len ? fmt[p] : 0;
                 } else if (c >= '0' && c <= '9') {
-                    prec = 0;
+                    it.prec = 0;
                     while (c >= '0' && c <= '9') {
-                        prec = 10 * prec + (c - '0');
-                        c = fmt[++p];
+                        it.prec = 10 * it.prec + (c - '0');
+                        c = ++p < fmt_len ? fmt[p] : 0;
                     }
                 }
             }
 
-            if (c == '%') {
-                /* literal '%' */
-                c = fmt[++p];
-                ksio_addbuf(bio, 1, "%");
-            } else {
-                /* Actually have arguments */
-                if (ai >= nargs) {
-                    KS_THROW(kst_Error, "More format specifiers than arguments");
-                    return false;
-                }
-                a = args[ai++];
-
-                if (c == 's' || c == 'S') {
-                    /* String conversion */
-                    if (!ksio_add(bio, "%S", a)) return false;
-                } else if (c == 'r' || c == 'R') {
-                    /* Repr conversion */
-                    if (!ksio_add(bio, "%R", a)) return false;
-                } else if (c == 't' || c == 'T') {
-                    /* Type conversion */
-                    if (!ksio_add(bio, "%T", a)) return false;
-                } else if (c == 'i' || c == 'I' || c == 'd' || c == 'D') {
-                    /* Integer conversion */
-                    ks_int ia = kso_int(a);
-                    if (!ia) {
-                        return false;
-                    }
-
-                    char* tmp = ks_malloc(mpz_sizeinbase(ia->val, 10) + 4);
-                    int base = 10;
-                    mpz_get_str(tmp, base, ia->val);
-                    int rsz = strlen(tmp), i;
-
-                    /* Calculate number of spaces needed */
-                    int nsp = 0;
-                    if (width >= 0) {
-                        nsp = width - rsz;
-                        if (nsp < 0) nsp = 0;
-                    }
-
-                    bool need_plus = fP && tmp[0] != '-';
-                    
-                    /* If '+' and actual sign is not given, then add it manually */
-                    if (need_plus) {
-                        nsp--;
-                        if (nsp < 0) nsp = 0;
-                    }
-
-                    if (!fM) {
-                        /* Right-justified */
-                        if (fZ && need_plus) ksio_addbuf(bio, 1, "+");
-
-                        /* Fill beforehand */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, fZ ? "0" : " ");
-                        }
-
-                        if (!fZ && need_plus) ksio_addbuf(bio, 1, "+");
-                    } else {
-                        if (need_plus) ksio_addbuf(bio, 1, "+");
-                    }
-                    
-                    //if (need_plus) 
-
-                    /* Add actual digits and seperator */
-                    ksio_addbuf(bio, rsz, tmp);
-
-                    if (fM) {
-                        /* Left justify, so spaces go after */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, " ");
-                        }
-                    }
+            /* Store the specifier, even if it is unknown (including the end of the string) */
+            it.c = c ? c : -1;
+            p++;
+        }
 
-                    ks_free(tmp);
-                    KS_DECREF(ia);
-                } else if (c == 'x' || c == 'X') {
-                    /* Integer conversion */
-                    ks_int ia = kso_int(a);
-                    if (!ia) {
-                        return false;
-                    }
+        if (ins) ins[n] = it;
+        n++;
+    }
 
-                    int base = 16;
-                    char* tmp = ks_malloc(mpz_sizeinbase(ia->val, base) + 4);
-                    mpz_get_str(tmp, base, ia->val);
-                    int rsz = strlen(tmp), i;
+    return n;
+}
 
-                    /* Calculate number of spaces needed */
-                    int nsp = 0;
-                    if (width >= 0) {
-                        nsp = width - rsz;
-                        if (nsp < 0) nsp = 0;
-                    }
+/* Compile 'fmt' into a new template, which should be freed with 'ks_free()' */
+static struct fmt_tmpl* fmt_compile(const char* fmt, int fmt_len) {
+    int n = fmt_decode(fmt, fmt_len, NULL);
+    struct fmt_tmpl* self = ks_malloc(sizeof(*self) + sizeof(*self->ins) * n);
+    self->n = fmt_decode(fmt, fmt_len, self->ins);
+    return self;
+}
 
-                    bool need_plus = fP && tmp[0] != '-';
-                    
-                    /* If '+' and actual sign is not given, then add it manually */
-                    if (need_plus) {
-                        nsp--;
-                        if (nsp < 0) nsp = 0;
-                    }
+/* Take the template for 'fmt' out of the cache (or compile it if it isn't there), which should be given back
+ *   with 'fmt_put()'
+ *
+ * Formatting may run user code (i.e. '__str'), which may format other strings that map to the same entry, so
+ *   the entry is emptied while it is in use instead of being shared
+ */
+static struct fmt_tmpl* fmt_take(ks_str fmt) {
+    int i = KS_STR_HASH(fmt) & (FMT_CACHE_N - 1);
+    if (fmt_cache[i].fmt && (fmt_cache[i].fmt == fmt || ks_str_eq(fmt_cache[i].fmt, fmt))) {
+        struct fmt_tmpl* res = fmt_cache[i].tmpl;
+        KS_DECREF(fmt_cache[i].fmt);
+        fmt_cache[i].fmt = NULL;
+        fmt_cache[i].tmpl = NULL;
+        return res;
+    }
 
-                    if (!fM) {
-                        /* Right-justified */
-                        if (fZ && need_plus) ksio_addbuf(bio, 1, "+");
+    return fmt_compile(fmt->data, fmt->len_b);
+}
 
-                        /* Fill beforehand */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, fZ ? "0" : " ");
-                        }
+/* Give back a template from 'fmt_take()', caching it (and replacing any old entry) */
+static void fmt_put(ks_str fmt, struct fmt_tmpl* tmpl) {
+    int i = KS_STR_HASH(fmt) & (FMT_CACHE_N - 1);
+    if (fmt_cache[i].fmt) {
+        KS_DECREF(fmt_cache[i].fmt);
+        ks_free(fmt_cache[i].tmpl);
+    }
 
-                        if (!fZ && need_plus) ksio_addbuf(bio, 1, "+");
-                    } else {
-                        if (need_plus) ksio_addbuf(bio, 1, "+");
-                    }
-                    
-                    /* Add actual digits and seperator */
-                    ksio_addbuf(bio, rsz, tmp);
-
-                    if (fM) {
-                        /* Left justify, so spaces go after */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, " ");
-                        }
-                    }
+    KS_INCREF(fmt);
+    fmt_cache[i].fmt = fmt;
+    fmt_cache[i].tmpl = tmpl;
+}
 
-                    ks_free(tmp);
-                    KS_DECREF(ia);
-                } else if (c == 'b' || c == 'B') {
-                    /* Integer conversion */
-                    ks_int ia = kso_int(a);
-                    if (!ia) {
-                        return false;
-                    }
-                    int base = 2;
-                    char* tmp = ks_malloc(mpz_sizeinbase(ia->val, base) + 4);
-                    mpz_get_str(tmp, base, ia->val);
-                    int rsz = strlen(tmp), i;
-
-                    /* Calculate number of spaces needed */
-                    int nsp = 0;
-                    if (width >= 0) {
-                        nsp = width - rsz;
-                        if (nsp < 0) nsp = 0;
-                    }
+/* Add 'n' padding characters */
+static bool fmt_fill(ksio_BaseIO bio, int n, bool zero) {
+    const char* src = zero ? fmt_zeros : fmt_spaces;
+    while (n > 0) {
+        int c = n < sizeof(fmt_spaces) - 1 ? n : sizeof(fmt_spaces) - 1;
+        if (!ksio_addbuf(bio, c, src)) return false;
+        n -= c;
+    }
+    return true;
+}
 
-                    bool need_plus = fP && tmp[0] != '-';
-                    
-                    /* If '+' and actual sign is not given, then add it manually */
-                    if (need_plus) {
-                        nsp--;
-                        if (nsp < 0) nsp = 0;
-                    }
+/* Add the digits 'tmp' of a number (followed by 'nza' zeros), padded according to 'it'
+ *
+ * Zeros are only used for padding if 'zok' is given
+ */
+static bool fmt_pad(ksio_BaseIO bio, struct fmt_ins* it, int width, const char* tmp, int rsz, int nza, bool zok) {
+    /* Calculate number of spaces needed */
+    int nsp = 0;
+    if (width >= 0) {
+        nsp = width - rsz - nza;
+        if (nsp < 0) nsp = 0;
+    }
 
-                    if (!fM) {
-                        /* Right-justified */
-                        if (fZ && need_plus) ksio_addbuf(bio, 1, "+");
+    bool need_plus = it->fP && tmp[0] != '-';
 
-                        /* Fill beforehand */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, fZ ? "0" : " ");
-                        }
+    /* If '+' and actual sign is not given, then add it manually */
+    if (need_plus) {
+        nsp--;
+        if (nsp < 0) nsp = 0;
+    }
 
-                        if (!fZ && need_plus) ksio_addbuf(bio, 1, "+");
-                    } else {
-                        if (need_plus) ksio_addbuf(bio, 1, "+");
-                    }
-                    
-                    /* Add actual digits and seperator */
-                    ksio_addbuf(bio, rsz, tmp);
-
-                    if (fM) {
-                        /* Left justify, so spaces go after */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, " ");
-                        }
-                    }
+    if (!it->fM) {
+        /* Right-justified */
+        if (it->fZ && need_plus) ksio_addbuf(bio, 1, "+");
 
-                    ks_free(tmp);
-                    KS_DECREF(ia);
-                } else if (c == 'o' || c == 'O') {
-                    /* Integer conversion */
-                    ks_int ia = kso_int(a);
-                    if (!ia) {
-                        return NULL;
-                    }
-                    int base = 8;
-                    char* tmp = ks_malloc(mpz_sizeinbase(ia->val, base) + 4);
+        /* Fill beforehand */
+        fmt_fill(bio, nsp, it->fZ && zok);
 
-                    mpz_get_str(tmp, base, ia->val);
-                    int rsz = strlen(tmp), i;
+        if (!it->fZ && need_plus) ksio_addbuf(bio, 1, "+");
+    } else {
+        if (need_plus) ksio_addbuf(bio, 1, "+");
+    }
 
-                    /* Calculate number of spaces needed */
-                    int nsp = 0;
-                    if (width >= 0) {
-                        nsp = width - rsz;
-                        if (nsp < 0) nsp = 0;
-                    }
+    /* Add actual digits and seperator */
+    ksio_addbuf(bio, rsz, tmp);
 
-                    bool need_plus = fP && tmp[0] != '-';
-                    
-                    /* If '+' and actual sign is not given, then add it manually */
-                    if (need_plus) {
-                        nsp--;
-                        if (nsp < 0) nsp = 0;
-                    }
+    /* Fill zeros after */
+    fmt_fill(bio, nza, true);
 
-                    if (!fM) {
-                        /* Right-justified */
-                        if (fZ && need_plus) ksio_addbuf(bio, 1, "+");
+    /* Left justify, so spaces go after */
+    if (it->fM) fmt_fill(bio, nsp, false);
 
-                        /* Fill beforehand */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, fZ ? "0" : " ");
-                        }
+    return true;
+}
 
-                        if (!fZ && need_plus) ksio_addbuf(bio, 1, "+");
-                    } else {
-                        if (need_plus) ksio_addbuf(bio, 1, "+");
-                    }
-                    
-                    /* Add actual digits and seperator */
-                    ksio_addbuf(bio, rsz, tmp);
-
-                    if (fM) {
-                        /* Left justify, so spaces go after */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, " ");
-                        }
-                    }
-                    ks_free(tmp);
-                    KS_DECREF(ia);
-
-                } else if (c == 'f' || c == 'F') {
-                    /* Integer conversion */
-                    ks_cfloat cf;
-                    if (!kso_get_cf(a, &cf)) {
-                        return NULL;
-                    }
+/* Add an integer in a given base, formatted according to 'it' */
+static bool fmt_int(ksio_BaseIO bio, struct fmt_ins* it, int width, kso a, int base) {
+    /* Integers (and subtypes, such as 'bool') are used directly, without a new reference */
+    ks_int ia = kso_issub(a->type, kst_int) ? (ks_int)a : kso_int(a);
+    if (!ia) return false;
 
-                    /* Number of zeros afterwards */
-                    int nza = 0;
+    char tmpb[128];
+    char* tmp = tmpb;
+    int rsz;
 
-                    /* Number of spaces padding */
-                    int nsp = 0;
-                    int i;
+    if (mpz_fits_slong_p(ia->val)) {
+        /* Convert on the stack, without GMP */
+        rsz = add_long_digits(tmpb, mpz_get_si(ia->val), base);
+    } else {
+        ks_size_t sz = mpz_sizeinbase(ia->val, base) + 4;
+        if (sz > sizeof(tmpb)) tmp = ks_malloc(sz);
+        mpz_get_str(tmp, base, ia->val);
+        rsz = strlen(tmp);
+    }
 
-                    bool isreg = ks_cfloat_isreg(cf);
+    fmt_pad(bio, it, width, tmp, rsz, 0, true);
 
-                    char tmpb[256];
-                    char* tmp = tmpb;
+    if (tmp != tmpb) ks_free(tmp);
+    if (ia != (ks_int)a) KS_DECREF(ia);
+    return true;
+}
 
-                    int rsz = ks_cfloat_to_str(tmpb, sizeof(tmpb) - 2, cf, false, prec < 0 ? KS_CFLOAT_DIG : prec, 10);
-                    if (rsz > sizeof(tmpb) - 2) {
-                        /* Dynamically allocate */
-                        tmp = ks_malloc(rsz + 1);
-                        int rrsz = ks_cfloat_to_str(tmp, rsz, cf, false, prec < 0 ? KS_CFLOAT_DIG : prec, 10);
-                        assert(rsz == rrsz);
-                    }
+/* Add a float, formatted according to 'it' */
+static bool fmt_float(ksio_BaseIO bio, struct fmt_ins* it, int width, int prec, kso a) {
+    ks_cfloat cf;
+    if (!kso_get_cf(a, &cf)) {
+        return false;
+    }
 
-                    /* Check if we need a specific size */
-                    if (prec >= 0 && isreg) {
-                        /* Find decimal point */
-                        int dp = rsz - 1;
-                        while (dp > 0 && tmpb[dp] != '.') {
-                            dp--;
-                        }
-
-                        /* Number of zeros afterwards */
-                        nza = prec - (rsz - dp) + 1;
-                        if (nza < 0) nza = 0;
-                    }
+    /* Number of zeros afterwards */
+    int nza = 0;
 
-                    /* Calculate number of spaces needed */
-                    if (width >= 0) {
-                        nsp = width - rsz - nza;
-                        if (nsp < 0) nsp = 0;
-                    }
+    bool isreg = ks_cfloat_isreg(cf);
 
-                    bool need_plus = fP && tmp[0] != '-';
-                    
-                    /* If '+' and actual sign is not given, then add it manually */
-                    if (need_plus) {
-                        nsp--;
-                        if (nsp < 0) nsp = 0;
-                    }
+    char tmpb[256];
+    char* tmp = tmpb;
 
-                    if (!fM) {
-                        /* Right-justified */
-                        if (fZ && need_plus) ksio_addbuf(bio, 1, "+");
+    int rsz = ks_cfloat_to_str(tmpb, sizeof(tmpb) - 2, cf, false, prec < 0 ? KS_CFLOAT_DIG : prec, 10);
+    if (rsz > sizeof(tmpb) - 2) {
+        /* Dynamically allocate */
+        tmp = ks_malloc(rsz + 1);
+        int rrsz = ks_cfloat_to_str(tmp, rsz, cf, false, prec < 0 ? KS_CFLOAT_DIG : prec, 10);
+        assert(rsz == rrsz);
+    }
 
-                        /* Fill beforehand */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, fZ && isreg ? "0" : " ");
-                        }
+    /* Check if we need a specific size */
+    if (prec >= 0 && isreg) {
+        /* Find decimal point */
+        int dp = rsz - 1;
+        while (dp > 0 && tmp[dp] != '.') {
+            dp--;
+        }
 
-                        if (!fZ && need_plus) ksio_addbuf(bio, 1, "+");
-                    } else {
-                        if (need_plus) ksio_addbuf(bio, 1, "+");
-                    }
-                    
-                    //if (need_plus) 
+        /* Number of zeros afterwards */
+        nza = prec - (rsz - dp) + 1;
+        if (nza < 0) nza = 0;
+    }
 
-                    /* Add actual digits and seperator */
-                    ksio_addbuf(bio, rsz, tmp);
+    fmt_pad(bio, it, width, tmp, rsz, nza, isreg);
 
-                    /* Fill zeros after */
-                    if (isreg) {
-                        for (i = 0; i < nza; ++i) {
-                            ksio_addbuf(bio, 1, "0");
-                        }
-                    }
+    if (tmp != tmpb) ks_free(tmp);
+    return true;
+}
 
-                    if (fM) {
-                        /* Left justify, so spaces go after */
-                        for (i = 0; i < nsp; ++i) {
-                            ksio_addbuf(bio, 1, " ");
-                        }
-                    }
+/* Run a compiled template, with 'fmt' being the string it was compiled from */
+static bool fmt_run(ksio_BaseIO bio, struct fmt_tmpl* tmpl, const char* fmt, int nargs, kso* args) {
+    int ai = 0, i;
+    for (i = 0; i < tmpl->n; ++i) {
+        struct fmt_ins* it = &tmpl->ins[i];
+        if (it->lit_len > 0) ksio_addbuf(bio, it->lit_len, fmt + it->lit_off);
+        if (!it->c) continue;
+
+        /* Resolve '*' width and precision from the arguments */
+        int width = it->width, prec = it->prec;
+        ks_cint cv;
+        if (width == -2) {
+            if (ai >= nargs) {
+                KS_THROW(kst_Error, "More format specifiers than arguments");
+                return false;
+            }
+            if (!kso_get_ci(args[ai++], &cv)) {
+                return false;
+            }
+            width = cv;
+        }
+        if (prec == -2) {
+            if (ai >= nargs) {
+                KS_THROW(kst_Error, "More format specifiers than arguments");
+                return false;
+            }
+            if (!kso_get_ci(args[ai++], &cv)) {
+                return false;
+            }
+            prec = cv;
+        }
 
-                    if (tmp != tmpb) ks_free(tmp);
+        if (it->c == '%') {
+            /* literal '%' */
+            ksio_addbuf(bio, 1, "%");
+            continue;
+        }
 
-                } else {
-                    KS_THROW(kst_Error, "Unknown format specifier: '%%%c'", c);
-                    return NULL;
-                }
-                
-                c = fmt[++p];
-            }
+        /* Actually have arguments */
+        if (ai >= nargs) {
+            KS_THROW(kst_Error, "More format specifiers than arguments");
+            return false;
+        }
+        kso a = args[ai++];
+
+        switch (it->c) {
+        case 's': case 'S':
+            /* String conversion */
+            if (!add_str(bio, a)) return false;
+            break;
+        case 'r': case 'R':
+            /* Repr conversion */
+            if (!add_repr(bio, a)) return false;
+            break;
+        case 't': case 'T':
+            /* Type conversion */
+            if (!ksio_addbuf(bio, a->type->i__fullname->len_b, a->type->i__fullname->data)) return false;
+            break;
+        case 'i': case 'I': case 'd': case 'D':
+            if (!fmt_int(bio, it, width, a, 10)) return false;
+            break;
+        case 'x': case 'X':
+            if (!fmt_int(bio, it, width, a, 16)) return false;
+            break;
+        case 'b': case 'B':
+            if (!fmt_int(bio, it, width, a, 2)) return false;
+            break;
+        case 'o': case 'O':
+            if (!fmt_int(bio, it, width, a, 8)) return false;
+            break;
+        case 'f': case 'F':
+            if (!fmt_float(bio, it, width, prec, a)) return false;
+            break;
+        default:
+            KS_THROW(kst_Error, "Unknown format specifier: '%%%c'", it->c == -1 ? 0 : it->c);
+            return false;
         }
     }
 
     if (ai < nargs) {
         KS_THROW(kst_Error, "More arguments than format specifiers");
-        return NULL;
+        return false;
     }
     return true;
 }
 
+bool ks_fmt2(ksio_BaseIO bio, const char* fmt, int nargs, kso* args) {
+    /* No object to key on, so compile a temporary template */
+    struct fmt_tmpl* tmpl = fmt_compile(fmt, strlen(fmt));
+    bool res = fmt_run(bio, tmpl, fmt, nargs, args);
+    ks_free(tmpl);
+    return res;
+}
+
+bool ks_fmt2s(ksio_BaseIO bio, ks_str fmt, int nargs, kso* args) {
+    struct fmt_tmpl* tmpl = fmt_take(fmt);
+    bool res = fmt_run(bio, tmpl, fmt->data, nargs, args);
+    fmt_put(fmt, tmpl);
+    return res;
+}
+
 
 
 bool ksio_fmt(ksio_BaseIO self, const char* fmt, ...) {
@@ -107,7 +107,7 @@ ksnet_http_req ksnet_http_get_request(ksio_BaseIO sock) {
 
         ks_str e_val = ks_str_new(i - fs, data + fs);
 
-        if (!ks_dict_set_h(headers, (kso)e_key, e_key->v_hash, (kso)e_val)) {
+        if (!ks_dict_set_h(headers, (kso)e_key, KS_STR_HASH(e_key), (kso)e_val)) {
             KS_DECREF(e_key);
             KS_DECREF(e_val);
             KS_DECREF(headers);
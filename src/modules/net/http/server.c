@@ -50,7 +50,7 @@ ksnet_http_server ksnet_http_server_new(ks_type tp, kso addr) {
 
 bool ksnet_http_server_serve(ksnet_http_server self) {
 
-    ks_str tk = ks_str_new(-1, "_handle");
+    ks_str tk = ks_str_intern_c(-1, "_handle");
     kso handle = kso_getattr((kso)self, tk);
     KS_DECREF(tk);
     if (!handle) return false;
@@ -151,7 +151,7 @@ static KS_TFUNC(T, _handle) {
     /* Response object (NULL until determined) */
     ksnet_http_resp resp = NULL;
 
-    ks_str tk = ks_str_new(-1, "handle");
+    ks_str tk = ks_str_intern_c(-1, "handle");
     kso handle = kso_getattr((kso)self, tk);
     KS_DECREF(tk);
     if (!handle) return NULL;
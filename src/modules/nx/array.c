@@ -12,6 +12,13 @@
 
 /* Internals */
 
+/* Return a view of 'val', which is part of 'of' (and is read-only if 'of' is) */
+static nx_view view_of(nx_t val, nx_array of) {
+    nx_view res = nx_view_newo(nxt_view, val, (kso)of);
+    res->readonly = kso_issub(of->type, nxt_view) && ((nx_view)of)->readonly;
+    return res;
+}
+
 static int kern_copy(int N, nx_t* args, int len, void* extra) {
     assert(N == 2);
     ks_cint i;
@@ -32,6 +39,24 @@ static int kern_copy(int N, nx_t* args, int len, void* extra) {
     return 0;
 }
 
+/* Export the buffer of an array or view (see 'ks_type->ob_buffer') */
+static bool export_buf(kso ob, struct ks_buffer* buf) {
+    nx_t val = ((nx_array)ob)->val;
+
+    KS_INCREF(ob);
+    buf->ref = ob;
+    buf->data = val.data;
+    buf->dtype = (kso)val.dtype;
+    buf->size = val.dtype->size;
+    buf->len_b = val.dtype->size * szprod(val.rank, val.shape);
+    buf->rank = val.rank;
+    memcpy(buf->shape, val.shape, sizeof(*val.shape) * val.rank);
+    memcpy(buf->strides, val.strides, sizeof(*val.strides) * val.rank);
+    buf->readonly = kso_issub(ob->type, nxt_view) && ((nx_view)ob)->readonly;
+
+    return true;
+}
+
 /* C-API */
 nx_array nx_array_newc(ks_type tp, void* data, nx_dtype dtype, int rank, ks_size_t* shape, ks_ssize_t* strides) {
     nx_array self = KSO_NEW(nx_array, tp);
@@ -164,7 +189,24 @@ static bool I_array_fill(ks_type tp, nx_dtype dtype, nx_array* resp, kso cur, in
 
 nx_array nx_array_newo(ks_type tp, kso obj, nx_dtype dtype) {
     if (!dtype) dtype = nxd_D;
-    
+
+    if (obj->type->ob_buffer && dtype->kind != NX_DTYPE_STRUCT) {
+        /* Convert the memory directly, instead of element by element */
+        struct ks_buffer buf;
+        if (!ks_buffer_get(obj, &buf, false)) return NULL;
+        nx_t of = nx_frombuf(&buf);
+        if (of.dtype->kind != NX_DTYPE_STRUCT) {
+            nx_array res = nx_array_newc(tp, NULL, dtype, of.rank, of.shape, NULL);
+            if (res && !nx_cast(of, res->val)) {
+                KS_DECREF(res);
+                res = NULL;
+            }
+            ks_buffer_release(&buf);
+            return res;
+        }
+        ks_buffer_release(&buf);
+    }
+
     /* Get block of objects */
     int rank;
     ks_size_t shape[NX_MAXRANK];
@@ -442,7 +484,7 @@ static KS_TFUNC(T, getattr) {
             sT = nx_swapaxes(sT, sT.rank - 2, sT.rank - 1);
         }
 
-        return (kso)nx_view_newo(nxt_view, sT, (kso)self);
+        return (kso)view_of(sT, self);
     } else if (self->val.dtype->kind == NX_DTYPE_STRUCT) {
         /* Find attribute and return view */
 
@@ -452,7 +494,7 @@ static KS_TFUNC(T, getattr) {
                 /* Construct view */
                 ks_uint ptr = (ks_uint)self->val.data + self->val.dtype->s_cstruct.members[i].offset;
                 nx_t res = nx_make((void*)ptr, self->val.dtype->s_cstruct.members[i].dtype, self->val.rank, self->val.shape, self->val.strides);
-                return (kso)nx_view_newo(nxt_view, res, (kso)self);
+                return (kso)view_of(res, self);
             }
 
         }
@@ -472,7 +514,7 @@ static KS_TFUNC(T, getelem) {
     nx_t res = nx_getevo(self->val, nargs, args);
     if (res.rank < 0) return NULL;
 
-    return (kso)nx_view_newo(nxt_view, res, (kso)self);
+    return (kso)view_of(res, self);
 }
 
 static KS_TFUNC(T, setelem) {
@@ -480,6 +522,11 @@ static KS_TFUNC(T, setelem) {
     int nargs;
     kso* args;
     KS_ARGS("self:* *args", &self, nxt_array, &nargs, &args);
+
+    if (kso_issub(self->type, nxt_view) && ((nx_view)self)->readonly) {
+        KS_THROW(kst_Error, "Cannot modify a read-only '%T'", self);
+        return NULL;
+    }
     
     if (nargs < 1) {
         KS_THROW(kst_ArgError, "Setting elements requires at least one argument");
@@ -715,7 +762,7 @@ static KS_TFUNC(TI, next) {
     ks_uint ptr = (ks_uint)self->of->val.data + p * self->of->val.strides[0];
     nx_t res = nx_make((void*)ptr, self->of->val.dtype, self->of->val.rank - 1, self->of->val.shape + 1, self->of->val.strides + 1);
 
-    return (kso)nx_view_newo(nxt_view, res, (kso)self->of);
+    return (kso)view_of(res, self->of);
 }
 
 
@@ -767,6 +814,8 @@ void _ksi_nx_array() {
 
     ));
 
+    nxt_array->ob_buffer = export_buf;
+
 }
 
 
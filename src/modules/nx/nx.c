@@ -32,6 +32,12 @@ nx_t nx_make(void* data, nx_dtype dtype, int rank, ks_size_t* shape, ks_ssize_t*
     return self;
 }
 
+nx_t nx_frombuf(struct ks_buffer* buf) {
+    nx_dtype dtype = buf->dtype ? (nx_dtype)buf->dtype : nxd_u8;
+    assert(kso_issub(dtype->type, nxt_dtype) && dtype->size == buf->size);
+    return nx_make(buf->data, dtype, buf->rank, buf->shape, buf->strides);
+}
+
 
 nx_t nx_newaxis(nx_t self, int axis) {
     assert(axis >= 0);
@@ -567,22 +573,53 @@ ks_str nx_getbs(nx_t x) {
 
 bool nx_get(kso obj, nx_dtype dtype, nx_t* res, kso* ref) {
     if (kso_issub(obj->type, nxt_array) && (!dtype || ((nx_array)obj)->val.dtype == dtype)) {
+        nx_t val = ((nx_array)obj)->val;
+        if (kso_issub(obj->type, nxt_view) && ((nx_view)obj)->readonly) {
+            /* Copy read-only views (since the result may be written to) */
+            nx_array newarr = nx_array_newc(nxt_array, val.data, val.dtype, val.rank, val.shape, val.strides);
+            if (!newarr) return false;
+            *res = newarr->val;
+            *ref = (kso)newarr;
+            return true;
+        }
+
         /* Already exists, TODO: check if cast is needed */
-        *res = ((nx_array)obj)->val;
+        *res = val;
         *ref = NULL;
         return true;
 
-    } else {
-        nx_array newarr = nx_array_newo(nxt_array, obj, dtype);
-        if (!newarr) {
-            return false;
+    } else if (obj->type->ob_buffer && !kso_issub(obj->type, nxt_array)) {
+        struct ks_buffer buf;
+        if (!ks_buffer_get(obj, &buf, false)) return false;
+        nx_t val = nx_frombuf(&buf);
+        if (!dtype || val.dtype == dtype) {
+            if (!buf.readonly) {
+                /* Share the memory, holding the buffer's reference */
+                *res = val;
+                *ref = buf.ref;
+                return true;
+            }
+
+            /* Copy read-only memory (since the result may be written to) */
+            nx_array newarr = nx_array_newc(nxt_array, val.data, val.dtype, val.rank, val.shape, val.strides);
+            ks_buffer_release(&buf);
+            if (!newarr) return false;
+            *res = newarr->val;
+            *ref = (kso)newarr;
+            return true;
         }
-        *res = newarr->val;
+        ks_buffer_release(&buf);
+    }
 
-        /* Return reference */
-        *ref = (kso)newarr;
-        return true;
+    nx_array newarr = nx_array_newo(nxt_array, obj, dtype);
+    if (!newarr) {
+        return false;
     }
+    *res = newarr->val;
+
+    /* Return reference */
+    *ref = (kso)newarr;
+    return true;
 }
 
 bool nx_getas(nx_t self, nx_dtype dtype, nx_t* res, void** tofree) {
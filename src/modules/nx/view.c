@@ -19,6 +19,7 @@ nx_view nx_view_newo(ks_type tp, nx_t val, kso ref) {
     self->val = val;
     if (ref) KS_INCREF(ref);
     self->ref = ref;
+    self->readonly = false;
 
     return self;
 }
@@ -36,6 +37,37 @@ static KS_TFUNC(T, free) {
     return KSO_NONE;
 }
 
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    kso obj;
+    nx_dtype dtype = NULL;
+    KS_ARGS("tp:* obj ?dtype:*", &tp, kst_type, &obj, &dtype, nxt_dtype);
+
+    struct ks_buffer buf;
+    if (!ks_buffer_get(obj, &buf, false)) return NULL;
+    nx_t val = nx_frombuf(&buf);
+
+    if (dtype && dtype != val.dtype) {
+        /* Reinterpret the memory as elements of 'dtype' */
+        if (!ks_buffer_contig(&buf)) {
+            ks_buffer_release(&buf);
+            KS_THROW(kst_Error, "Cannot reinterpret the memory of '%T' as %R, since it is not dense", obj, dtype);
+            return NULL;
+        } else if (buf.len_b % dtype->size != 0) {
+            ks_buffer_release(&buf);
+            KS_THROW(kst_SizeError, "Cannot reinterpret %l bytes as %R, which has a size of %i", (ks_cint)buf.len_b, dtype, dtype->size);
+            return NULL;
+        }
+        ks_size_t len = buf.len_b / dtype->size;
+        val = nx_make(buf.data, dtype, 1, &len, NULL);
+    }
+
+    nx_view res = nx_view_newo(tp, val, buf.ref);
+    res->readonly = buf.readonly;
+    ks_buffer_release(&buf);
+    return (kso)res;
+}
+
 
 /* Export */
 
@@ -46,6 +78,7 @@ void _ksi_nx_view() {
     
     _ksinit(nxt_view, nxt_array, T_NAME, sizeof(struct nx_view_s), -1, "Multidimesional array view", KS_IKV(
         {"__free",                 ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                  ksf_wrap(T_new_, T_NAME ".__new(tp, obj, dtype=none)", "Create a view of the memory of 'obj' without copying it (reinterpreted as a 1D array of 'dtype', if given)")},
         //{"__init__",               kso_func_new(T_init_, T_NAME ".__init__(self, name, version, desc, authors)", "")},
 
     ));
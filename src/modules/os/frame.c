@@ -129,6 +129,78 @@ bool ksos_frame_get_info(ksos_frame self, ks_str* fname, ks_str* func, int* line
 }
 
 
+/* Calculate the line (1-based) that 'pc' is at in 'bc', without throwing errors */
+static int code_line(ks_code bc, unsigned char* pc) {
+    if (!pc || bc->n_meta < 1) return bc->tok.sline + 1;
+    int offset = (int)(pc - bc->bc->data);
+
+    /* Binary search for the first entry which covers 'offset' (they are sorted on 'bc_n') */
+    ks_ssize_t lo = 0, hi = bc->n_meta - 1;
+    while (lo < hi) {
+        ks_ssize_t mid = (lo + hi) / 2;
+        if (offset <= bc->meta[mid].bc_n) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return bc->meta[lo].tok.sline + 1;
+}
+
+/* Return the file that 'bc' was compiled from
+ * NOTE: Function bodies are compiled with their signature as the name, so follow the frames they were
+ *   defined in until we find the top level code
+ */
+static ks_str code_file(ks_code bc, ks_func ff) {
+    kso c = ff ? ff->bfunc.closure : NULL;
+    while (c && kso_issub(c->type, ksost_frame)) {
+        kso f = ((ksos_frame)c)->func;
+        if (kso_issub(f->type, kst_code)) {
+            return ((ks_code)f)->fname;
+        } else if (kso_issub(f->type, kst_func) && !((ks_func)f)->is_cfunc) {
+            c = ((ks_func)f)->bfunc.closure;
+        } else {
+            break;
+        }
+    }
+    return bc->fname;
+}
+
+bool ksos_frame_where(ksos_frame self, ks_str* fname, int* line) {
+    kso f = self->func;
+    ks_func ff = NULL;
+    if (kso_issub(f->type, kst_func)) {
+        ff = (ks_func)f;
+        if (ff->is_cfunc) return false;
+        f = ff->bfunc.bc;
+    }
+
+    if (!kso_issub(f->type, kst_code)) return false;
+    ks_code bc = (ks_code)f;
+
+    *fname = code_file(bc, ff);
+    *line = code_line(bc, self->pc);
+    return true;
+}
+
+bool ksos_frame_defn(ksos_frame self, ks_str* fname, int* line) {
+    kso f = self->func;
+    ks_func ff = NULL;
+    if (kso_issub(f->type, kst_func)) {
+        ff = (ks_func)f;
+        if (ff->is_cfunc) return false;
+        f = ff->bfunc.bc;
+    }
+
+    if (!kso_issub(f->type, kst_code)) return false;
+    ks_code bc = (ks_code)f;
+
+    *fname = code_file(bc, ff);
+    *line = code_line(bc, NULL);
+    return true;
+}
+
+
 /* Type Functions */
 
 static KS_TFUNC(T, free) {
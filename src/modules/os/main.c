@@ -5,6 +5,7 @@
  *             Gregory Croisdale <greg@kscript.org>
  */
 #include <ks/impl.h>
+#include <ks/compiler.h>
 
 #define M_NAME "os"
 
@@ -826,6 +827,59 @@ static KS_TFUNC(M, dup) {
     return (kso)rr;
 }
 
+static KS_TFUNC(M, memtrace) {
+    bool on = true;
+    KS_ARGS("?on:bool", &on);
+
+    if (on) {
+        ks_memtrace_start();
+    } else {
+        ks_memtrace_stop();
+    }
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(M, vmstats) {
+    bool reset = false;
+    KS_ARGS("?reset:bool", &reset);
+
+    #ifdef KS_VMSTATS
+    ks_dict count = ks_dict_new(NULL), pairs = ks_dict_new(NULL), cycles = ks_dict_new(NULL);
+    int i, j;
+    for (i = 0; i < 256; ++i) {
+        const char* ni = ks_code_opname(i);
+        if (!ni) continue;
+        if (_ksvm_stats.count[i] > 0) {
+            ks_dict_set_c1(count, ni, (kso)ks_int_newu(_ksvm_stats.count[i]));
+        }
+        if (_ksvm_stats.cycles[i] > 0) {
+            ks_dict_set_c1(cycles, ni, (kso)ks_int_newu(_ksvm_stats.cycles[i]));
+        }
+        for (j = 0; j < 256; ++j) {
+            const char* nj = ks_code_opname(j);
+            if (!nj || _ksvm_stats.pair[i][j] == 0) continue;
+            ks_tuple key = ks_tuple_newn(2, (kso[]){ (kso)ks_str_new(-1, ni), (kso)ks_str_new(-1, nj) });
+            ks_int val = ks_int_newu(_ksvm_stats.pair[i][j]);
+            ks_dict_set(pairs, (kso)key, (kso)val);
+            KS_DECREF(key);
+            KS_DECREF(val);
+        }
+    }
+
+    if (reset) _ksvm_stats_reset();
+
+    return (kso)ks_dict_newn(KS_IKV(
+        {"count",                  (kso)count},
+        {"pairs",                  (kso)pairs},
+        {"cycles",                 (kso)cycles},
+    ));
+    #else
+    KS_THROW(kst_OSError, "Failed to get VM statistics: kscript was not built with them (use './configure --vmstats')");
+    return NULL;
+    #endif
+}
+
 /* Export */
 
 ksio_FileIO
@@ -844,6 +898,8 @@ ks_module _ksi_os() {
     _ksi_os_walk();
     _ksi_os_frame();
     _ksi_os_proc();
+    _ksi_os_profile();
+    _ksi_os_memsnap();
     _ksi_os_stat();
 
     ksos_argv = ks_list_new(0, NULL);
@@ -864,6 +920,8 @@ ks_module _ksi_os() {
         {"stat",                   KS_NEWREF(ksost_stat)},
 
         {"proc",                   KS_NEWREF(ksost_proc)},
+        {"profile",                KS_NEWREF(ksost_profile)},
+        {"memsnap",                KS_NEWREF(ksost_memsnap)},
         {"thread",                 KS_NEWREF(ksost_thread)},
 
         {"frame",                  KS_NEWREF(ksost_frame)},
@@ -892,6 +950,8 @@ ks_module _ksi_os() {
         {"exec",                   ksf_wrap(M_exec_, M_NAME ".exec(cmd)", "Attempts to execute a command as if typed in console - returns exit code")},
         {"fork",                   ksf_wrap(M_fork_, M_NAME ".fork()", "Creates a new process by duplicating the calling process - returns 0 in the child, PID > 0 in the parent")},
         {"pipe",                   ksf_wrap(M_pipe_, M_NAME ".pipe()", "Create a new pipe, and return a tuple of '(readio, writeio)' for the readable and writable ends respectively")},
+        {"memtrace",               ksf_wrap(M_memtrace_, M_NAME ".memtrace(on=true)", "Start (or stop, if 'on' is false) tracing allocations, recording the size, type, and source line of each one\n\n    Starting discards any previous trace data. Use 'os.memsnap()' to take a snapshot of the live allocations")},
+        {"vmstats",                ksf_wrap(M_vmstats_, M_NAME ".vmstats(reset=false)", "Return a dictionary of virtual machine statistics, with keys 'count' (executions of each instruction), 'pairs' (executions of each pair of consecutive instructions), and 'cycles' (cycles spent in each instruction, if supported)\n\n    If 'reset' is given and truthy, the statistics are reset to zero afterwards. Only available if kscript was built with './configure --vmstats'. Set the environment variable 'KS_VMSTATS' to print a summary at exit")},
         {"dup",                    ksf_wrap(M_dup_, M_NAME ".dup(fd, to=-1)", "Duplicate a file descriptor 'fd'\n\n    If 'to < 0', then create a new file descriptor and return it. Otherwise, replace 'to' with a copy of 'fd'")},
     
     
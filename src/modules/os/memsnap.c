@@ -0,0 +1,220 @@
+/* os/memsnap.c - 'os.memsnap' type
+ *
+ * Snapshots of the allocations traced by 'ks_memtrace_start()' (see 'memtrace.c'), which can be
+ *   compared to find where memory is growing
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+#define T_NAME "os.memsnap"
+
+
+/* Internals */
+
+/* Entry for sorting */
+struct ent {
+    kso key;
+    ks_cint count, bytes;
+};
+
+/* Sort by absolute bytes, descending */
+static int ent_cmp(const void* _L, const void* _R) {
+    const struct ent* L = _L, *R = _R;
+    ks_cint lb = L->bytes < 0 ? -L->bytes : L->bytes, rb = R->bytes < 0 ? -R->bytes : R->bytes;
+    return lb == rb ? 0 : (lb > rb ? -1 : 1);
+}
+
+/* Get '(count, bytes)' for a site */
+static bool get_site(ks_dict sites, kso key, ks_hash_t hash, ks_cint* count, ks_cint* bytes) {
+    *count = *bytes = 0;
+    ks_tuple val = (ks_tuple)ks_dict_get_ih(sites, key, hash);
+    if (!val) return true;
+
+    bool res = kso_get_ci(val->elems[0], count) && kso_get_ci(val->elems[1], bytes);
+    KS_DECREF(val);
+    return res;
+}
+
+/* Sort entries, and convert the first 'n' to a list of '(type, fname, line, count, bytes)' */
+static ks_list make_list(struct ent* ents, ks_cint len, ks_cint n) {
+    qsort(ents, len, sizeof(*ents), ent_cmp);
+    if (n < 0 || n > len) n = len;
+
+    ks_list res = ks_list_new(0, NULL);
+    ks_cint i;
+    for (i = 0; i < n; ++i) {
+        ks_tuple key = (ks_tuple)ents[i].key;
+        ks_list_pushu(res, (kso)ks_tuple_newn(5, (kso[]){
+            KS_NEWREF(key->elems[0]),
+            KS_NEWREF(key->elems[1]),
+            KS_NEWREF(key->elems[2]),
+            (kso)ks_int_new(ents[i].count),
+            (kso)ks_int_new(ents[i].bytes),
+        }));
+    }
+
+    return res;
+}
+
+
+/* C-API */
+
+ksos_memsnap ksos_memsnap_new(ks_type tp) {
+    if (!ks_memtrace_is_active()) {
+        KS_THROW(kst_Error, "Memory tracing is not active (call 'os.memtrace()' first)");
+        return NULL;
+    }
+
+    ksos_memsnap self = KSO_NEW(ksos_memsnap, tp);
+
+    ks_size_t cur, peak, allocs;
+    ks_memtrace_usage(&cur, &peak, &allocs);
+    self->cur = cur;
+    self->peak = peak;
+    self->allocs = allocs;
+    self->sites = ks_memtrace_sites();
+
+    return self;
+}
+
+ks_list ksos_memsnap_top(ksos_memsnap self, ks_cint n) {
+    struct ent* ents = ks_zmalloc(sizeof(*ents), self->sites->len_real + 1);
+    ks_cint i, len = 0;
+    for (i = 0; i < self->sites->len_ents; ++i) {
+        struct ks_dict_ent* it = &self->sites->ents[i];
+        if (!it->key) continue;
+        ents[len].key = it->key;
+        if (!get_site(self->sites, it->key, it->hash, &ents[len].count, &ents[len].bytes)) {
+            ks_free(ents);
+            return NULL;
+        }
+        len++;
+    }
+
+    ks_list res = make_list(ents, len, n);
+    ks_free(ents);
+    return res;
+}
+
+ks_list ksos_memsnap_diff(ksos_memsnap self, ksos_memsnap old, ks_cint n) {
+    struct ent* ents = ks_zmalloc(sizeof(*ents), self->sites->len_real + old->sites->len_real + 1);
+    ks_cint i, len = 0, c0, b0, c1, b1;
+
+    /* Sites in the new snapshot (and possibly the old) */
+    for (i = 0; i < self->sites->len_ents; ++i) {
+        struct ks_dict_ent* it = &self->sites->ents[i];
+        if (!it->key) continue;
+        if (!get_site(self->sites, it->key, it->hash, &c1, &b1) || !get_site(old->sites, it->key, it->hash, &c0, &b0)) {
+            ks_free(ents);
+            return NULL;
+        }
+        if (c1 == c0 && b1 == b0) continue;
+        ents[len].key = it->key;
+        ents[len].count = c1 - c0;
+        ents[len].bytes = b1 - b0;
+        len++;
+    }
+
+    /* Sites only in the old snapshot (i.e. all freed) */
+    for (i = 0; i < old->sites->len_ents; ++i) {
+        struct ks_dict_ent* it = &old->sites->ents[i];
+        if (!it->key) continue;
+        bool has;
+        if (!ks_dict_has_h(self->sites, it->key, it->hash, &has) || !get_site(old->sites, it->key, it->hash, &c0, &b0)) {
+            ks_free(ents);
+            return NULL;
+        }
+        if (has) continue;
+        ents[len].key = it->key;
+        ents[len].count = -c0;
+        ents[len].bytes = -b0;
+        len++;
+    }
+
+    ks_list res = make_list(ents, len, n);
+    ks_free(ents);
+    return res;
+}
+
+
+/* Type Functions */
+
+static KS_TFUNC(T, free) {
+    ksos_memsnap self;
+    KS_ARGS("self:*", &self, ksost_memsnap);
+
+    KS_DECREF(self->sites);
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    KS_ARGS("tp:*", &tp, kst_type);
+
+    return (kso)ksos_memsnap_new(tp);
+}
+
+static KS_TFUNC(T, str) {
+    ksos_memsnap self;
+    KS_ARGS("self:*", &self, ksost_memsnap);
+
+    return (kso)ks_fmt("<%T (current=%l, peak=%l, sites=%l)>", self, self->cur, self->peak, (ks_cint)self->sites->len_real);
+}
+
+static KS_TFUNC(T, getattr) {
+    ksos_memsnap self;
+    ks_str attr;
+    KS_ARGS("self:* attr:*", &self, ksost_memsnap, &attr, kst_str);
+
+    if (ks_str_eq_c(attr, "current", 7)) {
+        return (kso)ks_int_new(self->cur);
+    } else if (ks_str_eq_c(attr, "peak", 4)) {
+        return (kso)ks_int_new(self->peak);
+    } else if (ks_str_eq_c(attr, "allocs", 6)) {
+        return (kso)ks_int_new(self->allocs);
+    } else if (ks_str_eq_c(attr, "sites", 5)) {
+        return KS_NEWREF(self->sites);
+    }
+
+    KS_THROW_ATTR(self, attr);
+    return NULL;
+}
+
+static KS_TFUNC(T, top) {
+    ksos_memsnap self;
+    ks_cint n = 10;
+    KS_ARGS("self:* ?n:cint", &self, ksost_memsnap, &n);
+
+    return (kso)ksos_memsnap_top(self, n);
+}
+
+static KS_TFUNC(T, diff) {
+    ksos_memsnap self, old;
+    ks_cint n = 10;
+    KS_ARGS("self:* old:* ?n:cint", &self, ksost_memsnap, &old, ksost_memsnap, &n);
+
+    return (kso)ksos_memsnap_diff(self, old, n);
+}
+
+
+/* Export */
+
+static struct ks_type_s tp;
+ks_type ksost_memsnap = &tp;
+
+void _ksi_os_memsnap() {
+    _ksinit(ksost_memsnap, kst_object, T_NAME, sizeof(struct ksos_memsnap_s), -1, "Snapshot of the live allocations recorded since 'os.memtrace()' was called\n\n    Each site is a '(type, fname, line)' tuple, where 'type' is the name of the type of object allocated (or '<raw>' for other memory), and 'fname' and 'line' are where the kscript code was executing", KS_IKV(
+        {"__free",                 ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                  ksf_wrap(T_new_, T_NAME ".__new(tp)", "")},
+        {"__str",                  ksf_wrap(T_str_, T_NAME ".__str(self)", "")},
+        {"__repr",                 ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
+        {"__getattr",              ksf_wrap(T_getattr_, T_NAME ".__getattr(self, attr)", "")},
+
+        {"top",                    ksf_wrap(T_top_, T_NAME ".top(self, n=10)", "Return a list of the 'n' sites using the most memory, as '(type, fname, line, count, bytes)' tuples\n\n    If 'n < 0', all sites are returned")},
+        {"diff",                   ksf_wrap(T_diff_, T_NAME ".diff(self, old, n=10)", "Return a list of the 'n' sites whose memory changed the most since the snapshot 'old', as '(type, fname, line, count_diff, bytes_diff)' tuples\n\n    If 'n < 0', all changed sites are returned")},
+    ));
+}
@@ -0,0 +1,405 @@
+/* os/profile.c - 'os.profile' type
+ *
+ * Sampling profiler. A 'SIGPROF' interval timer (measuring CPU time) sets a flag asynchronously, and the
+ *   virtual machine checks that flag between instructions. When it is set, '_ksos_profile_sample()' walks the
+ *   frames of every live thread and records the stack. Since the sample is taken at a safe point (holding the GIL),
+ *   no allocation or interpreter state is touched inside the signal handler
+ *
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+#include <ks/compiler.h>
+
+#ifdef KS_HAVE_SYS_TIME_H
+  #include <sys/time.h>
+#endif
+
+#define T_NAME "os.profile"
+
+
+/* Internals */
+
+volatile sig_atomic_t _ksos_profile_pending = 0;
+
+/* Currently active profiler (holds a reference), or NULL if none is */
+static ksos_profile active_prof = NULL;
+
+/* Key for the full name of a function */
+static ks_str str_fullname = NULL;
+
+#ifdef KS_HAVE_setitimer
+
+/* Handler that was installed before the profiler started */
+static struct sigaction old_sa;
+
+static void handle_sigprof(int sig) {
+    _ksos_profile_pending = 1;
+}
+
+#endif
+
+/* Return a label for the function a frame is running, like 'name (fname:line)'
+ *
+ * The line is where the function begins, not where the frame currently is, so each function gets one row (and
+ *   one node in folded stacks) however many lines it was sampled on
+ */
+static ks_str frame_label(ksos_frame frame) {
+    kso f = frame->func;
+    ks_str name = NULL;
+    if (kso_issub(f->type, kst_func)) {
+        name = (ks_str)ks_dict_get_ih(((ks_func)f)->attr, (kso)str_fullname, KS_STR_HASH(str_fullname));
+    }
+
+    ks_str res = NULL, fname;
+    int line;
+    if (ksos_frame_defn(frame, &fname, &line)) {
+        res = name ? ks_fmt("%S (%S:%i)", name, fname, line) : ks_fmt("<module> (%S:%i)", fname, line);
+    } else if (name) {
+        return name;
+    } else {
+        res = ks_fmt("<%T @ %p>", f, f);
+    }
+
+    KS_NDECREF(name);
+    return res;
+}
+
+/* Add 'num' to the count stored at 'key' in 'counts' */
+static bool count_add(ks_dict counts, kso key, ks_cint num) {
+    ks_hash_t hash;
+    if (!kso_hash(key, &hash)) return false;
+
+    ks_cint cur = 0;
+    kso val = ks_dict_get_ih(counts, key, hash);
+    if (val) {
+        if (!kso_get_ci(val, &cur)) {
+            KS_DECREF(val);
+            return false;
+        }
+        KS_DECREF(val);
+    }
+
+    ks_int nv = ks_int_new(cur + num);
+    bool res = ks_dict_set_h(counts, key, hash, (kso)nv);
+    KS_DECREF(nv);
+    return res;
+}
+
+void _ksos_profile_sample() {
+    _ksos_profile_pending = 0;
+    ksos_profile self = active_prof;
+    if (!self) return;
+
+    ks_list threads = ksos_thread_all();
+    int i, j;
+    for (i = 0; i < threads->len; ++i) {
+        ksos_thread th = (ksos_thread)threads->elems[i];
+        ks_list frames = th->frames;
+        if (frames->len < 1) continue;
+
+        /* Thread name, followed by the frames (outermost first) */
+        int n = 1 + frames->len;
+        kso* elems = ks_malloc(sizeof(*elems) * n);
+        elems[0] = KS_NEWREF(th->name);
+        for (j = 0; j < frames->len; ++j) {
+            elems[j + 1] = (kso)frame_label((ksos_frame)frames->elems[j]);
+        }
+
+        ks_tuple key = ks_tuple_newn(n, elems);
+        ks_free(elems);
+
+        if (!count_add(self->stacks, (kso)key, 1)) {
+            kso_catch_ignore();
+        }
+        KS_DECREF(key);
+    }
+    KS_DECREF(threads);
+
+    self->n_samples++;
+}
+
+/* Entry for the table */
+struct prof_ent {
+    ks_str label;
+    ks_cint self, total;
+};
+
+static int prof_ent_cmp(const void* _L, const void* _R) {
+    const struct prof_ent* L = _L, *R = _R;
+    if (L->self != R->self) return L->self > R->self ? -1 : 1;
+    if (L->total != R->total) return L->total > R->total ? -1 : 1;
+    return 0;
+}
+
+
+/* C-API */
+
+ksos_profile ksos_profile_new(ks_type tp, ks_cfloat interval) {
+    if (!(interval > 0)) {
+        KS_THROW(kst_ArgError, "Profiling interval must be positive, but got %f", interval);
+        return NULL;
+    }
+
+    ksos_profile self = KSO_NEW(ksos_profile, tp);
+
+    self->interval = interval;
+    self->is_active = false;
+    self->n_samples = 0;
+    self->stacks = ks_dict_new(NULL);
+
+    return self;
+}
+
+bool ksos_profile_start(ksos_profile self) {
+    if (self->is_active) return true;
+    #ifdef KS_HAVE_setitimer
+    if (active_prof) {
+        KS_THROW(kst_Error, "Another profiler is already active");
+        return false;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_sigprof;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGPROF, &sa, &old_sa) != 0) {
+        KS_THROW_ERRNO(errno, "Failed to install 'SIGPROF' handler");
+        return false;
+    }
+
+    struct itimerval it;
+    it.it_interval.tv_sec = (long)self->interval;
+    it.it_interval.tv_usec = (long)((self->interval - it.it_interval.tv_sec) * 1000000);
+    if (it.it_interval.tv_sec == 0 && it.it_interval.tv_usec == 0) it.it_interval.tv_usec = 1;
+    it.it_value = it.it_interval;
+
+    if (setitimer(ITIMER_PROF, &it, NULL) != 0) {
+        KS_THROW_ERRNO(errno, "Failed to start profiling timer");
+        sigaction(SIGPROF, &old_sa, NULL);
+        return false;
+    }
+
+    KS_INCREF(self);
+    active_prof = self;
+    self->is_active = true;
+    return true;
+    #else
+    KS_THROW(kst_OSError, "Failed to start profiler: platform did not provide a 'setitimer()' function");
+    return false;
+    #endif
+}
+
+bool ksos_profile_stop(ksos_profile self) {
+    if (!self->is_active) return true;
+    #ifdef KS_HAVE_setitimer
+    struct itimerval it;
+    memset(&it, 0, sizeof(it));
+    setitimer(ITIMER_PROF, &it, NULL);
+    sigaction(SIGPROF, &old_sa, NULL);
+    #endif
+
+    _ksos_profile_pending = 0;
+    active_prof = NULL;
+    self->is_active = false;
+    KS_DECREF(self);
+    return true;
+}
+
+bool ksos_profile_folded(ksos_profile self, ksio_BaseIO io) {
+    ks_cint i, j;
+    for (i = 0; i < self->stacks->len_ents; ++i) {
+        struct ks_dict_ent* ent = &self->stacks->ents[i];
+        if (!ent->key) continue;
+        ks_tuple key = (ks_tuple)ent->key;
+        for (j = 0; j < key->len; ++j) {
+            if (j > 0) ksio_add(io, ";");
+            ksio_add(io, "%S", key->elems[j]);
+        }
+        ksio_add(io, " %S\n", ent->val);
+    }
+    return true;
+}
+
+bool ksos_profile_table(ksos_profile self, ksio_BaseIO io) {
+    ks_dict selfs = ks_dict_new(NULL), totals = ks_dict_new(NULL);
+    ks_set seen = ks_set_new(0, NULL);
+
+    ks_cint i, j;
+    for (i = 0; i < self->stacks->len_ents; ++i) {
+        struct ks_dict_ent* ent = &self->stacks->ents[i];
+        if (!ent->key) continue;
+        ks_tuple key = (ks_tuple)ent->key;
+        if (key->len < 2) continue;
+
+        ks_cint num;
+        if (!kso_get_ci(ent->val, &num)) goto fail;
+
+        /* Innermost frame gets 'self' time, and each unique frame gets 'total' time (so recursion isn't counted twice) */
+        if (!count_add(selfs, key->elems[key->len - 1], num)) goto fail;
+        ks_set_clear(seen);
+        for (j = 1; j < key->len; ++j) {
+            bool has;
+            if (!ks_set_has(seen, key->elems[j], &has)) goto fail;
+            if (has) continue;
+            if (!ks_set_add(seen, key->elems[j])) goto fail;
+            if (!count_add(totals, key->elems[j], num)) goto fail;
+        }
+    }
+
+    ks_cint n = 0;
+    struct prof_ent* ents = ks_malloc(sizeof(*ents) * (totals->len_real + 1));
+    for (i = 0; i < totals->len_ents; ++i) {
+        struct ks_dict_ent* ent = &totals->ents[i];
+        if (!ent->key) continue;
+        ents[n].label = (ks_str)ent->key;
+        ents[n].self = 0;
+        if (!kso_get_ci(ent->val, &ents[n].total)) {
+            ks_free(ents);
+            goto fail;
+        }
+        kso sv = ks_dict_get_ih(selfs, ent->key, ent->hash);
+        if (sv) {
+            kso_get_ci(sv, &ents[n].self);
+            KS_DECREF(sv);
+        }
+        n++;
+    }
+
+    qsort(ents, n, sizeof(*ents), prof_ent_cmp);
+
+    ks_cfloat ns = self->n_samples > 0 ? self->n_samples : 1;
+    ksio_add(io, "%l samples (every %fs)\n", (ks_cint)self->n_samples, self->interval);
+    ksio_add(io, "  self%%  total%%      self     total  function\n");
+    for (i = 0; i < n; ++i) {
+        char tmp[128];
+        snprintf(tmp, sizeof(tmp), "%6.2f%% %6.2f%% %9lli %9lli  ", 100.0 * ents[i].self / ns, 100.0 * ents[i].total / ns, (long long)ents[i].self, (long long)ents[i].total);
+        ksio_add(io, "%s%S\n", tmp, ents[i].label);
+    }
+
+    ks_free(ents);
+    KS_DECREF(selfs);
+    KS_DECREF(totals);
+    KS_DECREF(seen);
+    return true;
+
+    fail:
+    KS_DECREF(selfs);
+    KS_DECREF(totals);
+    KS_DECREF(seen);
+    return false;
+}
+
+
+/* Type Functions */
+
+static KS_TFUNC(T, free) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    KS_DECREF(self->stacks);
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    ks_cfloat interval = 0.01;
+    KS_ARGS("tp:* ?interval:cfloat", &tp, kst_type, &interval);
+
+    return (kso)ksos_profile_new(tp, interval);
+}
+
+static KS_TFUNC(T, str) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    return (kso)ks_fmt("<%T (samples=%l, active=%s)>", self, (ks_cint)self->n_samples, self->is_active ? "true" : "false");
+}
+
+static KS_TFUNC(T, getattr) {
+    ksos_profile self;
+    ks_str attr;
+    KS_ARGS("self:* attr:*", &self, ksost_profile, &attr, kst_str);
+
+    if (ks_str_eq_c(attr, "samples", 7)) {
+        return (kso)ks_int_new(self->n_samples);
+    } else if (ks_str_eq_c(attr, "interval", 8)) {
+        return (kso)ks_float_new(self->interval);
+    } else if (ks_str_eq_c(attr, "stacks", 6)) {
+        return KS_NEWREF(self->stacks);
+    }
+
+    KS_THROW_ATTR(self, attr);
+    return NULL;
+}
+
+static KS_TFUNC(T, start) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    if (!ksos_profile_start(self)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, stop) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    if (!ksos_profile_stop(self)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, folded) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    ksio_StringIO sio = ksio_StringIO_new();
+    if (!ksos_profile_folded(self, (ksio_BaseIO)sio)) {
+        KS_DECREF(sio);
+        return NULL;
+    }
+
+    return (kso)ksio_StringIO_getf(sio);
+}
+
+static KS_TFUNC(T, table) {
+    ksos_profile self;
+    KS_ARGS("self:*", &self, ksost_profile);
+
+    ksio_StringIO sio = ksio_StringIO_new();
+    if (!ksos_profile_table(self, (ksio_BaseIO)sio)) {
+        KS_DECREF(sio);
+        return NULL;
+    }
+
+    return (kso)ksio_StringIO_getf(sio);
+}
+
+
+/* Export */
+
+static struct ks_type_s tp;
+ks_type ksost_profile = &tp;
+
+void _ksi_os_profile() {
+    str_fullname = ks_str_new(-1, "__fullname");
+
+    _ksinit(ksost_profile, kst_object, T_NAME, sizeof(struct ksos_profile_s), -1, "Sampling profiler, which periodically records the call stack of every thread\n\n    Samples are requested by a 'SIGPROF' timer (measuring CPU time), and taken between bytecode instructions. Results can be retrieved as folded stacks (for flamegraph tools), or as a table of self/total time per function", KS_IKV(
+        {"__free",                 ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                  ksf_wrap(T_new_, T_NAME ".__new(tp, interval=0.01)", "")},
+        {"__str",                  ksf_wrap(T_str_, T_NAME ".__str(self)", "")},
+        {"__repr",                 ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
+        {"__getattr",              ksf_wrap(T_getattr_, T_NAME ".__getattr(self, attr)", "")},
+
+        {"start",                  ksf_wrap(T_start_, T_NAME ".start(self)", "Start sampling")},
+        {"stop",                   ksf_wrap(T_stop_, T_NAME ".stop(self)", "Stop sampling")},
+        {"folded",                 ksf_wrap(T_folded_, T_NAME ".folded(self)", "Return the samples in folded stack format (i.e. one 'a;b;c count' line per unique stack)")},
+        {"table",                  ksf_wrap(T_table_, T_NAME ".table(self)", "Return a table of functions, with the number of samples in each function (self) and under each function (total)")},
+    ));
+}
@@ -179,6 +179,21 @@ bool ksos_thread_join(ksos_thread self) {
     #endif
 }
 
+ks_list ksos_thread_all() {
+    ks_list res = ks_list_new(0, NULL);
+    ks_list_push(res, (kso)ksg_main_thread);
+
+    int i;
+    for (i = 0; i < active_threads->len_ents; ++i) {
+        struct ks_set_ent* ent = &active_threads->ents[i];
+        if (ent->key != NULL && ((ksos_thread)ent->key)->is_active) {
+            ks_list_push(res, ent->key);
+        }
+    }
+
+    return res;
+}
+
 /* Type Functions */
 
 static KS_TFUNC(T, free) {
@@ -1700,7 +1700,7 @@ RULE(ATOM) {
     if (TOK.kind == KS_TOK_NAME) {
         ks_tok t = EAT();
         ks_str v = ks_tok_str(src, t);
-        kso r = ks_dict_get_ih(kwconst, (kso)v, v->v_hash);
+        kso r = ks_dict_get_ih(kwconst, (kso)v, KS_STR_HASH(v));
         ks_ast res = NULL;
         if (r) {
             KS_DECREF(v);
@@ -1922,15 +1922,18 @@ ks_ast ks_parse_prog(ks_str fname, ks_str src, ks_ssize_t n_toks, ks_tok* toks)
     int i = 0;
     int *tokip = &i;
 
-    ks_ast res = SUBF(PROG, PF_NONE);
-    if (!res) return NULL;
+    /* Allocate the nodes together, so they are freed in one shot once the program is released */
+    ks_arena arena = ks_arena_new(), prev = ks_ast_arena(arena);
 
-    if (TOK.kind != KS_TOK_EOF) {
+    ks_ast res = SUBF(PROG, PF_NONE);
+    if (res && TOK.kind != KS_TOK_EOF) {
         KS_THROW_SYNTAX(fname, src, TOK, "Unexpected token");
         KS_DECREF(res);
-        return NULL;
+        res = NULL;
     }
 
+    ks_ast_arena(prev);
+    ks_arena_close(arena);
     return res;
 }
 
@@ -1938,8 +1941,12 @@ ks_ast ks_parse_expr(ks_str fname, ks_str src, ks_ssize_t n_toks, ks_tok* toks)
     int i = 0;
     int *tokip = &i;
 
+    ks_arena arena = ks_arena_new(), prev = ks_ast_arena(arena);
+
     ks_ast res = SUBF(EXPR, PF_NONE);
 
+    ks_ast_arena(prev);
+    ks_arena_close(arena);
     return res;
 }
 
@@ -0,0 +1,180 @@
+/* perf.c - Linux 'perf' integration, with per-function trampolines and a perf map file
+ *
+ * Normally, a native profiler (such as 'perf record') attributes all the time spent running kscript code
+ *   to '_ks_exec()', since it can't see the kscript functions. When active, each code object is executed
+ *   through its own small trampoline (a copy of the same machine code, at a unique address), which just
+ *   calls the VM. The address range of each trampoline is written, along with the name of the function,
+ *   to '/tmp/perf-<pid>.map', which 'perf' (and other tools) read to symbolize unknown addresses
+ *
+ * So, stacks look like '_ks_exec <- [ks::fib(n) fib.ks:4] <- _ks_exec <- ...', which can be used with
+ *   standard tools (flame graphs, 'perf report', etc.)
+ *
+ * Trampolines are allocated from arenas of executable memory, which are filled with copies and then made
+ *   read-only, so no memory is writable and executable at the same time. They are never freed (a code object
+ *   that is freed just leaves its trampoline unused), since 'perf' may still need the entry in the map
+ *
+ * Only supported on Linux (x86_64 and aarch64)
+ *
+ * SEE: https://github.com/torvalds/linux/blob/master/tools/perf/Documentation/jit-interface.txt
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+#include <ks/compiler.h>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && defined(KS_HAVE_SYS_MMAN_H)
+  #define KS_PERF_TRAMP
+  #include <sys/mman.h>
+#endif
+
+
+/* Internals */
+
+bool _ks_perf_active = false;
+
+#ifdef KS_PERF_TRAMP
+
+/* Trampoline: 'kso tramp(ks_code bc, ks_type _in, kso (*exec)(ks_code, ks_type))', which calls 'exec(bc, _in)'
+ *
+ * The arguments are already in the correct registers, so it just sets up a frame (so frame-pointer based
+ *   unwinding works) and calls 'exec'
+ */
+#if defined(__x86_64__)
+__asm__(
+    ".text\n"
+    ".balign 16\n"
+    "ks_perf_tramp_start:\n"
+    "    push %rbp\n"
+    "    mov %rsp, %rbp\n"
+    "    call *%rdx\n"
+    "    pop %rbp\n"
+    "    ret\n"
+    "ks_perf_tramp_end:\n"
+);
+#elif defined(__aarch64__)
+__asm__(
+    ".text\n"
+    ".balign 16\n"
+    "ks_perf_tramp_start:\n"
+    "    stp x29, x30, [sp, -16]!\n"
+    "    mov x29, sp\n"
+    "    blr x2\n"
+    "    ldp x29, x30, [sp], 16\n"
+    "    ret\n"
+    "ks_perf_tramp_end:\n"
+);
+#endif
+
+extern char ks_perf_tramp_start[], ks_perf_tramp_end[];
+
+typedef kso (*tramp_t)(ks_code bc, ks_type _in, kso (*exec)(ks_code, ks_type));
+
+/* Size of each arena, and of each trampoline within it (aligned) */
+#define ARENA_SZ (64 * 1024)
+#define TRAMP_SZ (((ks_size_t)(ks_perf_tramp_end - ks_perf_tramp_start) + 15) & ~(ks_size_t)15)
+
+/* Current arena, and the offset of the next trampoline to give out from it */
+static char* arena = NULL;
+static ks_size_t arena_pos = 0;
+
+/* Map file being written to */
+static FILE* map_fp = NULL;
+
+/* Allocate a new trampoline */
+static tramp_t new_tramp() {
+    if (!arena || arena_pos + TRAMP_SZ > ARENA_SZ) {
+        char* mem = mmap(NULL, ARENA_SZ, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return NULL;
+
+        /* Fill the arena with copies, and then make it executable */
+        ks_size_t i;
+        for (i = 0; i + TRAMP_SZ <= ARENA_SZ; i += TRAMP_SZ) {
+            memcpy(mem + i, ks_perf_tramp_start, ks_perf_tramp_end - ks_perf_tramp_start);
+        }
+        if (mprotect(mem, ARENA_SZ, PROT_READ | PROT_EXEC) != 0) {
+            munmap(mem, ARENA_SZ);
+            return NULL;
+        }
+        __builtin___clear_cache(mem, mem + ARENA_SZ);
+
+        arena = mem;
+        arena_pos = 0;
+    }
+
+    tramp_t res = (tramp_t)(arena + arena_pos);
+    arena_pos += TRAMP_SZ;
+    return res;
+}
+
+/* Write the map entry for a trampoline */
+static void write_entry(ks_code bc, tramp_t tramp) {
+    ks_str fname = NULL;
+    int line = 0;
+
+    /* The frame being executed is for 'bc' (and at the start), so this gives the file and first line */
+    ksos_thread th = ksos_thread_get();
+    if (th && th->frames->len > 0) {
+        ksos_frame_where((ksos_frame)th->frames->elems[th->frames->len - 1], &fname, &line);
+    }
+
+    /* Top-level code is named after the file */
+    const char* name = (fname && ks_str_eq(bc->fname, fname)) ? "<module>" : bc->fname->data;
+    if (fname) {
+        fprintf(map_fp, "%lx %lx ks::%s %s:%i\n", (unsigned long)tramp, (unsigned long)TRAMP_SZ, name, fname->data, line);
+    } else {
+        fprintf(map_fp, "%lx %lx ks::%s\n", (unsigned long)tramp, (unsigned long)TRAMP_SZ, name);
+    }
+    fflush(map_fp);
+}
+
+#endif /* KS_PERF_TRAMP */
+
+kso _ks_perf_exec(ks_code bc, ks_type _in, kso (*exec)(ks_code, ks_type)) {
+#ifdef KS_PERF_TRAMP
+    if (!bc->perf_tramp && map_fp) {
+        tramp_t tramp = new_tramp();
+        if (tramp) {
+            write_entry(bc, tramp);
+            bc->perf_tramp = (void*)tramp;
+        }
+    }
+    if (bc->perf_tramp) {
+        return ((tramp_t)bc->perf_tramp)(bc, _in, exec);
+    }
+#endif
+    return exec(bc, _in);
+}
+
+
+/* C-API */
+
+bool ks_perf_start() {
+    if (_ks_perf_active) return true;
+#ifdef KS_PERF_TRAMP
+    if (!map_fp) {
+        char path[256];
+        snprintf(path, sizeof(path), "/tmp/perf-%i.map", (int)getpid());
+        map_fp = fopen(path, "a");
+        if (!map_fp) {
+            KS_THROW(kst_IOError, "Failed to open '%s' for writing: %s", path, strerror(errno));
+            return false;
+        }
+    }
+    _ks_perf_active = true;
+    return true;
+#else
+    KS_THROW(kst_OSError, "Trampolines for 'perf' are not supported on this platform");
+    return false;
+#endif
+}
+
+void ks_perf_stop() {
+    /* Keep the map file open (and existing trampolines valid), since 'perf' still needs the entries for
+     *   samples taken so far
+     */
+    _ks_perf_active = false;
+}
+
+bool ks_perf_is_active() {
+    return _ks_perf_active;
+}
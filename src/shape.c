@@ -0,0 +1,150 @@
+/* shape.c - shapes (hidden classes), for storing the attributes of instances compactly
+ *
+ * Instances of user-defined types don't get their own attribute dictionary. Instead, they have a 'struct ks_slots'
+ *   (at 'tp->ob_slots'), which is a shape and an array of values. Looking up an attribute is a search of the
+ *   names in the shape (which is usually just a few pointer comparisons, since the names are interned), and then
+ *   an indexed load
+ *
+ * The shapes of a type form a tree, rooted at 'tp->ob_shape'. Instances that have the same attributes added in
+ *   the same order end up with the same shape, so there are typically only a few shapes per type
+ *
+ * Instances with more than 'KS_SHAPE_MAX' attributes, or whose '.__attr' dictionary is requested, are converted
+ *   to use the attribute dictionary instead (at 'tp->ob_attr'), which they use from then on
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+
+/* Internals */
+
+/* Maximum number of attributes stored by shape */
+#define KS_SHAPE_MAX 64
+
+/* Find 'name' in 'self', comparing contents if 'name' is not interned */
+static ks_cint find_slow(ks_shape self, ks_str name) {
+    ks_cint i;
+    for (i = 0; i < self->len; ++i) {
+        if (ks_str_eq(self->names[i], name)) return i;
+    }
+    return -1;
+}
+
+
+/* C-API */
+
+ks_shape ks_shape_new() {
+    ks_shape self = ks_malloc(sizeof(*self));
+
+    self->len = 0;
+    self->names = NULL;
+    self->n_next = 0;
+    self->next = NULL;
+
+    return self;
+}
+
+ks_cint ks_shape_find(ks_shape self, ks_str name) {
+    /* All names in a shape are interned, so an interned string can only match by pointer */
+    ks_cint i;
+    for (i = 0; i < self->len; ++i) {
+        if (self->names[i] == name) return i;
+    }
+    return name->interned ? -1 : find_slow(self, name);
+}
+
+ks_shape ks_shape_add(ks_shape self, ks_str name) {
+    ks_str iname = ks_str_intern(name);
+
+    /* Follow an existing transition */
+    ks_cint i;
+    for (i = 0; i < self->n_next; ++i) {
+        if (self->next[i]->names[self->len] == iname) {
+            KS_DECREF(iname);
+            return self->next[i];
+        }
+    }
+
+    /* Create a new shape, with the names of 'self' and then 'name' */
+    ks_shape res = ks_shape_new();
+    res->len = self->len + 1;
+    res->names = ks_zmalloc(sizeof(*res->names), res->len);
+    for (i = 0; i < self->len; ++i) {
+        KS_INCREF(self->names[i]);
+        res->names[i] = self->names[i];
+    }
+    res->names[self->len] = iname;
+
+    i = self->n_next++;
+    self->next = ks_zrealloc(self->next, sizeof(*self->next), self->n_next);
+    self->next[i] = res;
+
+    return res;
+}
+
+
+ks_dict _kso_slots_todict(kso ob) {
+    struct ks_slots* slots = KSO_SLOTS(ob);
+    ks_dict* attr = (ks_dict*)((ks_uint)ob + ob->type->ob_attr);
+    if (!slots->shape) return *attr;
+
+    /* Move the values into a new dictionary */
+    ks_dict res = ks_dict_new(NULL);
+    ks_cint i;
+    for (i = 0; i < slots->shape->len; ++i) {
+        ks_str k = slots->shape->names[i];
+        ks_dict_set_h(res, (kso)k, KS_STR_HASH(k), slots->vals[i]);
+        KS_DECREF(slots->vals[i]);
+    }
+    ks_free(slots->vals);
+    slots->vals = NULL;
+    slots->shape = NULL;
+
+    *attr = res;
+    return res;
+}
+
+bool _kso_slots_set(kso ob, ks_str name, kso val) {
+    struct ks_slots* slots = KSO_SLOTS(ob);
+    ks_shape shape = slots->shape;
+    if (!shape) return false;
+
+    ks_cint i = ks_shape_find(shape, name);
+    if (i >= 0) {
+        KS_INCREF(val);
+        KS_DECREF(slots->vals[i]);
+        slots->vals[i] = val;
+        return true;
+    }
+
+    if (shape->len >= KS_SHAPE_MAX) {
+        /* Too many attributes, so switch to the dictionary */
+        _kso_slots_todict(ob);
+        return false;
+    }
+
+    /* Grow to the next power of two */
+    i = shape->len;
+    if (i == 0 || (i >= 2 && (i & (i - 1)) == 0)) {
+        slots->vals = ks_zrealloc(slots->vals, sizeof(*slots->vals), i > 0 ? 2 * i : 2);
+    }
+
+    KS_INCREF(val);
+    slots->vals[i] = val;
+    slots->shape = ks_shape_add(shape, name);
+    return true;
+}
+
+void _kso_slots_del(kso ob) {
+    struct ks_slots* slots = KSO_SLOTS(ob);
+    if (slots->shape) {
+        ks_cint i;
+        for (i = 0; i < slots->shape->len; ++i) {
+            KS_DECREF(slots->vals[i]);
+        }
+        ks_free(slots->vals);
+    }
+
+    ks_dict* attr = (ks_dict*)((ks_uint)ob + ob->type->ob_attr);
+    KS_NDECREF(*attr);
+}
@@ -1,4 +1,14 @@
-/* sort.c - sort algorithm
+/* sort.c - sort algorithms
+ *
+ * The default ('ks_sort()') is Timsort, which finds runs that are already sorted (or reversed), extends short
+ *   ones with binary insertion sort, and merges them (switching to galloping, i.e. exponential search, when one
+ *   run keeps winning). So, data which is partially sorted takes far fewer comparisons than a plain mergesort
+ *
+ * Before sorting, the keys are checked to see if they are all of one type (machine-size integers, floats, or
+ *   strings). If so, the value to compare is extracted once, and a specialized comparison is used, instead of
+ *   checking the types of every pair
+ *
+ * SEE: https://github.com/python/cpython/blob/master/Objects/listsort.txt
  *
  * @author: Cade Brown <cade@kscript.org>
  */
@@ -183,8 +193,624 @@ bool ks_sort_merge(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
     return res;
 }
 
-bool ks_sort(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
-    return ks_sort_merge(n, elems, keys, cmpfunc);
+/** Timsort **/
+
+/* Minimum number of consecutive wins before switching to galloping */
+#define S_MIN_GALLOP 7
+
+/* Maximum number of pending runs (enough for 2**64 elements, since run lengths grow faster than Fibonacci) */
+#define S_MAX_RUNS 85
+
+/* Maximum number of items in the buffer kept between calls */
+#define S_CACHE_MAX 8192
+
+/* Item being sorted, which is a key and element, along with the value to compare (for specialized comparisons) */
+struct s_item {
+
+    /* Value extracted from 'key' (depending on the comparison) */
+    union {
+        ks_cint i;
+        double f;
+        ks_uint u;
+    } v;
+
+    /* Key being compared */
+    kso key;
+
+    /* Element being sorted */
+    kso elem;
+
+};
+
+/* State of a sort */
+struct s_state {
+
+    /* Kind of comparison (see 's_lt()') */
+    enum {
+        S_OBJ = 0,
+        S_INT,
+        S_FLOAT,
+        S_STR,
+    } kind;
+
+    /* Custom comparison function (or NULL) */
+    kso cmpfunc;
+
+    /* Current threshold to start galloping */
+    ks_ssize_t min_gallop;
+
+    /* Temporary space for merges (at least half as many items as are being sorted) */
+    struct s_item* tmp;
+
+    /* Stack of pending runs, which have been sorted but not merged */
+    int n_runs;
+    struct {
+        struct s_item* base;
+        ks_ssize_t len;
+    } runs[S_MAX_RUNS];
+
+};
+
+/* Buffer kept between calls, so many small sorts don't allocate
+ * It is taken (i.e. set to NULL) while sorting, so a nested sort (from within a comparison function) allocates
+ *   its own
+ */
+static struct s_item* s_cache = NULL;
+static ks_size_t s_cache_n = 0;
+
+/* Strings, with the first few bytes (big-endian, zero padded) in 'v.u'
+ * Since strings are UTF-8, comparing bytes is the same as comparing characters
+ */
+static int s_lt_str(struct s_item* a, struct s_item* b) {
+    if (a->v.u != b->v.u) return a->v.u < b->v.u;
+
+    ks_str sa = (ks_str)a->key, sb = (ks_str)b->key;
+    ks_size_t n = sa->len_b < sb->len_b ? sa->len_b : sb->len_b;
+    int c = memcmp(sa->data, sb->data, n);
+    return c < 0 || (c == 0 && sa->len_b < sb->len_b);
+}
+
+/* Anything else (which is 'not b <= a') */
+static int s_lt_obj(struct s_state* st, struct s_item* a, struct s_item* b) {
+    bool le;
+    if (!my_le(b->key, a->key, &le, st->cmpfunc)) return -1;
+    return !le;
+}
+
+/* Compute 'a < b', returning 1 if it is, 0 if not, or -1 if an error was thrown
+ * The kind is the same for the whole sort, so the branch is predictable, and the simple comparisons are
+ *   inlined (floats are written as 'not b <= a', to agree with the generic comparison for NaN)
+ */
+static inline int s_lt(struct s_state* st, struct s_item* a, struct s_item* b) {
+    switch (st->kind) {
+        case S_INT: return a->v.i < b->v.i;
+        case S_FLOAT: return !(b->v.f <= a->v.f);
+        case S_STR: return s_lt_str(a, b);
+        default: return s_lt_obj(st, a, b);
+    }
+}
+
+/* Choose the comparison for 'n' items, and extract the values it uses (in a single pass, giving up on the
+ *   first key that doesn't fit)
+ */
+static void s_prepare(struct s_state* st, ks_size_t n, struct s_item* items) {
+    st->kind = S_OBJ;
+    if (st->cmpfunc || n == 0) return;
+
+    ks_type tp = items[0].key->type;
+    ks_size_t i;
+    if (kso_issub(tp, kst_int)) {
+        for (i = 0; i < n; ++i) {
+            kso k = items[i].key;
+            if ((k->type != kst_int && !kso_issub(k->type, kst_int)) || !mpz_fits_slong_p(((ks_int)k)->val)) return;
+            items[i].v.i = mpz_get_si(((ks_int)k)->val);
+        }
+        st->kind = S_INT;
+    } else if (kso_issub(tp, kst_float)) {
+        for (i = 0; i < n; ++i) {
+            kso k = items[i].key;
+            if (k->type != kst_float && !kso_issub(k->type, kst_float)) return;
+            items[i].v.f = ((ks_float)k)->val;
+        }
+        st->kind = S_FLOAT;
+    } else if (kso_issub(tp, kst_str)) {
+        for (i = 0; i < n; ++i) {
+            ks_str k = (ks_str)items[i].key;
+            if (k->type != kst_str && !kso_issub(k->type, kst_str)) return;
+
+            ks_uint u = 0;
+            ks_size_t j;
+            for (j = 0; j < sizeof(u); ++j) {
+                u = (u << 8) | (j < k->len_b ? (unsigned char)k->data[j] : 0);
+            }
+            items[i].v.u = u;
+        }
+        st->kind = S_STR;
+    }
+}
+
+/* Compare 'X < Y', jumping to 'fail' on an error (the result is in 'k') */
+#define S_IFLT(X, Y) if ((k = s_lt(st, (X), (Y))) < 0) goto fail; if (k)
+
+/* Sort '[lo, hi)' with binary insertion sort, given that '[lo, start)' is already sorted */
+static bool s_binarysort(struct s_state* st, struct s_item* lo, struct s_item* hi, struct s_item* start) {
+    int k;
+    if (lo == start) start++;
+    for (; start < hi; ++start) {
+        struct s_item pivot = *start;
+        struct s_item* l = lo, *r = start;
+        do {
+            struct s_item* p = l + ((r - l) >> 1);
+            S_IFLT(&pivot, p) r = p;
+            else l = p + 1;
+        } while (l < r);
+
+        memmove(l + 1, l, sizeof(*l) * (start - l));
+        *l = pivot;
+    }
+    return true;
+fail:
+    return false;
+}
+
+/* Return the length of the run starting at 'lo' (which is reversed in place if it was strictly descending),
+ *   or -1 if an error was thrown
+ */
+static ks_ssize_t s_countrun(struct s_state* st, struct s_item* lo, struct s_item* hi) {
+    int k;
+    if (lo + 1 == hi) return 1;
+
+    ks_ssize_t n = 2;
+    struct s_item* p;
+    S_IFLT(&lo[1], &lo[0]) {
+        /* Strictly descending (so reversing it keeps the sort stable) */
+        for (p = lo + 2; p < hi; ++p, ++n) {
+            S_IFLT(p, p - 1);
+            else break;
+        }
+        struct s_item* a = lo, *b = lo + n - 1;
+        while (a < b) {
+            struct s_item t = *a;
+            *a++ = *b;
+            *b-- = t;
+        }
+    } else {
+        for (p = lo + 2; p < hi; ++p, ++n) {
+            S_IFLT(p, p - 1) break;
+        }
+    }
+    return n;
+fail:
+    return -1;
+}
+
+/* Return the index in sorted 'a' (of length 'n') to insert 'key' at, before any equal items, starting the search
+ *   at 'hint'. Returns -1 if an error was thrown
+ */
+static ks_ssize_t s_gallop_left(struct s_state* st, struct s_item* key, struct s_item* a, ks_ssize_t n, ks_ssize_t hint) {
+    int k;
+    ks_ssize_t ofs = 1, lastofs = 0, maxofs, m;
+    a += hint;
+    S_IFLT(a, key) {
+        /* a[hint] < key, so gallop right until a[hint+lastofs] < key <= a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs) {
+            S_IFLT(a + ofs, key) {
+                lastofs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxofs;
+            } else break;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    } else {
+        /* key <= a[hint], so gallop left until a[hint-ofs] < key <= a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs) {
+            S_IFLT(a - ofs, key) break;
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = maxofs;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        m = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - m;
+    }
+    a -= hint;
+
+    /* Now, a[lastofs] < key <= a[ofs], so binary search within that range */
+    ++lastofs;
+    while (lastofs < ofs) {
+        m = lastofs + ((ofs - lastofs) >> 1);
+        S_IFLT(a + m, key) lastofs = m + 1;
+        else ofs = m;
+    }
+    return ofs;
+fail:
+    return -1;
+}
+
+/* Like 's_gallop_left()', but returns the index after any equal items */
+static ks_ssize_t s_gallop_right(struct s_state* st, struct s_item* key, struct s_item* a, ks_ssize_t n, ks_ssize_t hint) {
+    int k;
+    ks_ssize_t ofs = 1, lastofs = 0, maxofs, m;
+    a += hint;
+    S_IFLT(key, a) {
+        /* key < a[hint], so gallop left until a[hint-ofs] <= key < a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs) {
+            S_IFLT(key, a - ofs) {
+                lastofs = ofs;
+                ofs = (ofs << 1) + 1;
+                if (ofs <= 0) ofs = maxofs;
+            } else break;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        m = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - m;
+    } else {
+        /* a[hint] <= key, so gallop right until a[hint+lastofs] <= key < a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs) {
+            S_IFLT(key, a + ofs) break;
+            lastofs = ofs;
+            ofs = (ofs << 1) + 1;
+            if (ofs <= 0) ofs = maxofs;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    }
+    a -= hint;
+
+    /* Now, a[lastofs] <= key < a[ofs], so binary search within that range */
+    ++lastofs;
+    while (lastofs < ofs) {
+        m = lastofs + ((ofs - lastofs) >> 1);
+        S_IFLT(key, a + m) ofs = m;
+        else lastofs = m + 1;
+    }
+    return ofs;
+fail:
+    return -1;
 }
 
+/* Merge adjacent runs 'pa' and 'pb' (where 'na <= nb'), copying 'pa' to the temporary space
+ * NOTE: 'pa[0]' must belong at the start, and 'pa[na-1]' must belong at the end (after 'pb[nb-1]')
+ */
+static bool s_merge_lo(struct s_state* st, struct s_item* pa, ks_ssize_t na, struct s_item* pb, ks_ssize_t nb) {
+    int k;
+    ks_ssize_t g;
+    struct s_item* dest = pa;
+    bool res = false;
+
+    memcpy(st->tmp, pa, sizeof(*pa) * na);
+    pa = st->tmp;
+
+    *dest++ = *pb++;
+    if (--nb == 0) goto done;
+    if (na == 1) goto copy_b;
+
+    ks_ssize_t min_gallop = st->min_gallop;
+    while (true) {
+        ks_ssize_t acount = 0, bcount = 0;
+
+        /* One at a time, until one run wins consistently */
+        while (true) {
+            S_IFLT(pb, pa) {
+                *dest++ = *pb++;
+                ++bcount;
+                acount = 0;
+                if (--nb == 0) goto done;
+                if (bcount >= min_gallop) break;
+            } else {
+                *dest++ = *pa++;
+                ++acount;
+                bcount = 0;
+                if (--na == 1) goto copy_b;
+                if (acount >= min_gallop) break;
+            }
+        }
+
+        /* Gallop, until neither run is winning consistently */
+        ++min_gallop;
+        do {
+            min_gallop -= min_gallop > 1;
+            st->min_gallop = min_gallop;
+
+            g = s_gallop_right(st, pb, pa, na, 0);
+            if (g < 0) goto fail;
+            acount = g;
+            if (g) {
+                memcpy(dest, pa, sizeof(*pa) * g);
+                dest += g;
+                pa += g;
+                na -= g;
+                if (na == 1) goto copy_b;
+                /* 'na' can only be 0 here if the comparison is inconsistent */
+                if (na == 0) goto done;
+            }
+            *dest++ = *pb++;
+            if (--nb == 0) goto done;
+
+            g = s_gallop_left(st, pa, pb, nb, 0);
+            if (g < 0) goto fail;
+            bcount = g;
+            if (g) {
+                memmove(dest, pb, sizeof(*pb) * g);
+                dest += g;
+                pb += g;
+                nb -= g;
+                if (nb == 0) goto done;
+            }
+            *dest++ = *pa++;
+            if (--na == 1) goto copy_b;
+        } while (acount >= S_MIN_GALLOP || bcount >= S_MIN_GALLOP);
+        ++min_gallop;
+        st->min_gallop = min_gallop;
+    }
+
+done:
+    res = true;
+fail:
+    /* Copy back whatever is left of 'pa' (on an error, so no items are lost) */
+    if (na) memcpy(dest, pa, sizeof(*pa) * na);
+    return res;
+
+copy_b:
+    /* The last item of 'pa' belongs at the end */
+    memmove(dest, pb, sizeof(*pb) * nb);
+    dest[nb] = *pa;
+    return true;
+}
+
+/* Merge adjacent runs 'pa' and 'pb' (where 'na >= nb'), copying 'pb' to the temporary space
+ * NOTE: 'pa[0]' must belong at the start, and 'pa[na-1]' must belong at the end (after 'pb[nb-1]')
+ */
+static bool s_merge_hi(struct s_state* st, struct s_item* pa, ks_ssize_t na, struct s_item* pb, ks_ssize_t nb) {
+    int k;
+    ks_ssize_t g;
+    struct s_item* dest = pb + nb - 1;
+    struct s_item* basea = pa, *baseb = st->tmp;
+    bool res = false;
+
+    memcpy(st->tmp, pb, sizeof(*pb) * nb);
+    pb = st->tmp + nb - 1;
+    pa += na - 1;
+
+    *dest-- = *pa--;
+    if (--na == 0) goto done;
+    if (nb == 1) goto copy_a;
+
+    ks_ssize_t min_gallop = st->min_gallop;
+    while (true) {
+        ks_ssize_t acount = 0, bcount = 0;
+
+        /* One at a time, until one run wins consistently */
+        while (true) {
+            S_IFLT(pb, pa) {
+                *dest-- = *pa--;
+                ++acount;
+                bcount = 0;
+                if (--na == 0) goto done;
+                if (acount >= min_gallop) break;
+            } else {
+                *dest-- = *pb--;
+                ++bcount;
+                acount = 0;
+                if (--nb == 1) goto copy_a;
+                if (bcount >= min_gallop) break;
+            }
+        }
+
+        /* Gallop, until neither run is winning consistently */
+        ++min_gallop;
+        do {
+            min_gallop -= min_gallop > 1;
+            st->min_gallop = min_gallop;
+
+            g = s_gallop_right(st, pb, basea, na, na - 1);
+            if (g < 0) goto fail;
+            g = na - g;
+            acount = g;
+            if (g) {
+                dest -= g;
+                pa -= g;
+                memmove(dest + 1, pa + 1, sizeof(*pa) * g);
+                na -= g;
+                if (na == 0) goto done;
+            }
+            *dest-- = *pb--;
+            if (--nb == 1) goto copy_a;
+
+            g = s_gallop_left(st, pa, baseb, nb, nb - 1);
+            if (g < 0) goto fail;
+            g = nb - g;
+            bcount = g;
+            if (g) {
+                dest -= g;
+                pb -= g;
+                memcpy(dest + 1, pb + 1, sizeof(*pb) * g);
+                nb -= g;
+                if (nb == 1) goto copy_a;
+                /* 'nb' can only be 0 here if the comparison is inconsistent */
+                if (nb == 0) goto done;
+            }
+            *dest-- = *pa--;
+            if (--na == 0) goto done;
+        } while (acount >= S_MIN_GALLOP || bcount >= S_MIN_GALLOP);
+        ++min_gallop;
+        st->min_gallop = min_gallop;
+    }
+
+done:
+    res = true;
+fail:
+    /* Copy back whatever is left of 'pb' (on an error, so no items are lost) */
+    if (nb) memcpy(dest - (nb - 1), baseb, sizeof(*baseb) * nb);
+    return res;
+
+copy_a:
+    /* The first item of 'pb' belongs at the start */
+    dest -= na;
+    pa -= na;
+    memmove(dest + 1, pa + 1, sizeof(*pa) * na);
+    *dest = *pb;
+    return true;
+}
+
+/* Merge the runs at 'i' and 'i+1' on the stack */
+static bool s_merge_at(struct s_state* st, int i) {
+    struct s_item* pa = st->runs[i].base, *pb = st->runs[i + 1].base;
+    ks_ssize_t na = st->runs[i].len, nb = st->runs[i + 1].len;
+
+    st->runs[i].len = na + nb;
+    if (i == st->n_runs - 3) st->runs[i + 1] = st->runs[i + 2];
+    st->n_runs--;
+
+    /* Items at the start of 'pa' that are before 'pb[0]' are already in place */
+    ks_ssize_t g = s_gallop_right(st, pb, pa, na, 0);
+    if (g < 0) return false;
+    pa += g;
+    na -= g;
+    if (na == 0) return true;
+
+    /* Items at the end of 'pb' that are after 'pa[na-1]' are already in place */
+    nb = s_gallop_left(st, pa + na - 1, pb, nb, nb - 1);
+    if (nb <= 0) return nb == 0;
+
+    if (na <= nb) {
+        return s_merge_lo(st, pa, na, pb, nb);
+    } else {
+        return s_merge_hi(st, pa, na, pb, nb);
+    }
+}
+
+/* Merge runs on the stack until the lengths satisfy (for all 'i'):
+ *   len[i-2] > len[i-1] + len[i]
+ *   len[i-1] > len[i]
+ * Which keeps merges balanced, and the stack small
+ */
+static bool s_merge_collapse(struct s_state* st) {
+    while (st->n_runs > 1) {
+        int i = st->n_runs - 2;
+        ks_ssize_t a = i > 1 ? st->runs[i - 2].len : 0, b = i > 0 ? st->runs[i - 1].len : 0;
+        ks_ssize_t c = st->runs[i].len, d = st->runs[i + 1].len;
+        if ((i > 0 && b <= c + d) || (i > 1 && a <= b + c)) {
+            if (b < d) i--;
+        } else if (c > d) {
+            break;
+        }
+        if (!s_merge_at(st, i)) return false;
+    }
+    return true;
+}
+
+/* Merge all remaining runs on the stack */
+static bool s_merge_force(struct s_state* st) {
+    while (st->n_runs > 1) {
+        int i = st->n_runs - 2;
+        if (i > 0 && st->runs[i - 1].len < st->runs[i + 1].len) i--;
+        if (!s_merge_at(st, i)) return false;
+    }
+    return true;
+}
+
+/* Compute the minimum run length, which is in '[32, 64]', such that 'n / minrun' is (close to) a power of 2 */
+static ks_ssize_t s_minrun(ks_ssize_t n) {
+    ks_ssize_t r = 0;
+    while (n >= 64) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+/* Timsort 'n' items */
+static bool s_timsort(struct s_state* st, ks_ssize_t n, struct s_item* items) {
+    ks_ssize_t minrun = s_minrun(n);
+    struct s_item* lo = items, *hi = items + n;
+
+    while (lo < hi) {
+        /* Find the next run, and extend it to 'minrun' if it is short */
+        ks_ssize_t rn = s_countrun(st, lo, hi);
+        if (rn < 0) return false;
+        if (rn < minrun) {
+            ks_ssize_t force = hi - lo <= minrun ? hi - lo : minrun;
+            if (!s_binarysort(st, lo, lo + force, lo + rn)) return false;
+            rn = force;
+        }
+
+        assert(st->n_runs < S_MAX_RUNS);
+        st->runs[st->n_runs].base = lo;
+        st->runs[st->n_runs].len = rn;
+        st->n_runs++;
+        if (!s_merge_collapse(st)) return false;
+
+        lo += rn;
+    }
+
+    return s_merge_force(st);
+}
+
+bool ks_sort_tim(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
+    if (n <= 1) {
+        /* Already sorted (trivially) */
+        return true;
+    }
+
+    /* Take the cached buffer, if it is big enough (the items, and then the temporary space) */
+    ks_size_t sz = n + n / 2 + 1;
+    struct s_item* buf;
+    if (s_cache && s_cache_n >= sz) {
+        buf = s_cache;
+        sz = s_cache_n;
+        s_cache = NULL;
+    } else {
+        buf = ks_malloc(sizeof(*buf) * sz);
+    }
+
+    ks_size_t i;
+    for (i = 0; i < n; ++i) {
+        buf[i].key = keys[i];
+        buf[i].elem = elems[i];
+    }
+
+    struct s_state st;
+    st.cmpfunc = cmpfunc;
+    st.min_gallop = S_MIN_GALLOP;
+    st.tmp = buf + n;
+    st.n_runs = 0;
+    s_prepare(&st, n, buf);
+
+    /* Even if there was an error, the items are still a permutation of the originals */
+    bool res = s_timsort(&st, n, buf);
+
+    for (i = 0; i < n; ++i) {
+        elems[i] = buf[i].elem;
+    }
+    if (keys != elems) {
+        for (i = 0; i < n; ++i) {
+            keys[i] = buf[i].key;
+        }
+    }
+
+    /* Keep the buffer for the next call, unless it is too large or the cache is bigger */
+    if (sz <= S_CACHE_MAX && (!s_cache || s_cache_n < sz)) {
+        if (s_cache) ks_free(s_cache);
+        s_cache = buf;
+        s_cache_n = sz;
+    } else {
+        ks_free(buf);
+    }
+
+    return res;
+}
+
+bool ks_sort(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
+    return ks_sort_tim(n, elems, keys, cmpfunc);
+}
 
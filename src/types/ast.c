@@ -18,13 +18,23 @@
 /* Enum of the kinds of ASTs */
 static ks_type E_kind = NULL;
 
+/* Arena that new ASTs are allocated in, or NULL */
+static ks_arena cur_arena = NULL;
+
 
 /* C-API */
 
 ks_ast ks_ast_new(int kind, int n_args, ks_ast* args, kso val, ks_tok tok) {
     if (!val) val = KSO_NONE;
 
-    ks_ast self = KSO_NEW(ks_ast, kst_ast);
+    ks_ast self;
+    if (cur_arena) {
+        self = (ks_ast)_kso_init(kst_ast, ks_arena_alloc(cur_arena, sizeof(struct ks_ast_s)));
+        self->arena = cur_arena;
+    } else {
+        self = KSO_NEW(ks_ast, kst_ast);
+        self->arena = NULL;
+    }
 
     self->kind = kind;
 
@@ -53,6 +63,12 @@ ks_ast ks_ast_newn(int kind, int n_args, ks_ast* args, kso val, ks_tok tok) {
 
     return res;
 }
+ks_arena ks_ast_arena(ks_arena arena) {
+    ks_arena res = cur_arena;
+    cur_arena = arena;
+    return res;
+}
+
 bool ks_ast_is_expr(int kind) {
     if (kind == KS_AST_CONST || kind == KS_AST_NAME) return true;
     if (KS_AST_BOP__FIRST <= kind && kind <= KS_AST_BOP__LAST) return true;
@@ -85,7 +101,13 @@ static KS_TFUNC(T, free) {
     KS_DECREF(self->args);
     KS_DECREF(self->val);
 
-    KSO_DEL(self);
+    if (self->arena) {
+        ks_arena arena = self->arena;
+        _kso_fini((kso)self);
+        ks_arena_release(arena);
+    } else {
+        KSO_DEL(self);
+    }
 
     return KSO_NONE;
 }
@@ -0,0 +1,578 @@
+/* types/bytearray.c - 'bytearray' type
+ *
+ * A 'bytearray' is a mutable sequence of bytes. Space is allocated in powers of two, so appending is
+ *   amortized O(1)
+ *
+ * Slicing a 'bytearray' (with a step of 1) doesn't copy anything. Instead, the result is a view, which shares
+ *   the data of the original, so modifying either is seen by both. An array can't be resized while it has
+ *   views (since that may move its data), but its contents can still be modified. Views themselves can't be
+ *   resized at all
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+#define T_NAME "bytearray"
+#define TI_NAME "bytearray.__iter"
+
+
+/* Internals */
+
+/* Retrieve the contents of a 'bytes' or 'bytearray', or return false if 'ob' is neither (without throwing) */
+static bool getbuf(kso ob, ks_size_t* len_b, const unsigned char** data) {
+    if (kso_issub(ob->type, kst_bytearray)) {
+        *len_b = ((ks_bytearray)ob)->len_b;
+        *data = ((ks_bytearray)ob)->data;
+        return true;
+    } else if (kso_issub(ob->type, kst_bytes)) {
+        *len_b = ((ks_bytes)ob)->len_b;
+        *data = ((ks_bytes)ob)->data;
+        return true;
+    }
+    return false;
+}
+
+/* Convert 'ob' to a byte value, or throw an error */
+static bool getbyte(kso ob, unsigned char* out) {
+    ks_cint v;
+    if (!kso_get_ci(ob, &v)) return false;
+    if (v < 0 || v > 255) {
+        KS_THROW(kst_ValError, "Byte values must be in range(256), but got %l", v);
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+/* Check whether 'self' can be resized, or throw an error */
+static bool can_resize(ks_bytearray self) {
+    if (self->base) {
+        KS_THROW(kst_Error, "Cannot resize a view of a '%T'", self);
+        return false;
+    } else if (self->n_views > 0) {
+        KS_THROW(kst_Error, "Cannot resize a '%T' while it has views", self);
+        return false;
+    }
+    return true;
+}
+
+/* Export the buffer of a 'bytearray' (see 'ks_type->ob_buffer'), which holds a view so that the data can't move
+ *   while the buffer is in use
+ */
+static bool export_buf(kso ob, struct ks_buffer* buf) {
+    ks_bytearray self = (ks_bytearray)ob;
+    ks_bytearray view = ks_bytearray_view(self, 0, self->len_b);
+    ks_buffer_bytes(buf, (kso)view, view->len_b, view->data, false);
+    KS_DECREF(view);
+    return true;
+}
+
+/* Replace the bytes '[pos, pos + len_old)' of 'self' with 'len_b' bytes of 'data' (which may be within 'self') */
+static bool ba_splice(ks_bytearray self, ks_size_t pos, ks_size_t len_old, ks_size_t len_b, const unsigned char* data) {
+    if (len_b == len_old) {
+        memmove(self->data + pos, data, len_b);
+        return true;
+    }
+    if (!can_resize(self)) return false;
+
+    /* Copy first, in case 'data' is within 'self' */
+    unsigned char* tmp = ks_malloc(len_b);
+    memcpy(tmp, data, len_b);
+
+    ks_size_t len_tail = self->len_b - pos - len_old;
+    if (!ks_bytearray_resize(self, self->len_b - len_old + len_b)) {
+        ks_free(tmp);
+        return false;
+    }
+    memmove(self->data + pos + len_b, self->data + pos + len_old, len_tail);
+    memcpy(self->data + pos, tmp, len_b);
+
+    ks_free(tmp);
+    return true;
+}
+
+
+/* C-API */
+
+ks_bytearray ks_bytearray_newt(ks_type tp, ks_ssize_t len_b, const void* data) {
+    ks_bytearray self = KSO_NEW(ks_bytearray, tp);
+
+    self->len_b = len_b;
+    self->max_len_b = len_b;
+    self->data = ks_malloc(len_b > 0 ? len_b : 1);
+    if (data) {
+        memcpy(self->data, data, len_b);
+    } else {
+        memset(self->data, 0, len_b);
+    }
+
+    self->base = NULL;
+    self->n_views = 0;
+
+    return self;
+}
+
+ks_bytearray ks_bytearray_new(ks_ssize_t len_b, const void* data) {
+    return ks_bytearray_newt(kst_bytearray, len_b, data);
+}
+
+ks_bytearray ks_bytearray_view(ks_bytearray self, ks_ssize_t pos, ks_ssize_t len_b) {
+    assert(pos >= 0 && pos + len_b <= self->len_b);
+
+    /* Views always refer to the array that owns the data */
+    ks_bytearray base = self->base ? self->base : self;
+    ks_bytearray res = KSO_NEW(ks_bytearray, kst_bytearray);
+
+    res->len_b = len_b;
+    res->max_len_b = 0;
+    res->data = self->data + pos;
+
+    KS_INCREF(base);
+    res->base = base;
+    base->n_views++;
+    res->n_views = 0;
+
+    return res;
+}
+
+bool ks_bytearray_resize(ks_bytearray self, ks_ssize_t len_b) {
+    if (len_b == self->len_b) return true;
+    if (!can_resize(self)) return false;
+
+    if (len_b > self->max_len_b) {
+        self->max_len_b = ks_nextsize(self->max_len_b, len_b);
+        self->data = ks_realloc(self->data, self->max_len_b);
+    }
+    if (len_b > self->len_b) {
+        memset(self->data + self->len_b, 0, len_b - self->len_b);
+    }
+
+    self->len_b = len_b;
+    return true;
+}
+
+bool ks_bytearray_push(ks_bytearray self, ks_ssize_t len_b, const void* data) {
+    /* 'data' may be within 'self' (i.e. 'x.extend(x)'), which may move when it is resized */
+    const unsigned char* p = data;
+    bool inside = p >= self->data && p < self->data + self->len_b;
+    ks_size_t off = inside ? p - self->data : 0, pos = self->len_b;
+    if (!ks_bytearray_resize(self, pos + len_b)) return false;
+
+    memcpy(self->data + pos, inside ? self->data + off : p, len_b);
+    return true;
+}
+
+
+/* Type Functions */
+
+static KS_TFUNC(T, free) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    if (self->base) {
+        self->base->n_views--;
+        KS_DECREF(self->base);
+    } else {
+        ks_free(self->data);
+    }
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    kso obj = KSO_NONE;
+    KS_ARGS("tp:* ?obj", &tp, kst_type, &obj);
+
+    ks_size_t len_b;
+    const unsigned char* data;
+    if (obj == KSO_NONE) {
+        return (kso)ks_bytearray_newt(tp, 0, NULL);
+    } else if (getbuf(obj, &len_b, &data)) {
+        return (kso)ks_bytearray_newt(tp, len_b, data);
+    } else if (kso_issub(obj->type, kst_str)) {
+        return (kso)ks_bytearray_newt(tp, ((ks_str)obj)->len_b, ((ks_str)obj)->data);
+    } else if (kso_is_int(obj)) {
+        ks_cint sz;
+        if (!kso_get_ci(obj, &sz)) return NULL;
+        if (sz < 0) {
+            KS_THROW(kst_SizeError, "Size must be non-negative, but got %l", sz);
+            return NULL;
+        }
+        return (kso)ks_bytearray_newt(tp, sz, NULL);
+    }
+
+    /* Iterable of byte values */
+    ks_bytearray self = ks_bytearray_newt(tp, 0, NULL);
+    ks_cit cit = ks_cit_make(obj);
+    kso ob;
+    while ((ob = ks_cit_next(&cit)) != NULL) {
+        unsigned char c;
+        if (!getbyte(ob, &c)) {
+            cit.exc = true;
+        } else {
+            ks_bytearray_push(self, 1, &c);
+        }
+        KS_DECREF(ob);
+    }
+    ks_cit_done(&cit);
+    if (cit.exc) {
+        KS_DECREF(self);
+        return NULL;
+    }
+
+    return (kso)self;
+}
+
+static KS_TFUNC(T, str) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    ks_bytes b = ks_bytes_new(self->len_b, (const char*)self->data);
+    ks_str res = ks_fmt("%T(%R)", self, b);
+    KS_DECREF(b);
+    return (kso)res;
+}
+
+static KS_TFUNC(T, bytes) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return (kso)ks_bytes_new(self->len_b, (const char*)self->data);
+}
+
+static KS_TFUNC(T, bool) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return KSO_BOOL(self->len_b != 0);
+}
+
+static KS_TFUNC(T, len) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return (kso)ks_int_new(self->len_b);
+}
+
+static KS_TFUNC(T, eq) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    ks_size_t Ll, Rl;
+    const unsigned char* Ld, *Rd;
+    if (getbuf(L, &Ll, &Ld) && getbuf(R, &Rl, &Rd)) {
+        return KSO_BOOL(Ll == Rl && memcmp(Ld, Rd, Ll) == 0);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, add) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    ks_size_t Ll, Rl;
+    const unsigned char* Ld, *Rd;
+    if (getbuf(L, &Ll, &Ld) && getbuf(R, &Rl, &Rd)) {
+        ks_bytearray res = ks_bytearray_new(Ll + Rl, NULL);
+        memcpy(res->data, Ld, Ll);
+        memcpy(res->data + Ll, Rd, Rl);
+        return (kso)res;
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, contains) {
+    ks_bytearray self;
+    kso elem;
+    KS_ARGS("self:* elem", &self, kst_bytearray, &elem);
+
+    ks_size_t len_b;
+    const unsigned char* data;
+    if (getbuf(elem, &len_b, &data)) {
+        /* Like 'str', the empty subsequence is never found */
+        return KSO_BOOL(len_b > 0 && ks_memfind(self->len_b, (const char*)self->data, len_b, (const char*)data) >= 0);
+    }
+
+    unsigned char c;
+    if (!getbyte(elem, &c)) return NULL;
+    return KSO_BOOL(memchr(self->data, c, self->len_b) != NULL);
+}
+
+static KS_TFUNC(T, getelem) {
+    ks_bytearray self;
+    kso idx;
+    KS_ARGS("self:* idx", &self, kst_bytearray, &idx);
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+
+        if (delta == 1) {
+            return (kso)ks_bytearray_view(self, first, last - first);
+        } else {
+            /* Other steps can't be represented by a view, so copy them */
+            ks_bytearray res = ks_bytearray_new(0, NULL);
+            ks_cint i;
+            for (i = first; i != last; i += delta) {
+                ks_bytearray_push(res, 1, self->data + i);
+            }
+            return (kso)res;
+        }
+    }
+
+    ks_cint i;
+    if (!kso_get_ci(idx, &i)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+
+    return (kso)ks_int_new(self->data[i]);
+}
+
+static KS_TFUNC(T, setelem) {
+    ks_bytearray self;
+    kso idx, val;
+    KS_ARGS("self:* idx val", &self, kst_bytearray, &idx, &val);
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+
+        ks_size_t len_b;
+        const unsigned char* data;
+        if (!getbuf(val, &len_b, &data)) {
+            KS_THROW(kst_TypeError, "Can only assign 'bytes' or 'bytearray' to a slice of a '%T', not '%T'", self, val);
+            return NULL;
+        }
+
+        if (delta == 1) {
+            if (!ba_splice(self, first, last - first, len_b, data)) return NULL;
+        } else {
+            ks_cint i, n = (last - first) / delta;
+            if (n != len_b) {
+                KS_THROW(kst_SizeError, "Attempt to assign %l bytes to a slice of size %l", (ks_cint)len_b, n);
+                return NULL;
+            }
+            unsigned char* tmp = ks_malloc(len_b > 0 ? len_b : 1);
+            memcpy(tmp, data, len_b);
+            for (i = 0; i < n; ++i) {
+                self->data[first + i * delta] = tmp[i];
+            }
+            ks_free(tmp);
+        }
+        return KSO_NONE;
+    }
+
+    ks_cint i;
+    unsigned char c;
+    if (!kso_get_ci(idx, &i) || !getbyte(val, &c)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+
+    self->data[i] = c;
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, append) {
+    ks_bytearray self;
+    kso val;
+    KS_ARGS("self:* val", &self, kst_bytearray, &val);
+
+    unsigned char c;
+    if (!getbyte(val, &c) || !ks_bytearray_push(self, 1, &c)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, extend) {
+    ks_bytearray self;
+    kso objs;
+    KS_ARGS("self:* objs", &self, kst_bytearray, &objs);
+
+    ks_size_t len_b;
+    const unsigned char* data;
+    if (getbuf(objs, &len_b, &data)) {
+        if (!ks_bytearray_push(self, len_b, data)) return NULL;
+        return KSO_NONE;
+    }
+
+    ks_bytearray tmp = (ks_bytearray)kso_call((kso)kst_bytearray, 1, &objs);
+    if (!tmp) return NULL;
+    bool ok = ks_bytearray_push(self, tmp->len_b, tmp->data);
+    KS_DECREF(tmp);
+    if (!ok) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, clear) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    if (!ks_bytearray_resize(self, 0)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, copy) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return (kso)ks_bytearray_new(self->len_b, self->data);
+}
+
+static KS_TFUNC(T, decode) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    ks_ssize_t bad = ks_utf8_check(self->len_b, (const char*)self->data);
+    if (bad >= 0) {
+        KS_THROW(kst_ValError, "Invalid UTF-8 in bytearray, at index %l", (ks_cint)bad);
+        return NULL;
+    }
+
+    return (kso)ks_str_new(self->len_b, (const char*)self->data);
+}
+
+/* Clamp '[start, end)' to the bounds of 'self' */
+static void clamp(ks_bytearray self, ks_cint* start, ks_cint* end) {
+    if (*start < 0) *start = 0;
+    if (*start > self->len_b) *start = self->len_b;
+    if (*end > self->len_b) *end = self->len_b;
+    if (*end < *start) *end = *start;
+}
+
+static KS_TFUNC(T, find) {
+    ks_bytearray self;
+    kso sub;
+    ks_cint start = 0, end = KS_CINT_MAX;
+    KS_ARGS("self:* sub ?start:cint ?end:cint", &self, kst_bytearray, &sub, &start, &end);
+
+    ks_size_t len_b;
+    const unsigned char* data;
+    if (!getbuf(sub, &len_b, &data)) {
+        KS_THROW(kst_TypeError, "Expected 'bytes' or 'bytearray' to search for, but got '%T' object", sub);
+        return NULL;
+    }
+
+    clamp(self, &start, &end);
+    if (len_b == 0) return (kso)ks_int_new(-1);
+    ks_ssize_t res = ks_memfind(end - start, (const char*)self->data + start, len_b, (const char*)data);
+    return (kso)ks_int_new(res < 0 ? -1 : start + res);
+}
+
+static KS_TFUNC(T, count) {
+    ks_bytearray self;
+    kso sub;
+    ks_cint start = 0, end = KS_CINT_MAX;
+    KS_ARGS("self:* sub ?start:cint ?end:cint", &self, kst_bytearray, &sub, &start, &end);
+
+    ks_size_t len_b;
+    const unsigned char* data;
+    if (!getbuf(sub, &len_b, &data)) {
+        KS_THROW(kst_TypeError, "Expected 'bytes' or 'bytearray' to search for, but got '%T' object", sub);
+        return NULL;
+    }
+
+    clamp(self, &start, &end);
+    if (len_b == 0) return (kso)ks_int_new(0);
+    return (kso)ks_int_new(ks_memcount(end - start, (const char*)self->data + start, len_b, (const char*)data));
+}
+
+
+/** Iterator **/
+
+static KS_TFUNC(TI, free) {
+    ks_bytearray_iter self;
+    KS_ARGS("self:*", &self, kst_bytearray_iter);
+
+    KS_DECREF(self->of);
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TI, new) {
+    ks_type tp;
+    ks_bytearray of;
+    KS_ARGS("tp:* of:*", &tp, kst_type, &of, kst_bytearray);
+
+    ks_bytearray_iter self = KSO_NEW(ks_bytearray_iter, tp);
+
+    KS_INCREF(of);
+    self->of = of;
+
+    self->pos = 0;
+
+    return (kso)self;
+}
+
+static bool TI_next(kso ob, kso* res) {
+    ks_bytearray_iter self = (ks_bytearray_iter)ob;
+
+    /* The array may have been resized while iterating */
+    *res = self->pos < self->of->len_b ? (kso)ks_int_new(self->of->data[self->pos++]) : NULL;
+    return true;
+}
+
+static KS_TFUNC(TI, next) {
+    ks_bytearray_iter self;
+    KS_ARGS("self:*", &self, kst_bytearray_iter);
+
+    return kso_next_f(TI_next, (kso)self);
+}
+
+
+/* Export */
+
+static struct ks_type_s tp;
+ks_type kst_bytearray = &tp;
+
+static struct ks_type_s tp_iter;
+ks_type kst_bytearray_iter = &tp_iter;
+
+void _ksi_bytearray() {
+    _ksinit(kst_bytearray_iter, kst_object, TI_NAME, sizeof(struct ks_bytearray_iter_s), -1, "", KS_IKV(
+        {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
+        {"__next",               ksf_wrap(TI_next_, TI_NAME ".__next(self)", "")},
+    ));
+    kst_bytearray_iter->ob_next = TI_next;
+
+    _ksinit(kst_bytearray, kst_object, T_NAME, sizeof(struct ks_bytearray_s), -1, "Sequence of bytes ('int' in range(256)), which is mutable\n\n    Slicing (with a step of 1) creates a view, which shares the data of the original instead of copying it. An array can't be resized while it has views, but its contents can be modified (which is seen through the views)", KS_IKV(
+        {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj=none)", "")},
+        {"__repr",               ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
+        {"__str",                ksf_wrap(T_str_, T_NAME ".__str(self)", "")},
+        {"__bytes",              ksf_wrap(T_bytes_, T_NAME ".__bytes(self)", "")},
+        {"__bool",               ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
+        {"__eq",                 ksf_wrap(T_eq_, T_NAME ".__eq(L, R)", "")},
+        {"__add",                ksf_wrap(T_add_, T_NAME ".__add(L, R)", "")},
+        {"__contains",           ksf_wrap(T_contains_, T_NAME ".__contains(self, elem)", "")},
+        {"__getelem",            ksf_wrap(T_getelem_, T_NAME ".__getelem(self, idx)", "")},
+        {"__setelem",            ksf_wrap(T_setelem_, T_NAME ".__setelem(self, idx, val)", "")},
+        {"__iter",               KS_NEWREF(kst_bytearray_iter)},
+
+        {"append",               ksf_wrap(T_append_, T_NAME ".append(self, val)", "Append a byte value to the end")},
+        {"extend",               ksf_wrap(T_extend_, T_NAME ".extend(self, objs)", "Append the bytes of 'objs' (a 'bytes', 'bytearray', or iterable of byte values) to the end")},
+        {"clear",                ksf_wrap(T_clear_, T_NAME ".clear(self)", "Remove all bytes")},
+        {"copy",                 ksf_wrap(T_copy_, T_NAME ".copy(self)", "Return a copy, which does not share data with 'self'")},
+        {"decode",               ksf_wrap(T_decode_, T_NAME ".decode(self)", "Decode into a string")},
+        {"find",                 ksf_wrap(T_find_, T_NAME ".find(self, sub, start=none, end=none)", "Find a subsequence within 'self[start:end]', returning its index (or -1 if it was not found)")},
+        {"count",                ksf_wrap(T_count_, T_NAME ".count(self, sub, start=none, end=none)", "Count the non-overlapping occurrences of a subsequence within 'self[start:end]' (an empty subsequence is never found, like with 'find()', so it counts 0)")},
+    ));
+
+    kst_bytearray->i__hash = NULL;
+    kst_bytearray->ob_buffer = export_buf;
+}
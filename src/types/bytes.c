@@ -16,7 +16,7 @@ ks_bytes ks_bytes_newnt(ks_type tp, ks_ssize_t len_b, char* data) {
     
     self->len_b = len_b;
     self->data = data;
-    self->v_hash = ks_hash_bytes(len_b, data);
+    self->v_hash = 0;
 
     return self;
 }
@@ -38,7 +38,7 @@ ks_bytes ks_bytes_newn(ks_ssize_t len_b, char* data) {
     
     self->len_b = len_b;
     self->data = data;
-    self->v_hash = ks_hash_bytes(len_b, data);
+    self->v_hash = 0;
 
     return self;
 }
@@ -48,6 +48,18 @@ ks_bytes ks_bytes_newo(ks_type tp, kso obj) {
 
     ks_bytes self = NULL;
 
+    if (obj->type->ob_buffer != NULL) {
+        /* Copy the memory directly, if it is dense */
+        struct ks_buffer buf;
+        if (!ks_buffer_get(obj, &buf, false)) return NULL;
+        if (ks_buffer_contig(&buf)) {
+            self = ks_bytes_newt(tp, buf.len_b, buf.data);
+            ks_buffer_release(&buf);
+            return self;
+        }
+        ks_buffer_release(&buf);
+    }
+
     if (obj->type->i__bytes != NULL) {
         return (ks_bytes)kso_call(obj->type->i__bytes, 1, &obj);
     } else if (kso_issub(obj->type, kst_str)) {
@@ -59,6 +71,14 @@ ks_bytes ks_bytes_newo(ks_type tp, kso obj) {
 }
 
 
+/* Export the buffer of a 'bytes' object (see 'ks_type->ob_buffer') */
+static bool export_buf(kso ob, struct ks_buffer* buf) {
+    ks_bytes self = (ks_bytes)ob;
+    ks_buffer_bytes(buf, ob, self->len_b, self->data, true);
+    return true;
+}
+
+
 /* Type Functions */
 
 static KS_TFUNC(T, free) {
@@ -92,8 +112,13 @@ static KS_TFUNC(T, decode) {
     KS_ARGS("self:*", &self, kst_bytes);
 
     /* TODO; other encodings */
+    ks_ssize_t bad = ks_utf8_check(self->len_b, (const char*)self->data);
+    if (bad >= 0) {
+        KS_THROW(kst_ValError, "Invalid UTF-8 in bytes, at index %l", (ks_cint)bad);
+        return NULL;
+    }
 
-    return (kso)ks_str_new(self->len_b, self->data);
+    return (kso)ks_str_new(self->len_b, (const char*)self->data);
 }
 
 
@@ -111,6 +136,78 @@ static KS_TFUNC(T, len) {
     return (kso)ks_int_new(self->len_b);
 }
 
+static KS_TFUNC(T, hash) {
+    ks_bytes self;
+    KS_ARGS("self:*", &self, kst_bytes);
+
+    if (!self->v_hash) self->v_hash = ks_hash_bytes(self->len_b, self->data);
+    return (kso)ks_int_newu(self->v_hash);
+}
+
+static KS_TFUNC(T, eq) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    if (kso_issub(L->type, kst_bytes) && kso_issub(R->type, kst_bytes)) {
+        ks_bytes Lb = (ks_bytes)L, Rb = (ks_bytes)R;
+        return KSO_BOOL(Lb->len_b == Rb->len_b && memcmp(Lb->data, Rb->data, Lb->len_b) == 0);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, add) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    if (kso_issub(L->type, kst_bytes) && kso_issub(R->type, kst_bytes)) {
+        ks_bytes Lb = (ks_bytes)L, Rb = (ks_bytes)R;
+        char* data = ks_malloc(Lb->len_b + Rb->len_b);
+        memcpy(data, Lb->data, Lb->len_b);
+        memcpy(data + Lb->len_b, Rb->data, Rb->len_b);
+        return (kso)ks_bytes_newn(Lb->len_b + Rb->len_b, data);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+/* Clamp '[start, end)' to the bounds of 'self' */
+static void clamp(ks_bytes self, ks_cint* start, ks_cint* end) {
+    if (*start < 0) *start = 0;
+    if (*start > self->len_b) *start = self->len_b;
+    if (*end > self->len_b) *end = self->len_b;
+    if (*end < *start) *end = *start;
+}
+
+static KS_TFUNC(T, contains) {
+    ks_bytes self, sub;
+    KS_ARGS("self:* sub:*", &self, kst_bytes, &sub, kst_bytes);
+
+    /* Like 'str', the empty subsequence is never found */
+    return KSO_BOOL(sub->len_b > 0 && ks_memfind(self->len_b, (char*)self->data, sub->len_b, (char*)sub->data) >= 0);
+}
+
+static KS_TFUNC(T, find) {
+    ks_bytes self, sub;
+    ks_cint start = 0, end = KS_CINT_MAX;
+    KS_ARGS("self:* sub:* ?start:cint ?end:cint", &self, kst_bytes, &sub, kst_bytes, &start, &end);
+
+    clamp(self, &start, &end);
+    if (sub->len_b == 0) return (kso)ks_int_new(-1);
+    ks_ssize_t res = ks_memfind(end - start, (char*)self->data + start, sub->len_b, (char*)sub->data);
+    return (kso)ks_int_new(res < 0 ? -1 : start + res);
+}
+
+static KS_TFUNC(T, count) {
+    ks_bytes self, sub;
+    ks_cint start = 0, end = KS_CINT_MAX;
+    KS_ARGS("self:* sub:* ?start:cint ?end:cint", &self, kst_bytes, &sub, kst_bytes, &start, &end);
+
+    clamp(self, &start, &end);
+    if (sub->len_b == 0) return (kso)ks_int_new(0);
+    return (kso)ks_int_new(ks_memcount(end - start, (char*)self->data + start, sub->len_b, (char*)sub->data));
+}
+
 /* Export */
 
 static struct ks_type_s tp;
@@ -122,6 +219,14 @@ void _ksi_bytes() {
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj)", "")},
         {"__bool",               ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
         {"__len",                ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
+        {"__hash",               ksf_wrap(T_hash_, T_NAME ".__hash(self)", "")},
+        {"__eq",                 ksf_wrap(T_eq_, T_NAME ".__eq(L, R)", "")},
+        {"__add",                ksf_wrap(T_add_, T_NAME ".__add(L, R)", "")},
+        {"__contains",           ksf_wrap(T_contains_, T_NAME ".__contains(self, sub)", "")},
+
         {"decode",               ksf_wrap(T_decode_, T_NAME ".decode(self)", "Decode into a string")},
+        {"find",                 ksf_wrap(T_find_, T_NAME ".find(self, sub, start=none, end=none)", "Find a subsequence within 'self[start:end]', returning its index (or -1 if it was not found)")},
+        {"count",                ksf_wrap(T_count_, T_NAME ".count(self, sub, start=none, end=none)", "Count the non-overlapping occurrences of a subsequence within 'self[start:end]' (an empty subsequence is never found, like with 'find()', so it counts 0)")},
     ));
+    kst_bytes->ob_buffer = export_buf;
 }
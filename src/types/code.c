@@ -9,6 +9,19 @@
 #define T_NAME "code"
 
 
+/* Internals */
+
+/* Return whether 'self' looks like an identifier (short, and only ASCII letters, digits, and '_') */
+static bool is_name(ks_str self) {
+    if (self->len_b == 0 || self->len_b > 64) return false;
+    ks_size_t i;
+    for (i = 0; i < self->len_b; ++i) {
+        char c = self->data[i];
+        if (!(c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) return false;
+    }
+    return true;
+}
+
 
 /* C-API */
 
@@ -27,6 +40,7 @@ ks_code ks_code_new(ks_str fname, ks_str src) {
     self->vc_map = ks_dict_new(NULL);
 
     self->bc = ksio_BytesIO_new();
+    self->perf_tramp = NULL;
 
     return self;
 }
@@ -49,40 +63,63 @@ ks_code ks_code_from(ks_code from) {
     self->vc_map = from->vc_map;
 
     self->bc = ksio_BytesIO_new();
+    self->perf_tramp = NULL;
 
     return self;
 }
 
 int ks_code_addconst(ks_code self, kso ob) {
-    int i;
-    for (i = 0; i < self->vc->len; ++i) {
-        kso v = self->vc->elems[i];
-
-        /* Determine whether the objects are equal in both type and value 
-         * This is neccessary because we don't want 'true' to map to '1', since
-         *   they are technically different
-         */
-        bool eq = ob == v;
-        if (!eq) {
-            eq = ob->type == v->type;
-            if (eq) {
+    /* Constants are looked up in 'vc_map' by both type and value, since we don't want 'true' to map to '1', even
+     *   though they compare equal
+     */
+    ks_tuple key = ks_tuple_new(2, (kso[]){ (kso)ob->type, ob });
+    ks_hash_t hash;
+    bool hashed = kso_hash((kso)key, &hash);
+    ks_cint i;
+    if (hashed) {
+        kso idx = ks_dict_get_ih(self->vc_map, (kso)key, hash);
+        if (idx) {
+            kso_get_ci(idx, &i);
+            KS_DECREF(idx);
+            KS_DECREF(key);
+            return i;
+        }
+    }
+    kso_catch_ignore();
+
+    if (!hashed) {
+        /* Unhashable constants are compared against every constant */
+        for (i = 0; i < self->vc->len; ++i) {
+            kso v = self->vc->elems[i];
+            bool eq = ob == v;
+            if (!eq && ob->type == v->type) {
                 if (!kso_eq(v, ob, &eq)) {
                     kso_catch_ignore();
                     eq = false;
                 }
             }
-        }
-
-        if (eq) {
-            /* Found a match */
-            return i;
+            if (eq) {
+                KS_DECREF(key);
+                return i;
+            }
         }
     }
 
-
     /* Not found, so push it and return the last index */
     i = self->vc->len;
-    ks_list_push(self->vc, ob);
+    if (ob->type == kst_str && is_name((ks_str)ob)) {
+        /* Name-like literals are likely to be used as keys, so intern them */
+        ks_list_pushu(self->vc, (kso)ks_str_intern((ks_str)ob));
+    } else {
+        ks_list_push(self->vc, ob);
+    }
+
+    if (hashed) {
+        ks_int idx = ks_int_new(i);
+        if (!ks_dict_set_h(self->vc_map, (kso)key, hash, (kso)idx)) kso_catch_ignore();
+        KS_DECREF(idx);
+    }
+    KS_DECREF(key);
 
     return i;
 }
@@ -146,6 +183,88 @@ bool ks_code_get_meta(ks_code self, int offset, struct ks_code_meta* meta) {
 }
 
 
+const char* ks_code_opname(int op) {
+    switch (op) {
+        #define OP(_o) case _o: return #_o + 4;
+        OP(KSB_NOOP)
+        OP(KSB_PUSH)
+        OP(KSB_POPU)
+        OP(KSB_DUP)
+        OP(KSB_DUPI)
+        OP(KSB_DUPN)
+        OP(KSB_RCR)
+        OP(KSB_LOAD)
+        OP(KSB_STORE)
+        OP(KSB_ASSV)
+        OP(KSB_ASSM)
+        OP(KSB_GETATTR)
+        OP(KSB_SETATTR)
+        OP(KSB_GETELEMS)
+        OP(KSB_SETELEMS)
+        OP(KSB_CALL)
+        OP(KSB_CALLV)
+        OP(KSB_SLICE)
+        OP(KSB_LIST)
+        OP(KSB_LIST_PUSHN)
+        OP(KSB_LIST_PUSHI)
+        OP(KSB_TUPLE)
+        OP(KSB_TUPLE_PUSHN)
+        OP(KSB_TUPLE_PUSHI)
+        OP(KSB_SET)
+        OP(KSB_SET_PUSHN)
+        OP(KSB_SET_PUSHI)
+        OP(KSB_DICT)
+        OP(KSB_DICT_PUSHN)
+        OP(KSB_DICT_PUSHI)
+        OP(KSB_FUNC)
+        OP(KSB_FUNC_DEFA)
+        OP(KSB_TYPE)
+        OP(KSB_JMP)
+        OP(KSB_JMPT)
+        OP(KSB_JMPF)
+        OP(KSB_RET)
+        OP(KSB_THROW)
+        OP(KSB_ASSERT)
+        OP(KSB_FOR_START)
+        OP(KSB_FOR_NEXTT)
+        OP(KSB_FOR_NEXTF)
+        OP(KSB_TRY_START)
+        OP(KSB_TRY_CATCH)
+        OP(KSB_TRY_CATCH_ALL)
+        OP(KSB_TRY_END)
+        OP(KSB_FINALLY_END)
+        OP(KSB_IMPORT)
+        OP(KSB_BOP_IN)
+        OP(KSB_BOP_EEQ)
+        OP(KSB_BOP_EQ)
+        OP(KSB_BOP_NE)
+        OP(KSB_BOP_LT)
+        OP(KSB_BOP_LE)
+        OP(KSB_BOP_GT)
+        OP(KSB_BOP_GE)
+        OP(KSB_BOP_IOR)
+        OP(KSB_BOP_XOR)
+        OP(KSB_BOP_AND)
+        OP(KSB_BOP_LSH)
+        OP(KSB_BOP_RSH)
+        OP(KSB_BOP_ADD)
+        OP(KSB_BOP_SUB)
+        OP(KSB_BOP_MUL)
+        OP(KSB_BOP_MATMUL)
+        OP(KSB_BOP_DIV)
+        OP(KSB_BOP_FLOORDIV)
+        OP(KSB_BOP_MOD)
+        OP(KSB_BOP_POW)
+        OP(KSB_UOP_POS)
+        OP(KSB_UOP_NEG)
+        OP(KSB_UOP_SQIG)
+        OP(KSB_UOP_NOT)
+        #undef OP
+    }
+    return NULL;
+}
+
+
 /* Type Functions */
 
 static KS_TFUNC(T, free) {
@@ -6,6 +6,9 @@
 
 #define T_NAME "dict"
 #define TI_NAME T_NAME ".__iter"
+#define TK_NAME T_NAME ".__keys"
+#define TV_NAME T_NAME ".__values"
+#define TT_NAME T_NAME ".__items"
 
 
 
@@ -22,15 +25,24 @@
 /* New/target load factor for rehashing */
 #define S_LOAD_NEW       (0.3)
 
-/* Maximum proportion of holes in the entries array. Once the ratio exceeds this, holes are filled */
-#define S_HOLES_MAX      (0.5)
+/* Minimum number of buckets (must be a power of two) */
+#define S_MIN_BUCKETS    (8)
+
+/* Number of bits of the hash shifted into the probe sequence on each step (see 's_search()') */
+#define S_PERTURB_SHIFT  (5)
+
+/* Fingerprint of a hash, stored for each bucket
+ * These are the high bits of the hash, since the low bits were already used to pick the bucket
+ */
+#define S_TAG(_hash)     ((ks_uint8_t)((_hash) >> (8 * sizeof(ks_hash_t) - 8)))
 
 
 /* Template to conditionally execute different code based on size 
  * 
  * Since hash tables use different sized indices for different number of entries, this macro allows
  *   clean code that doesn't manually select the buckets array. You can use '__buckets' which will be set
- *   to the relevant one for a given dictionary and length of entries
+ *   to the relevant one for a given dictionary and length of entries, and '__tags', which are the fingerprints
+ *   of the hash for each bucket (stored after the buckets, in the same allocation)
  * 
  * Note that this should be the length of the entries array (->len_ents), not the number of entries, which may be different
  *   
@@ -39,178 +51,148 @@
 #define S_T_SIZE(_self, _len_ents, ...) do { \
     /****/ if (_len_ents < KS_SINT8_MAX) {                 \
         ks_sint8_t* __buckets = self->buckets_s8;          \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else if (_len_ents < KS_SINT16_MAX) {                \
         ks_sint16_t* __buckets = self->buckets_s16;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else if (_len_ents < KS_SINT32_MAX) {                \
         ks_sint32_t* __buckets = self->buckets_s32;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else {                                               \
         ks_sint64_t* __buckets = self->buckets_s64;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     }                                                      \
 } while (0)
 
 
-/* Calculate real load factor */
-static double s_load(ks_dict self) {
-    return self->len_buckets > 0 ? (double)self->len_ents / self->len_buckets : 0.0;
-}
-
-
 /* Search through the hash table for a given hash and key 
  *
- * Sets 'rb' to the bucket at which the key was located, OR the first bucket that was empty, OR
+ * The number of buckets is a power of two, so the first bucket is just the low bits of the hash. Afterwards,
+ *   the rest of the hash is shifted into the probe sequence (called 'perturbation'), so keys whose hashes only
+ *   differ in the high bits don't collide all the way. Once all bits are used, it becomes 'bi = 5 * bi + 1',
+ *   which visits every bucket
+ *
+ * Most buckets whose keys don't match are rejected by their fingerprint, without reading the entries array
+ *
+ * Sets 'rb' to the bucket at which the key was located, OR the first bucket that was empty or deleted, OR
  *   -1 if the hash table was full
  * Sets 're' to the index in the arrays of entries, or -1 if it was not found
  * 
  * Returns true if the operation completed, false if an error was thrown
  */
 static bool s_search(ks_dict self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_ssize_t* re) {
-    if (self->len_buckets <= 0) {
-        /* no elements, but avoid modulo by 0 */
-        *rb = *re = -1;
-        return true;
-    }
+    *rb = *re = -1;
+    if (self->len_buckets <= 0) return true;
 
-    /* Calculate bucket index based on hash */
-    ks_size_t bi = hash % self->len_buckets;
+    ks_size_t mask = self->len_buckets - 1, bi = hash & mask, perturb = hash, tries;
+    ks_uint8_t tag = S_TAG(hash);
 
-    /* First bucket index, and number of tries thus far */
-    ks_size_t bi0 = bi, tries = 0;
+    S_T_SIZE(self, self->len_ents,
+        for (tries = 0; tries < self->len_buckets + 8 * sizeof(hash) / S_PERTURB_SHIFT + 1; ++tries) {
+            /* Element index (>=0 means valid, < 0 means special case) */
+            ks_ssize_t ei = __buckets[bi];
 
-    do {
-        /* Element index (>=0 means valid, < 0 means special case) */
-        ks_ssize_t ei;
-        S_T_SIZE(self, self->len_ents,
-            ei = __buckets[bi];
-        );
+            /****/ if (ei == B_EMPTY) {
+                /* Hit an empty bucket, so the key was not present. However, it can now be inserted, so signal that */
+                if (*rb < 0) *rb = bi;
+                return true;
+            } else if (ei == B_DELETED) {
+                /* Skip deleted entries, so that we don't break existing keys (but they can be reused) */
+                if (*rb < 0) *rb = bi;
+            } else if (__tags[bi] == tag && self->ents[ei].hash == hash) {
+                /* Hashes match exactly, now determine whether the objects are eqaully (identically, or via 'A == B') */
+                kso ek = self->ents[ei].key;
+                bool is_eq = ek == key;
+
+                if (!is_eq) {
+                    if (ek->type == kst_str && key->type == kst_str) {
+                        /* Common case, which doesn't need to dispatch (and is just a pointer check if both are interned) */
+                        is_eq = ks_str_eq((ks_str)ek, (ks_str)key);
+                    } else if (!kso_eq(ek, key, &is_eq)) {
+                        /* Determine via comparison */
+                        return false;
+                    }
+                }
 
-        /****/ if (ei == B_EMPTY) {
-            /* Hit an empty bucket, so the key was not present. However, it can now be inserted here, so signal that */
-            *rb = bi;
-            *re = -1;
-            return true;
-        } else if (ei == B_DELETED) {
-            /* Skip deleted entries, so that we don't break existing keys */
-        } else if (self->ents[ei].hash == hash) {
-            /* Hashes match exactly, now determine whether the objects are eqaully (identically, or via 'A == B') */
-            bool is_eq = self->ents[ei].key == key;
-
-            if (!is_eq) {
-                /* Determine via comparison */
-                if (!kso_eq(self->ents[ei].key, key, &is_eq)) return false;
+                if (is_eq) {
+                    /* Successfully found it */
+                    *rb = bi;
+                    *re = ei;
+                    return true;
+                }
             }
 
-            if (is_eq) {
-                /* Successfully found it */
-                *rb = bi;
-                *re = ei;
-                return true;
-            }
+            /* Probe for the next bucket in the hash table */
+            perturb >>= S_PERTURB_SHIFT;
+            bi = (5 * bi + perturb + 1) & mask;
         }
-
-
-
-        /* Probe for the next bucket in the hash table
-         *
-         * For now, we use linear probing
-         */
-        bi = (bi + 1) % self->len_buckets;
-
-    } while (bi != bi0);
-
-    /* Not found, and no room to insert, so signal that */
-    *rb = *re = -1;
-    return -1;
-}
-
-/* Fill holes in the entries array of 'self'
- *
- * Returns true if the operation completed, false if an error was thrown
- */
-static bool s_fill_holes(ks_dict self) {
-
-    if (self->len_ents <= self->len_real || self->len_ents <= 0) return true;
-
-    ks_ssize_t* em = ks_zmalloc(self->len_ents, sizeof(*em));
-    if (!em) {
-        //KS_THROW_OUTOFMEM();
-        return false;
-    }
-
-    /* Calculate index translation map for the entries */
-    ks_size_t i, j = 0;
-
-    for (i = 0; i < self->len_ents; ++i) {
-        em[i] = j;
-        if (self->ents[i].key != NULL) j++;
-    }
-
-
-    /* Replace current indices with new indices */
-    for (i = 0; i < self->len_ents; ++i) self->ents[em[i]] = self->ents[i];
-    S_T_SIZE(self, self->len_ents,
-        for (i = 0; i < self->len_buckets; ++i) if (__buckets[i] >= 0)
-            __buckets[i] = em[__buckets[i]];
     );
 
-    ks_free(em);
+    /* Not found (and there may be no room to insert) */
     return true;
 }
 
-/* Resize and rehash the hash table to hold at least 'new_len_buckets'
+/* Resize and rehash the hash table for the current entries
+ *
+ * Deleted entries are removed first (which changes the indices of entries), and then the number of buckets is
+ *   chosen so the load factor is at most 'S_LOAD_NEW'. This must also be called when the length of the entries
+ *   array needs wider indices in the buckets
  *
  * Returns true if the operation completed, false if an error was thrown
  */
-static bool s_resize(ks_dict self, ks_size_t new_len_buckets) {
-    new_len_buckets = ks_nextprime(new_len_buckets);
-    if (self->len_buckets >= new_len_buckets) return true;
+static bool s_resize(ks_dict self) {
+    ks_size_t i, j;
 
-    ks_size_t i;
+    /* Fill holes in the entries array */
+    if (self->len_real < self->len_ents) {
+        for (i = j = 0; i < self->len_ents; ++i) {
+            if (self->ents[i].key) self->ents[j++] = self->ents[i];
+        }
+        self->len_ents = j;
+    }
+
+    ks_size_t new_len_buckets = S_MIN_BUCKETS;
+    while (new_len_buckets * S_LOAD_NEW < self->len_ents) new_len_buckets *= 2;
 
-    /* Calculate required size of buckets array */
+    /* Calculate required size of buckets array (including the tags) */
     ks_size_t new_bucket_sz = 0;
     S_T_SIZE(self, self->len_ents, 
-        new_bucket_sz = sizeof(*__buckets) * new_len_buckets;
+        new_bucket_sz = (sizeof(*__buckets) + sizeof(*__tags)) * new_len_buckets;
     );
 
     /* Reallocate buckets array if we need to */
     if (new_bucket_sz > self->_max_len_buckets_b) {
         self->_max_len_buckets_b = ks_nextsize(self->_max_len_buckets_b, new_bucket_sz);
-
         self->buckets_s8 = ks_realloc(self->buckets_s8, self->_max_len_buckets_b);
-        //if (!new_buckets) {
-            /* No memory */
-        //}
     }
 
-    /* Update and clear all buckets */
+    /* Update and clear all buckets, and then add each entry to the first empty bucket in its sequence */
     self->len_buckets = new_len_buckets;
+    ks_size_t mask = new_len_buckets - 1;
     S_T_SIZE(self, self->len_ents, 
-        for (i = 0; i < self->len_buckets; ++i) __buckets[i] = B_EMPTY;
+        for (i = 0; i < new_len_buckets; ++i) __buckets[i] = B_EMPTY;
+
+        for (i = 0; i < self->len_ents; ++i) {
+            ks_hash_t hash = self->ents[i].hash;
+            ks_size_t bi = hash & mask, perturb = hash;
+            while (__buckets[bi] != B_EMPTY) {
+                perturb >>= S_PERTURB_SHIFT;
+                bi = (5 * bi + perturb + 1) & mask;
+            }
+            __buckets[bi] = i;
+            __tags[bi] = S_TAG(hash);
+        }
     );
 
-    /* Now, rehash the buckets */
-    ks_size_t ct = 0;
-    for (i = 0; i < self->len_ents; ++i) {
-        struct ks_dict_ent* ent = &self->ents[i];
-        if (ent->key) {
-            ks_ssize_t rb, re;
-            if (!s_search(self, ent->key, ent->hash, &rb, &re)) return false;
-            assert(re < 0 && rb >= 0);
-
-            S_T_SIZE(self, self->len_ents, 
-                __buckets[rb] = i;
-            );
-
-            ct++;
-        }
-    }
-    
-    assert(self->len_real == ct);
-    return self->len_ents * S_HOLES_MAX >= self->len_real ? s_fill_holes(self) : true;
+    return true;
 }
 
 /* C-API */
@@ -231,8 +213,8 @@ ks_dict ks_dict_newt(ks_type tp, struct ks_ikv* ikv) {
     if (ikv) {
         struct ks_ikv* p = ikv;
         while (p->key) {
-            ks_str k = ks_str_new(-1, p->key);
-            ks_dict_set_h(self, (kso)k, k->v_hash, p->val);
+            ks_str k = ks_str_intern_c(-1, p->key);
+            ks_dict_set_h(self, (kso)k, KS_STR_HASH(k), p->val);
             KS_DECREF(k);
             p++;
         }
@@ -257,8 +239,8 @@ ks_dict ks_dict_new(struct ks_ikv* ikv) {
     if (ikv) {
         struct ks_ikv* p = ikv;
         while (p->key) {
-            ks_str k = ks_str_new(-1, p->key);
-            ks_dict_set_h(self, (kso)k, k->v_hash, p->val);
+            ks_str k = ks_str_intern_c(-1, p->key);
+            ks_dict_set_h(self, (kso)k, KS_STR_HASH(k), p->val);
             KS_DECREF(k);
             p++;
         }
@@ -302,7 +284,7 @@ void ks_dict_clear(ks_dict self) {
         }
     }
 
-    self->len_ents = 0;
+    self->len_ents = self->len_real = 0;
     self->len_buckets = 0;
 }
 
@@ -332,7 +314,7 @@ bool ks_dict_merge_ikv(ks_dict self, struct ks_ikv* ikv) {
             assert(key != NULL);
             kso val = it->val;
             assert(val != NULL);
-            bool had_err = !ks_dict_set_h(self, (kso)key, key->v_hash, val);
+            bool had_err = !ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
 
             /* This function works by taking the references from the list of elements */
             KS_DECREF(key);
@@ -385,8 +367,8 @@ kso ks_dict_get_ih(ks_dict self, kso key, ks_hash_t hash) {
 }
 
 kso ks_dict_get_c(ks_dict self, const char* ckey) {
-    ks_str key = ks_str_new(-1, ckey);
-    kso res = ks_dict_get_h(self, (kso)key, key->v_hash);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    kso res = ks_dict_get_h(self, (kso)key, KS_STR_HASH(key));
     KS_DECREF(key);
     return res;
 }
@@ -397,26 +379,20 @@ bool ks_dict_set(ks_dict self, kso key, kso val) {
     return ks_dict_set_h(self, key, hash, val);
 }
 bool ks_dict_set_c1(ks_dict self, const char* ckey, kso val) {
-    ks_str key = ks_str_new(-1, ckey);
-    bool res = ks_dict_set_h(self, (kso)key, key->v_hash, val);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    bool res = ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
     KS_DECREF(key);
     KS_DECREF(val);
     return res;
 }
 bool ks_dict_set_c(ks_dict self, const char* ckey, kso val) {
-    ks_str key = ks_str_new(-1, ckey);
-    bool res = ks_dict_set_h(self, (kso)key, key->v_hash, val);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    bool res = ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
     KS_DECREF(key);
     return res;
 }
 bool ks_dict_set_h(ks_dict self, kso key, ks_hash_t hash, kso val) {
     ks_ssize_t rb, re;
-
-    /* Resize if needed */
-    if (s_load(self) > S_LOAD_MAX || self->len_buckets == 0)
-        if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
-            return false;
-
     if (!s_search(self, key, hash, &rb, &re)) return false;
 
     if (re < 0) {
@@ -438,22 +414,15 @@ bool ks_dict_set_h(ks_dict self, kso key, ks_hash_t hash, kso val) {
         self->ents[re].key = key;
         self->ents[re].val = val;
 
-        /* Add buckets if needed */
-        if (rb < 0 || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
-            /* No bucket found, we need to resize/fill holes */
-            if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
-                return false;
-
-            /* Now, refind it */
-            ks_ssize_t new_re;
-            if (!s_search(self, key, hash, &rb, &new_re)) return false;
-
-            assert(rb >= 0 && re == new_re);
+        /* Resize if there was no bucket, the table is too full, or the buckets need wider indices (this adds the new entry too) */
+        if (rb < 0 || self->len_ents > self->len_buckets * S_LOAD_MAX || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
+            return s_resize(self);
         }
 
         /* Set the bucket to point to it */
         S_T_SIZE(self, self->len_ents, 
             __buckets[rb] = re;
+            __tags[rb] = S_TAG(hash);
         );
 
         return true;
@@ -480,8 +449,8 @@ bool ks_dict_has_h(ks_dict self, kso key, ks_hash_t hash, bool* exists) {
     return true;
 }
 bool ks_dict_has_c(ks_dict self, const char* key, bool* exists) {
-    ks_str o = ks_str_new(-1, key);
-    bool res = ks_dict_has_h(self, (kso)o, o->v_hash, exists);
+    ks_str o = ks_str_intern_c(-1, key);
+    bool res = ks_dict_has_h(self, (kso)o, KS_STR_HASH(o), exists);
     KS_DECREF(o);
     return res;
 }
@@ -504,11 +473,54 @@ bool ks_dict_del_h(ks_dict self, kso key, ks_hash_t hash, bool* existed) {
         S_T_SIZE(self, self->len_ents,
             __buckets[rb] = B_DELETED;
         );
+
+        /* Leave a hole in the entries, which is filled on the next resize */
+        kso k = self->ents[re].key, v = self->ents[re].val;
+        self->ents[re].key = self->ents[re].val = NULL;
+        self->len_real--;
+        KS_DECREF(k);
+        KS_DECREF(v);
     }
 
     return true;
 }
 
+bool ks_dict_next(ks_dict self, ks_cint* pos, kso* key, kso* val) {
+    while (*pos < self->len_ents) {
+        struct ks_dict_ent* ent = &self->ents[(*pos)++];
+        if (ent->key) {
+            *key = ent->key;
+            *val = ent->val;
+            return true;
+        }
+    }
+    return false;
+}
+
+ks_dict_iter ks_dict_iter_new(ks_dict self, int kind) {
+    ks_dict_iter res = KSO_NEW(ks_dict_iter, kst_dict_iter);
+
+    KS_INCREF(self);
+    res->of = self;
+
+    res->pos = 0;
+    res->kind = kind;
+    res->len_real = self->len_real;
+    res->len_ents = self->len_ents;
+
+    return res;
+}
+
+ks_dict_view ks_dict_view_new(ks_dict self, ks_type tp) {
+    assert(tp == kst_dict_keys || tp == kst_dict_values || tp == kst_dict_items);
+    ks_dict_view res = KSO_NEW(ks_dict_view, tp);
+
+    KS_INCREF(self);
+    res->of = self;
+
+    return res;
+}
+
 ks_list ks_dict_calc_ents(ks_dict self) {
     ks_list res = ks_list_new(0, NULL);
 
@@ -551,6 +563,31 @@ ks_list ks_dict_calc_buckets(ks_dict self) {
     return res;
 }
 
+void ks_dict_calc_probes(ks_dict self, ks_cint* total, ks_cint* max) {
+    *total = *max = 0;
+
+    ks_size_t i, mask = self->len_buckets - 1;
+    for (i = 0; i < self->len_buckets; ++i) {
+        ks_ssize_t ei;
+        S_T_SIZE(self, self->len_ents,
+            ei = __buckets[i];
+        );
+        if (ei < 0) continue;
+
+        /* Number of steps in the probe sequence to reach it (see 's_search()') */
+        ks_hash_t hash = self->ents[ei].hash;
+        ks_size_t bi = hash & mask, perturb = hash;
+        ks_cint d = 0;
+        while (bi != i) {
+            perturb >>= S_PERTURB_SHIFT;
+            bi = (5 * bi + perturb + 1) & mask;
+            d++;
+        }
+        *total += d;
+        if (d > *max) *max = d;
+    }
+}
+
 
 /* Type Functions */
 
@@ -644,6 +681,18 @@ static KS_TFUNC(T, len) {
     return (kso)ks_int_newu(self->len_real);
 }
 
+static KS_TFUNC(T, probes) {
+    ks_dict self;
+    KS_ARGS("self:*", &self, kst_dict);
+
+    ks_cint total, max;
+    ks_dict_calc_probes(self, &total, &max);
+
+    return (kso)ks_tuple_newn(2, (kso[]){
+        (kso)ks_int_new(total),
+        (kso)ks_int_new(max),
+    });
+}
 
 static KS_TFUNC(T, contains) {
     ks_dict self;
@@ -657,6 +706,27 @@ static KS_TFUNC(T, contains) {
     return KSO_BOOL(g);
 }
 
+static KS_TFUNC(T, keys) {
+    ks_dict self;
+    KS_ARGS("self:*", &self, kst_dict);
+
+    return (kso)ks_dict_view_new(self, kst_dict_keys);
+}
+
+static KS_TFUNC(T, values) {
+    ks_dict self;
+    KS_ARGS("self:*", &self, kst_dict);
+
+    return (kso)ks_dict_view_new(self, kst_dict_values);
+}
+
+static KS_TFUNC(T, items) {
+    ks_dict self;
+    KS_ARGS("self:*", &self, kst_dict);
+
+    return (kso)ks_dict_view_new(self, kst_dict_items);
+}
+
 
 /** Iterator **/
 
@@ -681,10 +751,128 @@ static KS_TFUNC(TI, new) {
     self->of = of;
 
     self->pos = 0;
+    self->kind = KS_DICT_KEYS;
+    self->len_real = of->len_real;
+    self->len_ents = of->len_ents;
 
     return (kso)self;
 }
 
+static bool TI_next(kso ob, kso* res) {
+    ks_dict_iter self = (ks_dict_iter)ob;
+    if (self->of->len_real != self->len_real || self->of->len_ents != self->len_ents) {
+        KS_THROW(kst_SizeError, "'dict' changed size during iteration");
+        return false;
+    }
+
+    kso k, v;
+    if (!ks_dict_next(self->of, &self->pos, &k, &v)) {
+        *res = NULL;
+    } else if (self->kind == KS_DICT_KEYS) {
+        *res = KS_NEWREF(k);
+    } else if (self->kind == KS_DICT_VALUES) {
+        *res = KS_NEWREF(v);
+    } else {
+        *res = (kso)ks_tuple_new(2, (kso[]){ k, v });
+    }
+    return true;
+}
+
+
+/** Views **/
+
+static KS_TFUNC(TK, free) {
+    ks_dict_view self;
+    KS_ARGS("self", &self);
+
+    KS_DECREF(self->of);
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TK, len) {
+    ks_dict_view self;
+    KS_ARGS("self", &self);
+
+    return (kso)ks_int_newu(self->of->len_real);
+}
+
+static KS_TFUNC(TK, bool) {
+    ks_dict_view self;
+    KS_ARGS("self", &self);
+
+    return KSO_BOOL(self->of->len_real != 0);
+}
+
+static KS_TFUNC(TK, iter) {
+    ks_dict_view self;
+    KS_ARGS("self", &self);
+
+    int kind = self->type == kst_dict_values ? KS_DICT_VALUES : self->type == kst_dict_items ? KS_DICT_ITEMS : KS_DICT_KEYS;
+    return (kso)ks_dict_iter_new(self->of, kind);
+}
+
+static KS_TFUNC(TK, contains) {
+    ks_dict_view self;
+    kso key;
+    KS_ARGS("self:* key", &self, kst_dict_keys, &key);
+
+    bool g;
+    if (!ks_dict_has(self->of, key, &g)) return NULL;
+
+    return KSO_BOOL(g);
+}
+
+static KS_TFUNC(TV, contains) {
+    ks_dict_view self;
+    kso val;
+    KS_ARGS("self:* val", &self, kst_dict_values, &val);
+
+    /* Values aren't indexed, so they are compared one at a time */
+    ks_cint pos = 0;
+    kso k, v;
+    while (ks_dict_next(self->of, &pos, &k, &v)) {
+        bool g = v == val;
+        if (!g) {
+            /* Hold a reference, in case comparing removes it */
+            KS_INCREF(v);
+            bool ok = kso_eq(v, val, &g);
+            KS_DECREF(v);
+            if (!ok) return NULL;
+        }
+        if (g) return KSO_TRUE;
+    }
+
+    return KSO_FALSE;
+}
+
+static KS_TFUNC(TT, contains) {
+    ks_dict_view self;
+    kso item;
+    KS_ARGS("self:* item", &self, kst_dict_items, &item);
+
+    /* Only '(key, val)' tuples can be contained, and the key is looked up directly */
+    if (!kso_issub(item->type, kst_tuple) || ((ks_tuple)item)->len != 2) return KSO_FALSE;
+    kso key = ((ks_tuple)item)->elems[0], val = ((ks_tuple)item)->elems[1];
+
+    ks_hash_t hash;
+    ks_ssize_t rb, re;
+    if (!kso_hash(key, &hash) || !s_search(self->of, key, hash, &rb, &re)) return NULL;
+    if (re < 0) return KSO_FALSE;
+
+    /* Hold a reference, in case comparing removes it */
+    kso v = KS_NEWREF(self->of->ents[re].val);
+    bool g = v == val;
+    if (!g && !kso_eq(v, val, &g)) {
+        KS_DECREF(v);
+        return NULL;
+    }
+    KS_DECREF(v);
+
+    return KSO_BOOL(g);
+}
+
 /* Export */
 
 static struct ks_type_s tp;
@@ -693,12 +881,46 @@ ks_type kst_dict = &tp;
 static struct ks_type_s tp_iter;
 ks_type kst_dict_iter = &tp_iter;
 
+static struct ks_type_s tp_keys;
+ks_type kst_dict_keys = &tp_keys;
+
+static struct ks_type_s tp_values;
+ks_type kst_dict_values = &tp_values;
+
+static struct ks_type_s tp_items;
+ks_type kst_dict_items = &tp_items;
+
 void _ksi_dict() {
 
-    _ksinit(kst_dict_iter, kst_object, TI_NAME, sizeof(struct ks_dict_s), -1, "", KS_IKV(
+    _ksinit(kst_dict_iter, kst_object, TI_NAME, sizeof(struct ks_dict_iter_s), -1, "", KS_IKV(
         {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
     ));
+    kst_dict_iter->ob_next = TI_next;
+
+    _ksinit(kst_dict_keys, kst_object, TK_NAME, sizeof(struct ks_dict_view_s), -1, "View of the keys of a dictionary, which supports 'len()', 'in', and iteration without copying them", KS_IKV(
+        {"__free",               ksf_wrap(TK_free_, TK_NAME ".__free(self)", "")},
+        {"__bool",               ksf_wrap(TK_bool_, TK_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(TK_len_, TK_NAME ".__len(self)", "")},
+        {"__iter",               ksf_wrap(TK_iter_, TK_NAME ".__iter(self)", "")},
+        {"__contains",           ksf_wrap(TK_contains_, TK_NAME ".__contains(self, key)", "")},
+    ));
+
+    _ksinit(kst_dict_values, kst_object, TV_NAME, sizeof(struct ks_dict_view_s), -1, "View of the values of a dictionary, which supports 'len()', 'in', and iteration without copying them\n\n    Checking whether a value is 'in' the view compares it against every value", KS_IKV(
+        {"__free",               ksf_wrap(TK_free_, TV_NAME ".__free(self)", "")},
+        {"__bool",               ksf_wrap(TK_bool_, TV_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(TK_len_, TV_NAME ".__len(self)", "")},
+        {"__iter",               ksf_wrap(TK_iter_, TV_NAME ".__iter(self)", "")},
+        {"__contains",           ksf_wrap(TV_contains_, TV_NAME ".__contains(self, val)", "")},
+    ));
+
+    _ksinit(kst_dict_items, kst_object, TT_NAME, sizeof(struct ks_dict_view_s), -1, "View of the entries of a dictionary, as '(key, val)' tuples, which supports 'len()', 'in', and iteration without copying them", KS_IKV(
+        {"__free",               ksf_wrap(TK_free_, TT_NAME ".__free(self)", "")},
+        {"__bool",               ksf_wrap(TK_bool_, TT_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(TK_len_, TT_NAME ".__len(self)", "")},
+        {"__iter",               ksf_wrap(TK_iter_, TT_NAME ".__iter(self)", "")},
+        {"__contains",           ksf_wrap(TT_contains_, TT_NAME ".__contains(self, item)", "")},
+    ));
 
     _ksinit(kst_dict, kst_object, T_NAME, sizeof(struct ks_dict_s), -1, "Dictionaries, sometimes called associative arrays, are mappings between keys and values. The keys and values may be any objects, the only requirement is that keys are hashable. And, for keys which hash equally and compare equally, there is only one key stored\n\n    Entries are ordered by first insertion of the key, which is reset upon deletion\n\n    SEE: https://en.wikipedia.org/wiki/Associative_array", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
@@ -706,6 +928,11 @@ void _ksi_dict() {
         {"__bool",                 ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
         {"__len",                  ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
         {"__contains",             ksf_wrap(T_contains_, T_NAME ".__contains(self, key)", "")},
+        {"__probes",               ksf_wrap(T_probes_, T_NAME ".__probes(self)", "Return '(total, max)', the total and maximum probe lengths of the keys in the hash table, for diagnosing how well the keys hash")},
+
+        {"keys",                   ksf_wrap(T_keys_, T_NAME ".keys(self)", "Return a view of the keys, which reflects later changes to the dictionary")},
+        {"values",                 ksf_wrap(T_values_, T_NAME ".values(self)", "Return a view of the values, which reflects later changes to the dictionary")},
+        {"items",                  ksf_wrap(T_items_, T_NAME ".items(self)", "Return a view of the entries, as '(key, val)' tuples, which reflects later changes to the dictionary")},
 
         {"__iter",               KS_NEWREF(kst_dict_iter)},
         
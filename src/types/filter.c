@@ -43,13 +43,16 @@ static KS_TFUNC(T, new) {
     return (kso)self;
 }
 
-static KS_TFUNC(T, next) {
-    ks_filter self;
-    KS_ARGS("self:*", &self, kst_filter);
+static bool T_next(kso ob, kso* res) {
+    ks_filter self = (ks_filter)ob;
 
     while (true) {
-        kso v = kso_next(self->it);
-        if (!v) return NULL;
+        kso v;
+        if (!kso_advance(self->it, &v)) return false;
+        if (!v) {
+            *res = NULL;
+            return true;
+        }
 
         kso a = NULL;
         if (self->trans == KSO_NONE) {
@@ -60,24 +63,34 @@ static KS_TFUNC(T, next) {
         }
         if (!a) {
             KS_DECREF(v);
-            return NULL;
+            return false;
         }
 
         bool t;
         if (!kso_truthy(a, &t)) {
             KS_DECREF(a);
             KS_DECREF(v);
-            return NULL;
+            return false;
         }
         KS_DECREF(a);
 
         /* Found something which matched the filter */
-        if (t) return v;
+        if (t) {
+            *res = v;
+            return true;
+        }
         KS_DECREF(v);
     }
 
     assert(false);
-    return NULL;
+    return false;
+}
+
+static KS_TFUNC(T, next) {
+    ks_filter self;
+    KS_ARGS("self:*", &self, kst_filter);
+
+    return kso_next_f(T_next, (kso)self);
 }
 
 
@@ -92,4 +105,5 @@ void _ksi_filter() {
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, fn, objs)", "")},
         {"__next",               ksf_wrap(T_next_, T_NAME ".__next(self)", "")},
     ));
+    kst_filter->ob_next = T_next;
 }
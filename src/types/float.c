@@ -347,6 +347,14 @@ int ks_cfloat_to_str(char* str, int sz, ks_cfloat val, bool sci, int prec, int b
     return i;
 }
 
+int ks_cfloat_str(char* str, int sz, ks_cfloat val) {
+    /* Determine printing mode */
+    ks_cfloat a_v = fabs(val);
+    bool sci = a_v > 0 && (a_v >= A_SCI_BIG || a_v <= A_SCI_SML);
+
+    return ks_cfloat_to_str(str, sz, val, sci, sci ? F_PREC_SCI : F_PREC_REG, 10);
+}
+
 int ks_strfromd(char* str, size_t n, char* fmt, ks_cfloat val) {
     int i = 0;
     assert(fmt[i] == '%');
@@ -418,16 +426,12 @@ static KS_TFUNC(T, str) {
     ks_float self;
     KS_ARGS("self:*", &self, kst_float);
 
-    /* Determine printing mode */
-    ks_cfloat a_v = fabs(self->val);
-    bool sci = a_v > 0 && (a_v >= A_SCI_BIG || a_v <= A_SCI_SML);
-
     char tmp[256];
     
-    int sz = ks_cfloat_to_str(tmp, sizeof(tmp) - 1, self->val, sci, sci ? F_PREC_SCI : F_PREC_REG, 10);
+    int sz = ks_cfloat_str(tmp, sizeof(tmp) - 1, self->val);
     if (sz >= sizeof(tmp) - 1) {
         char* atmp = ks_malloc(sz + 5);
-        int asz = ks_cfloat_to_str(atmp, sz+4, self->val, sci, sci ? F_PREC_SCI : F_PREC_REG, 10);
+        int asz = ks_cfloat_str(atmp, sz+4, self->val);
         //assert(sz == asz);
         ks_str res = ks_str_new(asz, atmp);
         ks_free(atmp);
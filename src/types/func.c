@@ -155,7 +155,7 @@ static KS_TFUNC(T, str) {
     ks_func self;
     KS_ARGS("self:*", &self, kst_func);
 
-    kso sig = ks_dict_get_h(self->attr, (kso)_ksva__sig, _ksva__sig->v_hash);
+    kso sig = ks_dict_get_h(self->attr, (kso)_ksva__sig, KS_STR_HASH(_ksva__sig));
     ks_str res = ks_fmt("<%T %R>", self, sig);
     KS_DECREF(sig);
 
@@ -412,6 +412,8 @@ static KS_TFUNC(T, sort) {
     kso keys = NULL;
     KS_ARGS("self:* ?cmpfunc ?keys", &self, kst_list, &cmpfunc, &keys);
 
+    if (cmpfunc == KSO_NONE) cmpfunc = NULL;
+
     if (!keys || keys == KSO_NONE) {
         /* Use entries as keys */
         if (!ks_sort(self->len, self->elems, self->elems, cmpfunc)) {
@@ -466,6 +468,12 @@ static KS_TFUNC(TI, new) {
     return (kso)self;
 }
 
+static bool TI_next(kso ob, kso* res) {
+    ks_list_iter self = (ks_list_iter)ob;
+    *res = self->pos < self->of->len ? KS_NEWREF(self->of->elems[self->pos++]) : NULL;
+    return true;
+}
+
 
 /* Export */
 
@@ -481,6 +489,7 @@ void _ksi_list() {
         {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
     ));
+    kst_list_iter->ob_next = TI_next;
 
     _ksinit(kst_list, kst_object, T_NAME, sizeof(struct ks_list_s), -1, "List of references to other objects, which is mutable\n\n    Internally, a 'list' is not a linked-list-like data structure, but closer to an array. Specifically, it is an array of references, so children are not copied or duplicated, only a reference is made to them", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
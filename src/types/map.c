@@ -39,17 +39,27 @@ static KS_TFUNC(T, new) {
     return (kso)self;
 }
 
+static bool T_next(kso ob, kso* res) {
+    ks_map self = (ks_map)ob;
+
+    kso v;
+    if (!kso_advance(self->it, &v)) return false;
+    if (!v) {
+        *res = NULL;
+        return true;
+    }
+
+    *res = kso_call(self->trans, 1, &v);
+    KS_DECREF(v);
+
+    return *res != NULL;
+}
+
 static KS_TFUNC(T, next) {
     ks_map self;
     KS_ARGS("self:*", &self, kst_map);
 
-    kso v = kso_next(self->it);
-    if (!v) return NULL;
-
-    kso a = kso_call(self->trans, 1, &v);
-    KS_DECREF(v);
-    
-    return a;
+    return kso_next_f(T_next, (kso)self);
 }
 
 
@@ -64,4 +74,5 @@ void _ksi_map() {
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, fn, objs)", "")},
         {"__next",               ksf_wrap(T_next_, T_NAME ".__next(self)", "")},
     ));
+    kst_map->ob_next = T_next;
 }
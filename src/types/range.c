@@ -184,7 +184,47 @@ static KS_TFUNC(TI, init) {
     return KSO_NONE;
 }
 
-/* actual next is in 'kso_next()', for optimizations */
+static bool TI_next(kso ob, kso* res) {
+    ks_range_iter self = (ks_range_iter)ob;
+    *res = NULL;
+    if (self->done) return true;
+
+    /* Shortcut for speedup */
+    if (self->use_ci) {
+        ks_cint n_cur = self->_ci.cur + self->_ci.step;
+        int cmp_ce = (self->_ci.cur > self->_ci.end) - (self->_ci.cur < self->_ci.end);
+
+        if (cmp_ce == 0 || (self->cmp_step_0 > 0 && cmp_ce > 0) || (self->cmp_step_0 < 0 && cmp_ce < 0)) {
+            self->done = true;
+            return true;
+        }
+
+        *res = (kso)ks_int_new(self->_ci.cur);
+        self->_ci.cur = n_cur;
+        return true;
+    }
+
+    /* Determine the next value */
+    if (self->cur) {
+        ks_int newcur = (ks_int)ks_bop_add((kso)self->cur, (kso)self->of->step);
+        if (!newcur) return false;
+        assert(newcur->type == kst_int);
+        KS_DECREF(self->cur);
+        self->cur = newcur;
+    } else {
+        self->cur = (ks_int)KS_NEWREF(self->of->start);
+    }
+
+    /* Do bounds check, with step direction */
+    int cmp_ce = ks_int_cmp(self->cur, self->of->end);
+    if (cmp_ce == 0 || (self->cmp_step_0 > 0 && cmp_ce > 0) || (self->cmp_step_0 < 0 && cmp_ce < 0)) {
+        self->done = true;
+        return true;
+    }
+
+    *res = KS_NEWREF(self->cur);
+    return true;
+}
 
 /* Export */
 
@@ -199,8 +239,8 @@ void _ksi_range() {
     _ksinit(kst_range_iter, kst_object, T_NAME, sizeof(struct ks_range_iter_s), -1, "", KS_IKV(
         {"__free",                 ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
         {"__init",                 ksf_wrap(TI_init_, TI_NAME ".__init(self, of)", "")},
-       // {"__next",                 ksf_wrap(TI_next_, TI_NAME ".__next(self)", "")},
     ));
+    kst_range_iter->ob_next = TI_next;
     _ksinit(kst_range, kst_object, T_NAME, sizeof(struct ks_range_s), -1, "Range of integral values, with an optional step between", KS_IKV(
         {"__free",                 ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                  ksf_wrap(T_new_, T_NAME ".__new(tp, *args)", "")},
@@ -13,6 +13,8 @@
 #include <ks/ucd.h>
 
 #define T_NAME "regex"
+#define TM_NAME T_NAME ".match"
+#define TI_NAME T_NAME ".__finditer"
 
 
 /* Internals */
@@ -269,7 +271,7 @@ static bool parse_item(struct state* ps) {
 
     } else if (*ps->expr == '\\') {
         ps->expr++;
-        char c = *ps->expr;
+        int c = (unsigned char)*ps->expr;
         ps->expr++;
 
         /* Allow escapes */
@@ -346,9 +348,9 @@ static bool parse_item(struct state* ps) {
         ps->expr++;
         s = new_state(ps, KS_REGEX_NFA_LINEEND);
 
-    } else {
+    } else if (*ps->expr) {
         s = new_state(ps, KS_REGEX_NFA_UCP);
-        NODE(s).ucp = *ps->expr++;
+        NODE(s).ucp = (unsigned char)*ps->expr++;
     }
 
     if (s < 0) return false;
@@ -454,6 +456,742 @@ static bool parse_regex(struct state* ps) {
 }
 
 
+/* Lazy DFA */
+
+/* Maximum number of bytes the states of a single DFA may use, before matching falls back to the NFA */
+#define DFA_MAX_MEM (1 << 20)
+
+/* Return whether NFA state 's' consumes character 'c' */
+static bool nfa_accepts(struct ks_regex_nfa* s, ks_ucp c) {
+    int j;
+    if (s->kind == KS_REGEX_NFA_ANY || s->kind == KS_REGEX_NFA_NOT) {
+        bool good = false;
+        if (c < 256) {
+            good = s->set.has_byte[c];
+        } else {
+            for (j = 0; j < s->set.n_ext; ++j) {
+                if (c == s->set.ext[j]) {
+                    good = true;
+                    break;
+                }
+            }
+        }
+        return s->kind == KS_REGEX_NFA_ANY ? good : !good;
+    } else if (s->kind == KS_REGEX_NFA_UCP) {
+        return s->ucp == c;
+    } else if (s->kind == KS_REGEX_NFA_CAT) {
+        struct ksucd_info info;
+        ks_ucp cp = ksucd_get_info(&info, c);
+        return cp > 0 && s->set.has_cat[info.cat_gen];
+    }
+    return false;
+}
+
+/* Add NFA state 's' (and everything reachable by epsilon transitions) to the set being built in 'dfa->mark' */
+static void dfa_add(ks_regex self, ks_regex_dfa dfa, int s) {
+    if (s < 0 || dfa->mark[s]) return;
+    dfa->mark[s] = true;
+    if (self->states[s].kind == KS_REGEX_NFA_EPS) {
+        dfa_add(self, dfa, self->states[s].to0);
+        dfa_add(self, dfa, self->states[s].to1);
+    }
+}
+
+/* Turn the set being built in 'dfa->mark' into a DFA state (clearing it), and return its index, or -1 if the memory
+ *   limit has been reached
+ */
+static int dfa_intern(ks_regex self, ks_regex_dfa dfa) {
+    int* nfa = ks_malloc(sizeof(*nfa) * self->n_states);
+    int n = 0, i;
+    for (i = 0; i < self->n_states; ++i) {
+        if (dfa->mark[i]) {
+            dfa->mark[i] = false;
+            nfa[n++] = i;
+        }
+    }
+
+    ks_hash_t hash = ks_hash_bytes(sizeof(*nfa) * n, (const unsigned char*)nfa);
+
+    /* Look for an existing state */
+    int b = hash & dfa->mask, si;
+    while ((si = dfa->buckets[b]) >= 0) {
+        struct ks_regex_dfa_state* st = &dfa->states[si];
+        if (st->hash == hash && st->n_nfa == n && memcmp(st->nfa, nfa, sizeof(*nfa) * n) == 0) {
+            ks_free(nfa);
+            return si;
+        }
+        b = (b + 1) & dfa->mask;
+    }
+
+    ks_size_t sz = sizeof(struct ks_regex_dfa_state) + sizeof(*nfa) * n + sizeof(int) * dfa->n_cls + 2 * sizeof(int);
+    if (dfa->full || dfa->mem + sz > DFA_MAX_MEM) {
+        dfa->full = true;
+        ks_free(nfa);
+        return -1;
+    }
+    dfa->mem += sz;
+
+    si = dfa->n_states++;
+    if (dfa->n_states > dfa->max_states) {
+        dfa->max_states = ks_nextsize(dfa->max_states, dfa->n_states);
+        dfa->states = ks_zrealloc(dfa->states, sizeof(*dfa->states), dfa->max_states);
+    }
+
+    struct ks_regex_dfa_state* st = &dfa->states[si];
+    st->n_nfa = n;
+    st->nfa = ks_realloc(nfa, sizeof(*nfa) * (n > 0 ? n : 1));
+    st->hash = hash;
+    st->tag = -1;
+    for (i = 0; i < n; ++i) {
+        if (self->states[st->nfa[i]].kind == KS_REGEX_NFA_END) {
+            st->tag = st->nfa[i];
+            break;
+        }
+    }
+    st->acc = (dfa->unanch && dfa->f_acc) || st->tag >= 0;
+    st->eol = -1;
+    st->next = ks_malloc(sizeof(*st->next) * dfa->n_cls);
+    for (i = 0; i < dfa->n_cls; ++i) st->next[i] = -1;
+
+    dfa->buckets[b] = si;
+
+    /* Keep the table at most half full */
+    if (2 * dfa->n_states > dfa->mask) {
+        int nb = 2 * (dfa->mask + 1);
+        ks_free(dfa->buckets);
+        dfa->mask = nb - 1;
+        dfa->buckets = ks_malloc(sizeof(*dfa->buckets) * nb);
+        for (i = 0; i < nb; ++i) dfa->buckets[i] = -1;
+        for (i = 0; i < dfa->n_states; ++i) {
+            b = dfa->states[i].hash & dfa->mask;
+            while (dfa->buckets[b] >= 0) b = (b + 1) & dfa->mask;
+            dfa->buckets[b] = i;
+        }
+    }
+
+    return si;
+}
+
+/* Compute the state after 'si' consumes byte 'c' (without looking at the cache) */
+static int dfa_step(ks_regex self, ks_regex_dfa dfa, int si, int c) {
+    struct ks_regex_dfa_state* st = &dfa->states[si];
+    int i;
+    for (i = 0; i < st->n_nfa; ++i) {
+        struct ks_regex_nfa* s = &self->states[st->nfa[i]];
+        if (nfa_accepts(s, c)) dfa_add(self, dfa, s->to0);
+    }
+    if (dfa->unanch) {
+        /* A match may also start at this byte */
+        for (i = 0; i < dfa->n_f; ++i) {
+            struct ks_regex_nfa* s = &self->states[dfa->f[i]];
+            if (nfa_accepts(s, c)) dfa_add(self, dfa, s->to0);
+        }
+    }
+    return dfa_intern(self, dfa);
+}
+
+/* Compute the state after 'si' takes the epsilon transitions of kind 'kind' (i.e. 'KS_REGEX_NFA_LINESTART') */
+static int dfa_line(ks_regex self, ks_regex_dfa dfa, int si, int kind) {
+    struct ks_regex_dfa_state* st = &dfa->states[si];
+    int i;
+    for (i = 0; i < st->n_nfa; ++i) dfa->mark[st->nfa[i]] = true;
+    for (i = 0; i < st->n_nfa; ++i) {
+        struct ks_regex_nfa* s = &self->states[st->nfa[i]];
+        if (s->kind == kind) dfa_add(self, dfa, s->to0);
+    }
+    if (dfa->unanch) {
+        for (i = 0; i < dfa->n_f; ++i) {
+            struct ks_regex_nfa* s = &self->states[dfa->f[i]];
+            dfa->mark[dfa->f[i]] = true;
+            if (s->kind == kind) dfa_add(self, dfa, s->to0);
+        }
+    }
+    return dfa_intern(self, dfa);
+}
+
+/* Get the next state after 'si' consumes byte 'c', computing it if it hasn't been yet, or -1 if the memory limit
+ *   has been reached
+ */
+static inline int dfa_next(ks_regex self, ks_regex_dfa dfa, int si, unsigned char c) {
+    int k = dfa->cls[c];
+    int ti = dfa->states[si].next[k];
+    if (ti < 0) {
+        ti = dfa_step(self, dfa, si, dfa->rep[k]);
+        if (ti >= 0) dfa->states[si].next[k] = ti;
+    }
+    return ti;
+}
+
+/* Get the state after 'si' reaches the end of input, or -1 if the memory limit has been reached */
+static int dfa_eol(ks_regex self, ks_regex_dfa dfa, int si) {
+    int ti = dfa->states[si].eol;
+    if (ti < 0) {
+        ti = dfa_line(self, dfa, si, KS_REGEX_NFA_LINEEND);
+        if (ti >= 0) dfa->states[si].eol = ti;
+    }
+    return ti;
+}
+
+/* Add the initial states to a DFA which has none */
+static void dfa_init(ks_regex self, ks_regex_dfa dfa) {
+    int i, f;
+    for (i = 0; i < dfa->n_f; ++i) dfa->mark[dfa->f[i]] = true;
+    f = dfa_intern(self, dfa);
+    dfa->start = f < 0 ? -1 : dfa_line(self, dfa, f, KS_REGEX_NFA_LINESTART);
+
+    /* In unanchored mode, nothing is alive when starting in the middle of the input */
+    dfa->mid = dfa->unanch ? dfa_intern(self, dfa) : f;
+}
+
+/* Create a DFA for a regex */
+static ks_regex_dfa dfa_new(ks_regex self, bool unanch) {
+    ks_regex_dfa dfa = ks_malloc(sizeof(*dfa));
+    int i, j;
+
+    dfa->unanch = unanch;
+
+    /* Split bytes into classes, by whether each NFA state consumes them */
+    int map[512], ncls[256];
+    dfa->n_cls = 1;
+    for (i = 0; i < 256; ++i) dfa->cls[i] = 0;
+    for (i = 0; i < self->n_states; ++i) {
+        struct ks_regex_nfa* s = &self->states[i];
+        if (s->kind != KS_REGEX_NFA_ANY && s->kind != KS_REGEX_NFA_NOT && s->kind != KS_REGEX_NFA_UCP && s->kind != KS_REGEX_NFA_CAT) continue;
+
+        int n = 0;
+        for (j = 0; j < 2 * dfa->n_cls; ++j) map[j] = -1;
+        for (j = 0; j < 256; ++j) {
+            int key = 2 * dfa->cls[j] + nfa_accepts(s, j);
+            if (map[key] < 0) map[key] = n++;
+            ncls[j] = map[key];
+        }
+        for (j = 0; j < 256; ++j) dfa->cls[j] = ncls[j];
+        dfa->n_cls = n;
+    }
+    for (j = 255; j >= 0; --j) dfa->rep[dfa->cls[j]] = j;
+
+    dfa->n_states = dfa->max_states = 0;
+    dfa->states = NULL;
+    dfa->mask = 15;
+    dfa->buckets = ks_malloc(sizeof(*dfa->buckets) * (dfa->mask + 1));
+    for (i = 0; i <= dfa->mask; ++i) dfa->buckets[i] = -1;
+    dfa->mem = 0;
+    dfa->full = false;
+    dfa->mark = ks_zmalloc(sizeof(*dfa->mark), self->n_states);
+    for (i = 0; i < self->n_states; ++i) dfa->mark[i] = false;
+
+    /* Compute the closure of the start state */
+    dfa_add(self, dfa, self->s0);
+    dfa->n_f = 0;
+    dfa->f = ks_malloc(sizeof(*dfa->f) * self->n_states);
+    for (i = 0; i < self->n_states; ++i) {
+        if (dfa->mark[i]) {
+            dfa->mark[i] = false;
+            dfa->f[dfa->n_f++] = i;
+        }
+    }
+    dfa->f_acc = false;
+    for (i = 0; i < dfa->n_f; ++i) {
+        if (self->states[dfa->f[i]].kind == KS_REGEX_NFA_END) dfa->f_acc = true;
+    }
+
+    dfa_init(self, dfa);
+    return dfa;
+}
+
+/* Free a DFA */
+static void dfa_free(ks_regex_dfa dfa) {
+    if (!dfa) return;
+    int i;
+    for (i = 0; i < dfa->n_states; ++i) {
+        ks_free(dfa->states[i].nfa);
+        ks_free(dfa->states[i].next);
+    }
+    ks_free(dfa->states);
+    ks_free(dfa->buckets);
+    ks_free(dfa->mark);
+    ks_free(dfa->f);
+    ks_free(dfa);
+}
+
+/* Get the DFA for a regex, creating it if needed */
+static ks_regex_dfa dfa_get(ks_regex self, bool unanch) {
+    if (!self->dfa[unanch]) self->dfa[unanch] = dfa_new(self, unanch);
+    return self->dfa[unanch];
+}
+
+/* Load the NFA states of DFA state 'si' into a simulator, so matching can continue with the NFA */
+static void dfa_tosim(ks_regex self, ks_regex_dfa dfa, int si, ks_regex_sim0* sim) {
+    ks_regex_sim0_init(sim, self->n_states, self->states);
+    if (si < 0) {
+        /* Start from scratch */
+        ks_regex_sim0_addcur(sim, self->s0);
+        ks_regex_sim0_step_linestart(sim);
+    } else {
+        int i;
+        for (i = 0; i < dfa->states[si].n_nfa; ++i) sim->cur[dfa->states[si].nfa[i]] = true;
+        if (dfa->unanch) ks_regex_sim0_addcur(sim, self->s0);
+    }
+}
+
+
+
+/* Flush the DFA (throwing away every state) because the memory limit was reached, keeping only the NFA states of
+ *   state 'si', and returning its new index
+ */
+static int dfa_flush(ks_regex self, ks_regex_dfa dfa, int si) {
+    int n = dfa->states[si].n_nfa, i;
+    int* nfa = dfa->states[si].nfa;
+    dfa->states[si].nfa = NULL;
+
+    for (i = 0; i < dfa->n_states; ++i) {
+        ks_free(dfa->states[i].nfa);
+        ks_free(dfa->states[i].next);
+    }
+    dfa->n_states = 0;
+    for (i = 0; i <= dfa->mask; ++i) dfa->buckets[i] = -1;
+    dfa->mem = 0;
+    dfa->full = false;
+
+    dfa_init(self, dfa);
+    for (i = 0; i < n; ++i) dfa->mark[nfa[i]] = true;
+    ks_free(nfa);
+    return dfa_intern(self, dfa);
+}
+
+/* Like 'dfa_next()', but flushes the DFA instead of failing (which may change '*si') */
+static inline int dfa_nextf(ks_regex self, ks_regex_dfa dfa, int* si, unsigned char c) {
+    int ti = dfa_next(self, dfa, *si, c);
+    if (ti < 0) {
+        *si = dfa_flush(self, dfa, *si);
+        ti = dfa_next(self, dfa, *si, c);
+        assert(ti >= 0);
+    }
+    return ti;
+}
+
+/* Like 'dfa_eol()', but flushes the DFA instead of failing (which may change '*si') */
+static int dfa_eolf(ks_regex self, ks_regex_dfa dfa, int* si) {
+    int ti = dfa_eol(self, dfa, *si);
+    if (ti < 0) {
+        *si = dfa_flush(self, dfa, *si);
+        ti = dfa_eol(self, dfa, *si);
+        assert(ti >= 0);
+    }
+    return ti;
+}
+
+
+/* Literals */
+
+/* Maximum length of literals taken from a regex */
+#define LIT_MAX 64
+
+/* Maximum number of NFA states to look for required literals in */
+#define LIT_MAX_STATES 512
+
+/* Add NFA state 's' (and everything reachable by epsilon transitions) to 'mark' */
+static void lit_add(ks_regex self, bool* mark, int s) {
+    if (s < 0 || mark[s]) return;
+    mark[s] = true;
+    if (self->states[s].kind == KS_REGEX_NFA_EPS) {
+        lit_add(self, mark, self->states[s].to0);
+        lit_add(self, mark, self->states[s].to1);
+    }
+}
+
+/* Return the only state in the closure of NFA state 's', if it is a single byte (and a match can't end before it),
+ *   or -1 otherwise
+ */
+static int lit_next(ks_regex self, bool* mark, int s) {
+    int i, res = -1, ct = 0;
+    lit_add(self, mark, s);
+    for (i = 0; i < self->n_states; ++i) {
+        if (mark[i]) {
+            mark[i] = false;
+            if (self->states[i].kind != KS_REGEX_NFA_EPS) {
+                res = i;
+                ct++;
+            }
+        }
+    }
+    return ct == 1 && self->states[res].kind == KS_REGEX_NFA_UCP && self->states[res].ucp < 256 ? res : -1;
+}
+
+/* Return whether the final NFA state can be reached from the start without going through 'avoid' */
+static bool lit_reach(ks_regex self, bool* mark, int* stk, int avoid) {
+    int n = 0, i;
+    bool res = false;
+    stk[n++] = self->s0;
+    mark[self->s0] = true;
+    while (n > 0) {
+        int s = stk[--n];
+        if (s == self->sf) {
+            res = true;
+            break;
+        }
+        int to[2] = { self->states[s].to0, self->states[s].to1 };
+        for (i = 0; i < 2; ++i) {
+            if (to[i] >= 0 && to[i] != avoid && !mark[to[i]]) {
+                mark[to[i]] = true;
+                stk[n++] = to[i];
+            }
+        }
+    }
+    for (i = 0; i < self->n_states; ++i) mark[i] = false;
+    return res;
+}
+
+/* Fill in the literals of a regex (see 'ks_regex') */
+static void lit_find(ks_regex self) {
+    bool* mark = ks_zmalloc(sizeof(*mark), self->n_states);
+    char tmp[LIT_MAX];
+    int i, n, u;
+    for (i = 0; i < self->n_states; ++i) mark[i] = false;
+
+    /* Follow the start state for as long as there is only one byte it could be */
+    n = 0;
+    for (u = lit_next(self, mark, self->s0); u >= 0 && n < LIT_MAX; u = lit_next(self, mark, self->states[u].to0)) {
+        tmp[n++] = self->states[u].ucp;
+    }
+    self->n_pre = n;
+    self->pre = n > 0 ? ks_malloc(n) : NULL;
+    if (n > 0) memcpy(self->pre, tmp, n);
+
+    /* Every match contains the bytes which every path from the start to the end goes through, so find the
+     *   longest run of those
+     */
+    self->n_req = 0;
+    self->req = NULL;
+    if (self->n_states <= LIT_MAX_STATES) {
+        int* stk = ks_malloc(sizeof(*stk) * self->n_states);
+        for (i = 0; i < self->n_states; ++i) {
+            if (self->states[i].kind != KS_REGEX_NFA_UCP || self->states[i].ucp >= 256 || lit_reach(self, mark, stk, i)) continue;
+
+            /* Bytes after a required byte which can only be a single byte are also required */
+            n = 0;
+            for (u = i; u >= 0 && n < LIT_MAX; u = lit_next(self, mark, self->states[u].to0)) {
+                tmp[n++] = self->states[u].ucp;
+            }
+            if (n > self->n_req) {
+                self->n_req = n;
+                self->req = ks_realloc(self->req, n);
+                memcpy(self->req, tmp, n);
+            }
+        }
+        ks_free(stk);
+    }
+
+    ks_free(mark);
+}
+
+
+/* Searching */
+
+/* Size of chunks read from streams */
+#define RX_CHUNK (64 * 1024)
+
+/* Whether a byte is in the middle of a UTF-8 character */
+#define RX_CONT(_c) (((_c) & 0xC0) == 0x80)
+
+/* Results of searching */
+enum {
+    /* No match was found. If the input isn't all read, then no match may start before '*start' */
+    RX_NONE = 0,
+
+    /* A match was found, from '*start' to '*stop' */
+    RX_FOUND,
+
+    /* A match may be found after reading more input, which would start at '*start' */
+    RX_MORE,
+};
+
+/* Find the longest match starting at 's' (see 'ks_regex_longest()') */
+static int rx_longest(ks_regex self, ks_regex_iter it, ks_size_t s, ks_size_t* stop) {
+    ks_ssize_t r = ks_regex_longest(self, it->len - s, (const char*)it->data + s, it->base_b + s == 0, it->eof, NULL);
+    if (r == -2) return RX_MORE;
+    if (r < 0) return RX_NONE;
+    *stop = s + r;
+    return RX_FOUND;
+}
+
+/* Add NFA state 's' (and everything reachable by epsilon transitions) to the threads in 'lst', as started at 'st',
+ *   unless it is already there
+ */
+static void rx_add(ks_regex self, ks_ssize_t* from, int* lst, int* n, int s, ks_ssize_t st) {
+    if (s < 0 || from[s] >= 0) return;
+    from[s] = st;
+    lst[(*n)++] = s;
+    if (self->states[s].kind == KS_REGEX_NFA_EPS) {
+        rx_add(self, from, lst, n, self->states[s].to0, st);
+        rx_add(self, from, lst, n, self->states[s].to1, st);
+    }
+}
+
+/* Find the leftmost start of a match in 'it', from 'lo' to 'q', in a single pass
+ *
+ * The NFA is simulated with the start of each thread ('from[s]' for NFA state 's'), and threads are kept in order
+ *   of their starts, so when two reach the same NFA state the earlier one wins. Once a match is found, only threads
+ *   which started before it can do better, so the rest are dropped
+ * 
+ * Returns 'RX_FOUND' with the start in '*start', 'RX_NONE', or 'RX_MORE' with the earliest start that may still
+ *   match in '*start'
+ */
+static int rx_leftmost(ks_regex self, ks_regex_iter it, ks_size_t lo, ks_size_t q, ks_size_t* start) {
+    const unsigned char* data = it->data;
+    ks_size_t len = it->len, p;
+    ks_ssize_t best = -1;
+    int ns = self->n_states, nc = 0, nn, i, res;
+
+    ks_ssize_t* from = ks_zmalloc(sizeof(*from), 2 * ns), *nfrom = from + ns, *tf;
+    int* cur = ks_zmalloc(sizeof(*cur), 2 * ns), *nxt = cur + ns, *tl;
+    for (i = 0; i < 2 * ns; ++i) from[i] = -1;
+
+    for (p = lo; ; ++p) {
+        bool bnd = p >= len || !RX_CONT(data[p]);
+
+        /* Start another thread, unless a match has been found (it would start later) */
+        if (best < 0 && p <= q && bnd) {
+            rx_add(self, from, cur, &nc, self->s0, p);
+            if (it->base_b + p == 0) {
+                for (i = 0; i < nc; ++i) {
+                    if (self->states[cur[i]].kind == KS_REGEX_NFA_LINESTART) rx_add(self, from, cur, &nc, self->states[cur[i]].to0, from[cur[i]]);
+                }
+            }
+        }
+        if (p >= len && it->eof) {
+            for (i = 0; i < nc; ++i) {
+                if (self->states[cur[i]].kind == KS_REGEX_NFA_LINEEND) rx_add(self, from, cur, &nc, self->states[cur[i]].to0, from[cur[i]]);
+            }
+        }
+
+        /* Matches only end at the start of a character */
+        if (bnd) {
+            for (i = 0; i < nc; ++i) {
+                if (self->states[cur[i]].kind == KS_REGEX_NFA_END && (best < 0 || from[cur[i]] < best)) best = from[cur[i]];
+            }
+        }
+        if (best >= 0) {
+            nn = 0;
+            for (i = 0; i < nc; ++i) {
+                if (from[cur[i]] < best) {
+                    cur[nn++] = cur[i];
+                } else {
+                    from[cur[i]] = -1;
+                }
+            }
+            nc = nn;
+        }
+
+        if (p >= len || (nc == 0 && (best >= 0 || p >= q))) break;
+
+        nn = 0;
+        for (i = 0; i < nc; ++i) {
+            struct ks_regex_nfa* s = &self->states[cur[i]];
+            if (nfa_accepts(s, data[p])) rx_add(self, nfrom, nxt, &nn, s->to0, from[cur[i]]);
+            from[cur[i]] = -1;
+        }
+        tf = from;
+        from = nfrom;
+        nfrom = tf;
+        tl = cur;
+        cur = nxt;
+        nxt = tl;
+        nc = nn;
+    }
+
+    if (nc > 0 && !it->eof) {
+        /* Threads from before the best match are still alive */
+        *start = from[cur[0]];
+        res = RX_MORE;
+    } else if (best >= 0) {
+        *start = best;
+        res = RX_FOUND;
+    } else {
+        res = RX_NONE;
+    }
+
+    ks_free(from < nfrom ? from : nfrom);
+    ks_free(cur < nxt ? cur : nxt);
+    return res;
+}
+
+/* Search for the leftmost-longest match in 'it', starting at 'it->pos'
+ *
+ * First, the unanchored DFA finds the earliest position a match ends at, and the last position before that at which
+ *   nothing earlier was still alive. The leftmost match must start between those. The first of those is tried with
+ *   the anchored DFA, since that is usually it, and otherwise 'rx_leftmost()' finds the start. Then, the anchored DFA
+ *   finds the longest match from there
+ */
+static int rx_search(ks_regex self, ks_regex_iter it, ks_size_t* start, ks_size_t* stop) {
+    ks_regex_dfa fwd = dfa_get(self, true);
+    const unsigned char* data = it->data;
+    ks_size_t len = it->len, pos = it->pos, q, lo, s;
+    ks_ssize_t r;
+    int si, res;
+
+    /* If the required literal isn't in the rest of the input, there can't be any more matches */
+    if (self->n_req > self->n_pre && it->eof && it->req_at < (ks_ssize_t)pos) {
+        r = ks_memfind(len - pos, (const char*)data + pos, self->n_req, self->req);
+        if (r < 0) return RX_NONE;
+        it->req_at = pos + r;
+    }
+
+    while (true) {
+        si = it->base_b + pos == 0 ? fwd->start : fwd->mid;
+        lo = q = pos;
+        bool found = fwd->states[si].acc;
+        while (!found && q < len) {
+            if (si == fwd->mid) {
+                /* Nothing from before 'q' is alive, so skip to where the prefix is */
+                lo = q;
+                if (self->n_pre > 0) {
+                    r = ks_memfind(len - q, (const char*)data + q, self->n_pre, self->pre);
+                    if (r < 0) {
+                        /* The prefix may be split at the end of the input */
+                        *start = len - q >= self->n_pre ? len - self->n_pre + 1 : q;
+                        return RX_NONE;
+                    }
+                    q += r;
+                    lo = q;
+                }
+            }
+            si = dfa_nextf(self, fwd, &si, data[q]);
+            q++;
+            found = fwd->states[si].acc;
+        }
+
+        if (!found) {
+            if (si == fwd->mid) lo = q;
+            if (!it->eof) {
+                *start = lo;
+                return RX_NONE;
+            }
+            int ti = dfa_eolf(self, fwd, &si);
+            if (!fwd->states[ti].acc) return RX_NONE;
+        }
+
+        /* Try the first start from 'lo' to 'q', and then the rest all at once (trying each in turn is quadratic) */
+        s = lo;
+        while (s <= q && s < len && RX_CONT(data[s])) s++;
+        if (s <= q && self->n_pre > 0) {
+            r = ks_memfind(len - s, (const char*)data + s, self->n_pre, self->pre);
+            s = r < 0 ? q + 1 : s + r;
+        }
+        if (s <= q) {
+            res = rx_longest(self, it, s, stop);
+            if (res == RX_NONE && s < q) {
+                res = rx_leftmost(self, it, s + 1, q, &s);
+                if (res == RX_FOUND) res = rx_longest(self, it, s, stop);
+            }
+            if (res != RX_NONE) {
+                *start = s;
+                return res;
+            }
+        }
+
+        /* Matches ending at 'q' only ended in the middle of characters, so look after it */
+        if (q >= len) {
+            *start = len;
+            return RX_NONE;
+        }
+        pos = q + 1;
+    }
+}
+
+/* Return the number of characters in 'it->data[a:b]' */
+static ks_cint it_count(ks_regex_iter it, ks_size_t a, ks_size_t b) {
+    if (it->ascii) return b - a;
+    ks_cint res = 0;
+    while (a < b) {
+        if (!RX_CONT(it->data[a])) res++;
+        a++;
+    }
+    return res;
+}
+
+/* Read another chunk of the stream, after discarding everything before 'it->pos' */
+static bool it_fill(ks_regex_iter it) {
+    if (it->pos > 0) {
+        memmove(it->buf, it->buf + it->pos, it->len - it->pos);
+        it->base_b += it->pos;
+        it->len -= it->pos;
+        it->req_at -= it->pos;
+        it->pos = 0;
+    }
+
+    /* Read at least as much as is kept, so that searching again is linear overall */
+    ks_size_t sz = it->len > RX_CHUNK ? it->len : RX_CHUNK;
+    if (it->len + sz > it->max_len) {
+        it->max_len = ks_nextsize(it->max_len, it->len + sz);
+        it->buf = ks_realloc(it->buf, it->max_len);
+    }
+
+    ks_ssize_t rsz = ksio_readb((ksio_BaseIO)it->src, sz, it->buf + it->len);
+    if (rsz < 0) return false;
+    if (rsz == 0) it->eof = true;
+    it->len += rsz;
+    it->data = it->buf;
+    return true;
+}
+
+/* Find the next match, storing its positions in 'it->data' in '*start' and '*stop' (and its positions in
+ *   characters in '*start_c' and '*stop_c')
+ * 
+ * Returns 1 if a match was found, 0 if there are no more, or -1 if an error was thrown
+ */
+static int it_step(ks_regex_iter it, ks_size_t* start, ks_size_t* stop, ks_cint* start_c, ks_cint* stop_c) {
+    ks_size_t s = 0, e = 0;
+    while (!it->done) {
+        int res = rx_search(it->pat, it, &s, &e);
+        if (res == RX_FOUND) {
+            *start = s;
+            *stop = e;
+            *start_c = it->pos_c + it_count(it, it->pos, s);
+            *stop_c = *start_c + it_count(it, s, e);
+
+            /* Continue after the match, or after the next character for an empty match */
+            it->pos = e;
+            it->pos_c = *stop_c;
+            if (s == e) {
+                if (e >= it->len) {
+                    it->done = true;
+                } else {
+                    it->pos++;
+                    while (it->pos < it->len && RX_CONT(it->data[it->pos])) it->pos++;
+                    it->pos_c++;
+                }
+            }
+            return 1;
+        } else if (res == RX_NONE && it->eof) {
+            it->done = true;
+            break;
+        }
+
+        /* Read more, and keep everything from 's' */
+        it->pos_c += it_count(it, it->pos, s);
+        it->pos = s;
+        if (!it_fill(it)) return -1;
+    }
+
+    return 0;
+}
+
+/* Create a match object (which takes the reference to 'val') */
+static ks_regex_match match_new(ks_regex pat, ks_str val, ks_cint start, ks_cint stop) {
+    ks_regex_match self = KSO_NEW(ks_regex_match, kst_regex_match);
+
+    KS_INCREF(pat);
+    self->pat = pat;
+    self->val = val;
+    self->start = start;
+    self->stop = stop;
+
+    return self;
+}
+
+
+
 /* C-API */
 
 ks_regex ks_regex_newt(ks_type tp, ks_str expr) {
@@ -519,6 +1257,8 @@ ks_regex ks_regex_newt(ks_type tp, ks_str expr) {
 
     self->n_states = ps->n_states;
     self->states = ps->states;
+
+    lit_find(self);
     return self;
 }
 
@@ -538,7 +1278,7 @@ ks_regex ks_regex_newlit(ks_str expr) {
             break;
         }
 
-        if (c == '\\' || c == '[' || c == '(' || c == '*' || c == '+' || c == '?') {
+        if (c == '\\' || c == '[' || c == ']' || c == '(' || c == ')' || c == '*' || c == '+' || c == '?' || c == '|' || c == '.' || c == '^' || c == '$') {
             ksio_add(sio, "\\%c", c);
         } else {
             ksio_add(sio, "%c", c);
@@ -554,28 +1294,97 @@ ks_regex ks_regex_newlit(ks_str expr) {
 
 
 
+ks_regex ks_regex_union(ks_cint n, ks_regex* elems, ks_cint* ends) {
+    assert(n > 0);
+    ksio_StringIO sio = ksio_StringIO_new();
+    ks_cint i, j;
+
+    /* Each regex is copied in order, followed by a chain of states choosing between them */
+    int n_states = n - 1;
+    for (i = 0; i < n; ++i) {
+        ksio_add(sio, "%s(%S)", i > 0 ? "|" : "", elems[i]->expr);
+        n_states += elems[i]->n_states;
+    }
+
+    ks_regex self = KSO_NEW(ks_regex, kst_regex);
+    self->expr = ksio_StringIO_getf(sio);
+    self->n_states = n_states;
+    self->states = ks_zmalloc(sizeof(*self->states), n_states);
+
+    int off = 0, *s0s = ks_malloc(sizeof(*s0s) * n);
+    for (i = 0; i < n; ++i) {
+        ks_regex e = elems[i];
+        for (j = 0; j < e->n_states; ++j) {
+            struct ks_regex_nfa* s = &self->states[off + j];
+            *s = e->states[j];
+            if (s->to0 >= 0) s->to0 += off;
+            if (s->to1 >= 0) s->to1 += off;
+            if (s->kind == KS_REGEX_NFA_ANY || s->kind == KS_REGEX_NFA_NOT) {
+                s->set.has_byte = ks_zmalloc(sizeof(bool), 256);
+                memcpy(s->set.has_byte, e->states[j].set.has_byte, sizeof(bool) * 256);
+                s->set.has_cat = ks_zmalloc(sizeof(bool), 64);
+                memcpy(s->set.has_cat, e->states[j].set.has_cat, sizeof(bool) * 64);
+                s->set.ext = s->set.n_ext > 0 ? ks_malloc(sizeof(*s->set.ext) * s->set.n_ext) : NULL;
+                if (s->set.n_ext > 0) memcpy(s->set.ext, e->states[j].set.ext, sizeof(*s->set.ext) * s->set.n_ext);
+            }
+        }
+        s0s[i] = off + e->s0;
+        if (ends) ends[i] = off + e->sf;
+        off += e->n_states;
+    }
+
+    /* Choose between the start states */
+    self->s0 = s0s[n - 1];
+    for (i = n - 2; i >= 0; --i) {
+        struct ks_regex_nfa* s = &self->states[off + i];
+        s->kind = KS_REGEX_NFA_EPS;
+        s->to0 = s0s[i];
+        s->to1 = self->s0;
+        self->s0 = off + i;
+    }
+    ks_free(s0s);
+
+    self->sf = elems[0]->sf;
+    self->n_pre = self->n_req = 0;
+    self->pre = self->req = NULL;
+    return self;
+}
+
+
 /* High level interface */
 
 bool ks_regex_exact(ks_regex self, ks_str str) {
-    ks_regex_sim0 sim;
-    ks_regex_sim0_init(&sim, self->n_states, self->states);
+    ks_regex_dfa dfa = dfa_get(self, false);
 
-    int i;
+    const unsigned char* p = (const unsigned char*)str->data;
+    const unsigned char* e = p + str->len_b;
 
-    /* Start at the initial state */
-    ks_regex_sim0_addcur(&sim, self->s0);
+    /* Step through input */
+    int si = dfa->start, ti;
+    while (si >= 0 && p < e) {
+        ti = dfa_next(self, dfa, si, *p);
+        if (ti < 0) break;
+        si = ti;
+        p++;
 
-    ks_regex_sim0_step_linestart(&sim);
+        /* No NFA states left, so it can't match */
+        if (dfa->states[si].n_nfa == 0) return false;
+    }
 
+    if (si >= 0 && p == e) {
+        /* Check if a valid end state */
+        ti = dfa_eol(self, dfa, si);
+        if (ti >= 0) return dfa->states[ti].acc;
+    }
 
-    /* Step through input */
-    const char* p = str->data;
-    while (*p) {
+    /* Out of memory for the DFA, so continue with the NFA */
+    ks_regex_sim0 sim;
+    dfa_tosim(self, dfa, si, &sim);
+    while (p < e) {
         ks_regex_sim0_step(&sim, *p);
         p++;
     }
 
-    /* Check if a valid end state */
     ks_regex_sim0_step_lineend(&sim);
 
     bool res = sim.cur[self->sf];
@@ -584,17 +1393,30 @@ bool ks_regex_exact(ks_regex self, ks_str str) {
 }
 
 bool ks_regex_matches(ks_regex self, ks_str str) {
-    ks_regex_sim0 sim;
-    ks_regex_sim0_init(&sim, self->n_states, self->states);
+    ks_regex_dfa dfa = dfa_get(self, true);
 
-    int i;
-    ks_regex_sim0_addcur(&sim, self->s0);
-    ks_regex_sim0_step_linestart(&sim);
+    const unsigned char* p = (const unsigned char*)str->data;
+    const unsigned char* e = p + str->len_b;
 
+    /* Step through input (the DFA adds the start state back after each byte) */
+    int si = dfa->start, ti;
+    while (si >= 0 && p < e) {
+        ti = dfa_next(self, dfa, si, *p);
+        if (ti < 0) break;
+        si = ti;
+        p++;
+        if (dfa->states[si].acc) return true;
+    }
 
-    /* Step through input */
-    const char* p = str->data;
-    while (*p) {
+    if (si >= 0 && p == e) {
+        ti = dfa_eol(self, dfa, si);
+        if (ti >= 0) return dfa->states[ti].acc;
+    }
+
+    /* Out of memory for the DFA, so continue with the NFA */
+    ks_regex_sim0 sim;
+    dfa_tosim(self, dfa, si, &sim);
+    while (p < e) {
         ks_regex_sim0_step(&sim, *p);
         if (sim.cur[self->sf]) {
             ks_regex_sim0_free(&sim);
@@ -613,6 +1435,154 @@ bool ks_regex_matches(ks_regex self, ks_str str) {
 }
 
 
+ks_ssize_t ks_regex_longest(ks_regex self, ks_ssize_t len_b, const char* data, bool bol, bool eof, int* tag) {
+    ks_regex_dfa dfa = dfa_get(self, false);
+    const unsigned char* p = (const unsigned char*)data;
+    ks_ssize_t q = 0, best = -1;
+
+    int si = bol ? dfa->start : dfa->mid, ti;
+    while (true) {
+        if (q == len_b) {
+            if (!eof) {
+                /* The match may go on */
+                if (dfa->states[si].n_nfa > 0) return -2;
+                break;
+            }
+            ti = dfa_eolf(self, dfa, &si);
+            if (dfa->states[ti].acc) {
+                best = q;
+                if (tag) *tag = dfa->states[ti].tag;
+            }
+            break;
+        }
+
+        /* Matches only end at the start of a character */
+        if (dfa->states[si].acc && !RX_CONT(p[q])) {
+            best = q;
+            if (tag) *tag = dfa->states[si].tag;
+        }
+        si = dfa_nextf(self, dfa, &si, p[q]);
+        q++;
+
+        /* Nothing else can match */
+        if (dfa->states[si].n_nfa == 0) break;
+    }
+
+    return best;
+}
+
+ks_regex_iter ks_regex_iter_new(ks_regex self, kso src) {
+    bool is_str = kso_issub(src->type, kst_str);
+    if (!is_str && !kso_issub(src->type, ksiot_BaseIO)) {
+        KS_THROW(kst_TypeError, "Expected 'src' to be a 'str' or 'io.BaseIO', but got '%T' object", src);
+        return NULL;
+    }
+
+    ks_regex_iter it = KSO_NEW(ks_regex_iter, kst_regex_iter);
+
+    KS_INCREF(self);
+    it->pat = self;
+    KS_INCREF(src);
+    it->src = src;
+
+    it->buf = NULL;
+    it->max_len = 0;
+    it->pos = it->pos_c = it->base_b = 0;
+    it->req_at = -1;
+    it->done = false;
+
+    if (is_str) {
+        /* Strings are searched in place */
+        it->data = (const unsigned char*)((ks_str)src)->data;
+        it->len = ((ks_str)src)->len_b;
+        it->eof = true;
+        it->ascii = KS_STR_IS_ASCII((ks_str)src);
+    } else {
+        it->data = NULL;
+        it->len = 0;
+        it->eof = false;
+        it->ascii = false;
+    }
+
+    return it;
+}
+
+kso ks_regex_search(ks_regex self, kso src) {
+    ks_regex_iter it = ks_regex_iter_new(self, src);
+    if (!it) return NULL;
+
+    ks_size_t s, e;
+    ks_cint sc, ec;
+    int r = it_step(it, &s, &e, &sc, &ec);
+    kso res = NULL;
+    if (r > 0) {
+        res = (kso)match_new(self, ks_str_new(e - s, (const char*)it->data + s), sc, ec);
+    } else if (r == 0) {
+        res = KSO_NONE;
+    }
+
+    KS_DECREF(it);
+    return res;
+}
+
+ks_list ks_regex_findall(ks_regex self, kso src) {
+    ks_regex_iter it = ks_regex_iter_new(self, src);
+    if (!it) return NULL;
+
+    ks_list res = ks_list_new(0, NULL);
+    ks_size_t s, e;
+    ks_cint sc, ec;
+    int r;
+    while ((r = it_step(it, &s, &e, &sc, &ec)) > 0) {
+        ks_list_pushu(res, (kso)ks_str_new(e - s, (const char*)it->data + s));
+    }
+
+    KS_DECREF(it);
+    if (r < 0) {
+        KS_DECREF(res);
+        return NULL;
+    }
+    return res;
+}
+
+ks_str ks_regex_sub(ks_regex self, kso repl, ks_str src, ks_cint count) {
+    bool is_str = kso_issub(repl->type, kst_str);
+    ks_regex_iter it = ks_regex_iter_new(self, (kso)src);
+    if (!it) return NULL;
+
+    ksio_StringIO sio = ksio_StringIO_new();
+    ks_size_t s, e, last = 0;
+    ks_cint sc, ec, n = 0;
+    int r = 0;
+    while ((count < 0 || n < count) && (r = it_step(it, &s, &e, &sc, &ec)) > 0) {
+        ksio_addbuf(sio, s - last, src->data + last);
+        if (is_str) {
+            ksio_addbuf(sio, ((ks_str)repl)->len_b, ((ks_str)repl)->data);
+        } else {
+            ks_regex_match m = match_new(self, ks_str_new(e - s, src->data + s), sc, ec);
+            kso rs = kso_call(repl, 1, (kso[]){ (kso)m });
+            KS_DECREF(m);
+            if (!rs) {
+                r = -1;
+                break;
+            }
+            ksio_add(sio, "%S", rs);
+            KS_DECREF(rs);
+        }
+        last = e;
+        n++;
+    }
+    KS_DECREF(it);
+
+    if (r < 0) {
+        KS_DECREF(sio);
+        return NULL;
+    }
+    ksio_addbuf(sio, src->len_b - last, src->data + last);
+    return ksio_StringIO_getf(sio);
+}
+
+
 /* sim0 */
 
 
@@ -702,61 +1672,12 @@ int ks_regex_sim0_step_lineend(ks_regex_sim0* sim) {
 /* Apply a single character to the simulator
  */
 int ks_regex_sim0_step(ks_regex_sim0* sim, ks_ucp c) {
-    int i, j, ct = 0;
+    int i, ct = 0;
     for (i = 0; i < sim->n_states; ++i) sim->next[i] = false;
     for (i = 0; i < sim->n_states; ++i) {
-        if (sim->cur[i]) {
-            struct ks_regex_nfa* s = &sim->states[i];
-            bool good = false;
-
-            /* Check classes */
-            if (s->kind == KS_REGEX_NFA_ANY) {
-                if (c < 256) {
-                    good = s->set.has_byte[c];
-                } else {
-                    for (j = 0; j < s->set.n_ext; ++j) {
-                        if (c == s->set.ext[j]) {
-                            good = true;
-                            break;
-                        }
-                    }
-                }
-
-                if (good) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_NOT) {
-                if (c < 256) {
-                    good = s->set.has_byte[c];
-                } else {
-                    for (j = 0; j < s->set.n_ext; ++j) {
-                        if (c == s->set.ext[j]) {
-                            good = true;
-                            break;
-                        }
-                    }
-                }
-
-                if (!good) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_UCP) {
-                if (s->ucp == c) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_CAT) {
-                struct ksucd_info info;
-                ks_ucp cp = ksucd_get_info(&info, c);
-                if (cp > 0) {
-                    if (s->set.has_cat[info.cat_gen]) {
-                        ct++;
-                        ks_regex_sim0_addnext(sim, s->to0);
-                    }
-                }
-            }
+        if (sim->cur[i] && nfa_accepts(&sim->states[i], c)) {
+            ct++;
+            ks_regex_sim0_addnext(sim, sim->states[i].to0);
         }
     }
 
@@ -776,6 +1697,10 @@ static KS_TFUNC(T, free) {
 
     KS_DECREF(self->expr);
 
+    ks_free(self->pre);
+    ks_free(self->req);
+    dfa_free(self->dfa[0]);
+    dfa_free(self->dfa[1]);
     free_nfa(self->n_states, self->states);
     ks_free(self->states);
 
@@ -840,7 +1765,7 @@ static KS_TFUNC(T, graph) {
             for (j = 0; j < 256; ++j) {
                 if (self->states[i].set.has_byte[j]) {
                     ks_str c = ks_str_chr(j);
-                    ks_set_add_h(r, (kso)c, c->v_hash);
+                    ks_set_add_h(r, (kso)c, KS_STR_HASH(c));
                     KS_DECREF(c);
                 }
             }
@@ -887,15 +1812,144 @@ static KS_TFUNC(T, matches) {
 }
 
 
+static KS_TFUNC(T, search) {
+    ks_regex self;
+    kso src;
+    KS_ARGS("self:* src", &self, kst_regex, &src);
+
+    return ks_regex_search(self, src);
+}
+
+static KS_TFUNC(T, findall) {
+    ks_regex self;
+    kso src;
+    KS_ARGS("self:* src", &self, kst_regex, &src);
+
+    return (kso)ks_regex_findall(self, src);
+}
+
+static KS_TFUNC(T, finditer) {
+    ks_regex self;
+    kso src;
+    KS_ARGS("self:* src", &self, kst_regex, &src);
+
+    return (kso)ks_regex_iter_new(self, src);
+}
+
+static KS_TFUNC(T, sub) {
+    ks_regex self;
+    kso repl;
+    ks_str src;
+    ks_cint count = -1;
+    KS_ARGS("self:* repl src:* ?count:cint", &self, kst_regex, &repl, &src, kst_str, &count);
+
+    return (kso)ks_regex_sub(self, repl, src, count);
+}
+
+
+/** Matches **/
+
+static KS_TFUNC(TM, free) {
+    ks_regex_match self;
+    KS_ARGS("self:*", &self, kst_regex_match);
+
+    KS_DECREF(self->pat);
+    KS_DECREF(self->val);
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TM, str) {
+    ks_regex_match self;
+    KS_ARGS("self:*", &self, kst_regex_match);
+
+    return (kso)ks_fmt("%T(%l, %l, %R)", self, self->start, self->stop, self->val);
+}
+
+static KS_TFUNC(TM, getattr) {
+    ks_regex_match self;
+    ks_str attr;
+    KS_ARGS("self:* attr:*", &self, kst_regex_match, &attr, kst_str);
+
+    if (ks_str_eq_c(attr, "start", 5)) {
+        return (kso)ks_int_new(self->start);
+    } else if (ks_str_eq_c(attr, "stop", 4)) {
+        return (kso)ks_int_new(self->stop);
+    } else if (ks_str_eq_c(attr, "val", 3)) {
+        return KS_NEWREF(self->val);
+    } else if (ks_str_eq_c(attr, "pat", 3)) {
+        return KS_NEWREF(self->pat);
+    }
+
+    KS_THROW_ATTR(self, attr);
+    return NULL;
+}
+
+
+/** Iterators **/
+
+static KS_TFUNC(TI, free) {
+    ks_regex_iter self;
+    KS_ARGS("self:*", &self, kst_regex_iter);
+
+    KS_DECREF(self->pat);
+    KS_DECREF(self->src);
+    ks_free(self->buf);
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static bool TI_next(kso ob, kso* res) {
+    ks_regex_iter self = (ks_regex_iter)ob;
+
+    ks_size_t s, e;
+    ks_cint sc, ec;
+    int r = it_step(self, &s, &e, &sc, &ec);
+    if (r < 0) return false;
+
+    *res = r == 0 ? NULL : (kso)match_new(self->pat, ks_str_new(e - s, (const char*)self->data + s), sc, ec);
+    return true;
+}
+
+static KS_TFUNC(TI, next) {
+    ks_regex_iter self;
+    KS_ARGS("self:*", &self, kst_regex_iter);
+
+    return kso_next_f(TI_next, (kso)self);
+}
+
+
+
 /* Export */
 
 static struct ks_type_s tp;
 ks_type kst_regex = &tp;
 
+static struct ks_type_s tp_match;
+ks_type kst_regex_match = &tp_match;
+
+static struct ks_type_s tp_iter;
+ks_type kst_regex_iter = &tp_iter;
+
 
 void _ksi_regex() {
 
-    _ksinit(kst_regex, kst_object, T_NAME, sizeof(struct ks_str_s), -1, "String (i.e. a collection of Unicode characters)\n\n    Indicies, operations, and so forth take character positions, not byte positions", KS_IKV(
+    _ksinit(kst_regex_match, kst_object, TM_NAME, sizeof(struct ks_regex_match_s), -1, "Match of a regular expression, with the matched text ('.val') and its position in characters in the input ('.start' and '.stop')", KS_IKV(
+        {"__free",               ksf_wrap(TM_free_, TM_NAME ".__free(self)", "")},
+        {"__repr",               ksf_wrap(TM_str_, TM_NAME ".__repr(self)", "")},
+        {"__str",                ksf_wrap(TM_str_, TM_NAME ".__str(self)", "")},
+        {"__getattr",            ksf_wrap(TM_getattr_, TM_NAME ".__getattr(self, attr)", "")},
+    ));
+
+    _ksinit(kst_regex_iter, kst_object, TI_NAME, sizeof(struct ks_regex_iter_s), -1, "", KS_IKV(
+        {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
+        {"__next",               ksf_wrap(TI_next_, TI_NAME ".__next(self)", "")},
+    ));
+    kst_regex_iter->ob_next = TI_next;
+
+    _ksinit(kst_regex, kst_object, T_NAME, sizeof(struct ks_regex_s), -1, "Regular expression, which can be used to match strings", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, expr)", "")},
         {"__repr",               ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
@@ -903,6 +1957,10 @@ void _ksi_regex() {
         {"__graph",              ksf_wrap(T_graph_, T_NAME ".__graph(self)", "")},
         {"exact",                ksf_wrap(T_exact_, T_NAME ".exact(self, src)", "Calculate whether the regular expression matches the string exactly")},
         {"matches",              ksf_wrap(T_matches_, T_NAME ".matches(self, src)", "Calculate whether the regular expression matches the string anywhere (this returns a bool)")},
+        {"search",               ksf_wrap(T_search_, T_NAME ".search(self, src)", "Find the first (leftmost-longest) match of the regular expression in 'src', which may be a string or an 'io.BaseIO' (which is read in chunks), returning a 'regex.match' or 'none'")},
+        {"findall",              ksf_wrap(T_findall_, T_NAME ".findall(self, src)", "Return a list of the text of every (non-overlapping) match of the regular expression in 'src' (see 'regex.search()')")},
+        {"finditer",             ksf_wrap(T_finditer_, T_NAME ".finditer(self, src)", "Return an iterator over the (non-overlapping) matches of the regular expression in 'src', as 'regex.match' objects (see 'regex.search()')")},
+        {"sub",                  ksf_wrap(T_sub_, T_NAME ".sub(self, repl, src, count=-1)", "Return 'src' with the matches of the regular expression replaced with 'repl', which may be a string or a function taking a 'regex.match' and returning a string\n\n    If 'count >= 0', only the first 'count' matches are replaced")},
 
     ));
 }
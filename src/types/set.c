@@ -20,15 +20,24 @@
 /* New/target load factor for rehashing */
 #define S_LOAD_NEW       (0.3)
 
-/* Maximum proportion of holes in the entries array. Once the ratio exceeds this, holes are filled */
-#define S_HOLES_MAX      (0.5)
+/* Minimum number of buckets (must be a power of two) */
+#define S_MIN_BUCKETS    (8)
+
+/* Number of bits of the hash shifted into the probe sequence on each step (see 's_search()') */
+#define S_PERTURB_SHIFT  (5)
+
+/* Fingerprint of a hash, stored for each bucket
+ * These are the high bits of the hash, since the low bits were already used to pick the bucket
+ */
+#define S_TAG(_hash)     ((ks_uint8_t)((_hash) >> (8 * sizeof(ks_hash_t) - 8)))
 
 
 /* Template to conditionally execute different code based on size 
  * 
  * Since hash tables use different sized indices for different number of entries, this macro allows
  *   clean code that doesn't manually select the buckets array. You can use '__buckets' which will be set
- *   to the relevant one for a given set and length of entries
+ *   to the relevant one for a given set and length of entries, and '__tags', which are the fingerprints
+ *   of the hash for each bucket (stored after the buckets, in the same allocation)
  * 
  * Note that this should be the length of the entries array (->len_ents), not the number of entries, which may be different
  *   
@@ -37,184 +46,144 @@
 #define S_T_SIZE(_self, _len_ents, ...) do { \
     /****/ if (_len_ents < KS_SINT8_MAX) {                 \
         ks_sint8_t* __buckets = self->buckets_s8;          \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else if (_len_ents < KS_SINT16_MAX) {                \
         ks_sint16_t* __buckets = self->buckets_s16;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else if (_len_ents < KS_SINT32_MAX) {                \
         ks_sint32_t* __buckets = self->buckets_s32;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     } else {                                               \
         ks_sint64_t* __buckets = self->buckets_s64;        \
+        ks_uint8_t* __tags = (ks_uint8_t*)(__buckets + self->len_buckets); \
+        (void)__tags;                                      \
         { __VA_ARGS__; };                                  \
     }                                                      \
 } while (0)
 
 
-/* Calculate real load factor */
-static double s_load(ks_set self) {
-    return self->len_buckets > 0 ? (double)self->len_ents / self->len_buckets : 0.0;
-}
-
-
 /* Search through the hash table for a given hash and key 
  *
- * Sets 'rb' to the bucket at which the key was located, OR the first bucket that was empty, OR
+ * The number of buckets is a power of two, so the first bucket is just the low bits of the hash. Afterwards,
+ *   the rest of the hash is shifted into the probe sequence (called 'perturbation'), so keys whose hashes only
+ *   differ in the high bits don't collide all the way. Once all bits are used, it becomes 'bi = 5 * bi + 1',
+ *   which visits every bucket
+ *
+ * Most buckets whose keys don't match are rejected by their fingerprint, without reading the entries array
+ *
+ * Sets 'rb' to the bucket at which the key was located, OR the first bucket that was empty or deleted, OR
  *   -1 if the hash table was full
  * Sets 're' to the index in the arrays of entries, or -1 if it was not found
  * 
  * Returns true if the operation completed, false if an error was thrown
  */
 static bool s_search(ks_set self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_ssize_t* re) {
-    if (self->len_buckets <= 0) {
-        /* no elements, but avoid modulo by 0 */
-        *rb = *re = -1;
-        return true;
-    }
-
-    /* Calculate bucket index based on hash */
-    ks_size_t bi = hash % self->len_buckets;
-
-    /* First bucket index, and number of tries thus far */
-    ks_size_t bi0 = bi, tries = 0;
-
-    do {
-        /* Element index (>=0 means valid, < 0 means special case) */
-        ks_ssize_t ei;
-        S_T_SIZE(self, self->len_ents,
-            ei = __buckets[bi];
-        );
+    *rb = *re = -1;
+    if (self->len_buckets <= 0) return true;
 
+    ks_size_t mask = self->len_buckets - 1, bi = hash & mask, perturb = hash, tries;
+    ks_uint8_t tag = S_TAG(hash);
 
-        /****/ if (ei == B_EMPTY) {
-            /* Hit an empty bucket, so the key was not present. However, it can now be inserted here, so signal that */
-            *rb = bi;
-            *re = -1;
-            return true;
-        } else if (ei == B_DELETED) {
-            /* Skip deleted entries, so that we don't break existing keys */
-        } else if (self->ents[ei].hash == hash) {
-            /* Hashes match exactly, now determine whether the objects are eqaully (identically, or via 'A == B') */
-            bool is_eq = self->ents[ei].key == key;
-
-            if (!is_eq) {
-                /* Determine via comparison */
-                if (!kso_eq(self->ents[ei].key, key, &is_eq)) return false;
-            }
+    S_T_SIZE(self, self->len_ents,
+        for (tries = 0; tries < self->len_buckets + 8 * sizeof(hash) / S_PERTURB_SHIFT + 1; ++tries) {
+            /* Element index (>=0 means valid, < 0 means special case) */
+            ks_ssize_t ei = __buckets[bi];
 
-            if (is_eq) {
-                /* Successfully found it */
-                *rb = bi;
-                *re = ei;
+            /****/ if (ei == B_EMPTY) {
+                /* Hit an empty bucket, so the key was not present. However, it can now be inserted, so signal that */
+                if (*rb < 0) *rb = bi;
                 return true;
+            } else if (ei == B_DELETED) {
+                /* Skip deleted entries, so that we don't break existing keys (but they can be reused) */
+                if (*rb < 0) *rb = bi;
+            } else if (__tags[bi] == tag && self->ents[ei].hash == hash) {
+                /* Hashes match exactly, now determine whether the objects are eqaully (identically, or via 'A == B') */
+                bool is_eq = self->ents[ei].key == key;
+
+                if (!is_eq) {
+                    /* Determine via comparison */
+                    if (!kso_eq(self->ents[ei].key, key, &is_eq)) return false;
+                }
+
+                if (is_eq) {
+                    /* Successfully found it */
+                    *rb = bi;
+                    *re = ei;
+                    return true;
+                }
             }
-        }
-
-        /* Probe for the next bucket in the hash table
-         *
-         * For now, we use linear probing
-         */
-        bi = (bi + 1) % self->len_buckets;
-
-    } while (bi != bi0);
-
-    /* Not found, and no room to insert, so signal that */
-    *rb = *re = -1;
-    return -1;
-}
-
-/* Fill holes in the entries array of 'self'
- *
- * Returns true if the operation completed, false if an error was thrown
- */
-static bool s_fill_holes(ks_set self) {
-
-    if (self->len_ents <= self->len_real || self->len_ents <= 0) return true;
-
-    ks_ssize_t* em = ks_zmalloc(self->len_ents, sizeof(*em));
-    if (!em) {
-        //KS_THROW_OUTOFMEM();
-        return false;
-    }
-
-    /* Calculate index translation map for the entries */
-    ks_size_t i, j = 0;
-
-    for (i = 0; i < self->len_ents; ++i) {
-        em[i] = j;
-        if (self->ents[i].key != NULL) j++;
-    }
 
-
-    /* Replace current indices with new indices */
-    for (i = 0; i < self->len_ents; ++i) self->ents[em[i]] = self->ents[i];
-    S_T_SIZE(self, self->len_ents,
-        for (i = 0; i < self->len_buckets; ++i) if (__buckets[i] >= 0)
-            __buckets[i] = em[__buckets[i]];
+            /* Probe for the next bucket in the hash table */
+            perturb >>= S_PERTURB_SHIFT;
+            bi = (5 * bi + perturb + 1) & mask;
+        }
     );
 
-    ks_free(em);
+    /* Not found (and there may be no room to insert) */
     return true;
 }
 
-/* Resize and rehash the hash table to hold at least 'new_len_buckets'
+/* Resize and rehash the hash table for the current entries
+ *
+ * Deleted entries are removed first (which changes the indices of entries), and then the number of buckets is
+ *   chosen so the load factor is at most 'S_LOAD_NEW'. This must also be called when the length of the entries
+ *   array needs wider indices in the buckets
  *
  * Returns true if the operation completed, false if an error was thrown
  */
-static bool s_resize(ks_set self, ks_size_t new_len_buckets) {
-    new_len_buckets = ks_nextprime(new_len_buckets);
-    if (self->len_buckets >= new_len_buckets) return true;
+static bool s_resize(ks_set self) {
+    ks_size_t i, j;
 
-    ks_size_t i;
+    /* Fill holes in the entries array */
+    if (self->len_real < self->len_ents) {
+        for (i = j = 0; i < self->len_ents; ++i) {
+            if (self->ents[i].key) self->ents[j++] = self->ents[i];
+        }
+        self->len_ents = j;
+    }
+
+    ks_size_t new_len_buckets = S_MIN_BUCKETS;
+    while (new_len_buckets * S_LOAD_NEW < self->len_ents) new_len_buckets *= 2;
 
-    /* Calculate required size of buckets array */
+    /* Calculate required size of buckets array (including the tags) */
     ks_size_t new_bucket_sz = 0;
     S_T_SIZE(self, self->len_ents, 
-        new_bucket_sz = sizeof(*__buckets) * new_len_buckets;
+        new_bucket_sz = (sizeof(*__buckets) + sizeof(*__tags)) * new_len_buckets;
     );
 
     /* Reallocate buckets array if we need to */
     if (new_bucket_sz > self->_max_len_buckets_b) {
         self->_max_len_buckets_b = ks_nextsize(self->_max_len_buckets_b, new_bucket_sz);
-
         self->buckets_s8 = ks_realloc(self->buckets_s8, self->_max_len_buckets_b);
-        //if (!new_buckets) {
-            /* No memory */
-        //}
     }
 
-    /* Update and clear all buckets */
+    /* Update and clear all buckets, and then add each entry to the first empty bucket in its sequence */
     self->len_buckets = new_len_buckets;
+    ks_size_t mask = new_len_buckets - 1;
     S_T_SIZE(self, self->len_ents, 
-        for (i = 0; i < self->len_buckets; ++i) __buckets[i] = B_EMPTY;
+        for (i = 0; i < new_len_buckets; ++i) __buckets[i] = B_EMPTY;
+
+        for (i = 0; i < self->len_ents; ++i) {
+            ks_hash_t hash = self->ents[i].hash;
+            ks_size_t bi = hash & mask, perturb = hash;
+            while (__buckets[bi] != B_EMPTY) {
+                perturb >>= S_PERTURB_SHIFT;
+                bi = (5 * bi + perturb + 1) & mask;
+            }
+            __buckets[bi] = i;
+            __tags[bi] = S_TAG(hash);
+        }
     );
 
-    /* Now, rehash the buckets */
-    ks_size_t ct = 0;
-    while (self->len_ents > 0 && self->ents[self->len_ents - 1].key == NULL) {
-        self->len_ents--;
-        self->len_real--;
-    }
-    for (i = 0; i < self->len_ents; ++i) {
-        struct ks_set_ent* ent = &self->ents[i];
-        if (ent->key) {
-            ks_ssize_t rb, re;
-            if (!s_search(self, ent->key, ent->hash, &rb, &re)) return false;
-            assert(re < 0 && rb >= 0);
-
-            S_T_SIZE(self, self->len_ents, 
-                __buckets[rb] = i;
-            );
-
-            ct++;
-        }
-    }
-    
-    assert(self->len_real == ct);
-    return self->len_ents * S_HOLES_MAX >= self->len_real ? s_fill_holes(self) : true;
+    return true;
 }
 
-
 /* C-API */
 
 ks_set ks_set_new(ks_cint len, kso* elems) {
@@ -244,10 +213,6 @@ void ks_set_clear(ks_set self) {
             KS_DECREF(self->ents[i].key);
         }
     }
-    S_T_SIZE(self, self->len_ents, 
-        for (i = 0; i < self->len_buckets; ++i) __buckets[i] = B_EMPTY;
-    );
-
     self->len_buckets = 0;
     self->len_real = self->len_ents = 0;
 }
@@ -260,16 +225,10 @@ bool ks_set_add(ks_set self, kso key) {
 
 bool ks_set_add_h(ks_set self, kso key, ks_hash_t hash) {
     ks_ssize_t rb, re;
-
-    /* Resize if needed */
-    if (s_load(self) > S_LOAD_MAX || self->len_buckets == 0)
-        if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
-            return false;
-
     if (!s_search(self, key, hash, &rb, &re)) return false;
 
     if (re < 0) {
-        /* Not found, so add to the setionary*/
+        /* Not found, so add to the set */
         
         re = self->len_ents++;
         if (self->len_ents > self->_max_len_ents) {
@@ -285,22 +244,15 @@ bool ks_set_add_h(ks_set self, kso key, ks_hash_t hash) {
         self->ents[re].hash = hash;
         self->ents[re].key = key;
 
-        /* Add buckets if needed */
-        if (rb < 0 || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
-            /* No bucket found, we need to resize/fill holes */
-            if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
-                return false;
-
-            /* Now, refind it */
-            ks_ssize_t new_re;
-            if (!s_search(self, key, hash, &rb, &new_re)) return false;
-
-            assert(rb >= 0 && re == new_re);
+        /* Resize if there was no bucket, the table is too full, or the buckets need wider indices (this adds the new entry too) */
+        if (rb < 0 || self->len_ents > self->len_buckets * S_LOAD_MAX || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
+            return s_resize(self);
         }
 
         /* Set the bucket to point to it */
         S_T_SIZE(self, self->len_ents, 
             __buckets[rb] = re;
+            __tags[rb] = S_TAG(hash);
         );
 
         return true;
@@ -341,6 +293,12 @@ bool ks_set_del_h(ks_set self, kso key, ks_hash_t hash, bool* existed) {
         S_T_SIZE(self, self->len_ents,
             __buckets[rb] = B_DELETED;
         );
+
+        /* Leave a hole in the entries, which is filled on the next resize */
+        kso k = self->ents[re].key;
+        self->ents[re].key = NULL;
+        self->len_real--;
+        KS_DECREF(k);
     }
 
     return true;
@@ -498,10 +456,25 @@ static KS_TFUNC(TI, new) {
     self->of = of;
 
     self->pos = 0;
+    self->len_real = of->len_real;
+    self->len_ents = of->len_ents;
 
     return (kso)self;
 }
 
+static bool TI_next(kso ob, kso* res) {
+    ks_set_iter self = (ks_set_iter)ob;
+    ks_set of = self->of;
+    if (of->len_real != self->len_real || of->len_ents != self->len_ents) {
+        KS_THROW(kst_SizeError, "'set' changed size during iteration");
+        return false;
+    }
+
+    while (self->pos < of->len_ents && !of->ents[self->pos].key) self->pos++;
+    *res = self->pos < of->len_ents ? KS_NEWREF(of->ents[self->pos++].key) : NULL;
+    return true;
+}
+
 /* Export */
 
 static struct ks_type_s tp;
@@ -513,10 +486,11 @@ ks_type kst_set_iter = &tp_iter;
 void _ksi_set() {
 
 
-    _ksinit(kst_set_iter, kst_object, TI_NAME, sizeof(struct ks_set_s), -1, "", KS_IKV(
+    _ksinit(kst_set_iter, kst_object, TI_NAME, sizeof(struct ks_set_iter_s), -1, "", KS_IKV(
         {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
     ));
+    kst_set_iter->ob_next = TI_next;
 
 
     _ksinit(kst_set, kst_object, T_NAME, sizeof(struct ks_set_s), -1, "A set of (unique) objects, which can be modified, ordered by first insertion order, resetting with deletion\n\n    Internally, it is a hash-set, which means only one object that hashes a certain way and compares equal with other keys may be contained. Therefore, you cannot store things like 'true' and '1' in the same hashset -- they will become the same item", KS_IKV(
@@ -7,6 +7,132 @@
 
 #define T_NAME "str"
 #define TI_NAME "str.__iter"
+#define TS_NAME "str.__splititer"
+
+
+/* Internals */
+
+/* Table of interned strings (see 'ks_str_intern()')
+ *
+ * Open-addressing (linear probing) on the hash, with a power-of-two length. Each entry holds a reference,
+ *   so interned strings are never freed
+ */
+static ks_str* intern_tab = NULL;
+static ks_size_t intern_len = 0, intern_n = 0;
+
+/* Find the entry for the given contents (or the empty slot it would go in) */
+static ks_str* intern_find(ks_size_t len_b, const char* data, ks_hash_t hash) {
+    ks_size_t i = hash & (intern_len - 1);
+    while (intern_tab[i]) {
+        ks_str s = intern_tab[i];
+        if (KS_STR_HASH(s) == hash && s->len_b == len_b && memcmp(s->data, data, len_b) == 0) break;
+        i = (i + 1) & (intern_len - 1);
+    }
+    return &intern_tab[i];
+}
+
+/* Add a new string (which must not already be present), absorbing a reference */
+static void intern_add(ks_str self) {
+    if (2 * (intern_n + 1) > intern_len) {
+        ks_size_t olen = intern_len, i;
+        ks_str* otab = intern_tab;
+        intern_len = olen ? 2 * olen : 1024;
+        intern_tab = ks_zmalloc(sizeof(*intern_tab), intern_len);
+        memset(intern_tab, 0, sizeof(*intern_tab) * intern_len);
+        for (i = 0; i < olen; ++i) {
+            if (otab[i]) *intern_find(otab[i]->len_b, otab[i]->data, otab[i]->v_hash) = otab[i];
+        }
+        ks_free(otab);
+    }
+
+    self->interned = true;
+    *intern_find(self->len_b, self->data, KS_STR_HASH(self)) = self;
+    intern_n++;
+}
+
+/* Create a new string, without checking for interned strings (if 'len_c < 0', it is calculated) */
+static ks_str make(ks_type tp, ks_ssize_t len_b, ks_ssize_t len_c, char* data) {
+    ks_str self = KSO_NEW(ks_str, tp);
+
+    self->len_b = len_b;
+    self->len_c = len_c >= 0 ? len_c : ks_str_lenc(len_b, data);
+
+    self->data = data;
+    self->data[len_b] = '\0';
+
+    /* Computed on first use (see 'ks_str_hash()'), since most strings are never hashed */
+    self->v_hash = 0;
+
+    return self;
+}
+
+
+/* Size to allocate for 'len_b' bytes, when appending in place
+ * This only depends on the length, so reallocating to it is a no-op (for most allocators) until it changes
+ */
+static ks_size_t append_cap(ks_size_t len_b) {
+    ks_size_t res = 16;
+    while (res < len_b) res *= 2;
+    return res;
+}
+
+void _ks_str_append(ks_str self, ks_str other) {
+    assert(self->refs == 1 && !self->interned && self->type == kst_str);
+
+    ks_size_t len_b = self->len_b + other->len_b;
+    self->data = ks_srealloc(self->data, append_cap(len_b + 1));
+    memcpy(self->data + self->len_b, other->data, other->len_b);
+    self->data[len_b] = '\0';
+
+    self->len_b = len_b;
+    self->len_c += other->len_c;
+    self->v_hash = 0;
+}
+
+void _ks_bytes_append(ks_bytes self, ks_bytes other) {
+    assert(self->refs == 1 && self->type == kst_bytes);
+
+    ks_size_t len_b = self->len_b + other->len_b;
+    self->data = ks_srealloc(self->data, append_cap(len_b));
+    memcpy(self->data + self->len_b, other->data, other->len_b);
+
+    self->len_b = len_b;
+    self->v_hash = 0;
+}
+
+
+/* Return the byte offset of character 'idx_c' (which must be in '[0, len_c]') */
+static ks_ssize_t str_offb(ks_str self, ks_ssize_t idx_c) {
+    if (KS_STR_IS_ASCII(self) || idx_c == 0) return idx_c;
+    if (idx_c >= self->len_c) return self->len_b;
+
+    /* Count the starts of characters (i.e. non-continuation bytes) */
+    const char* p = self->data;
+    while (true) {
+        if ((*p & 0xC0) != 0x80 && idx_c-- == 0) break;
+        p++;
+    }
+    return p - self->data;
+}
+
+
+/* Create a new string from 'data' (which must have 'len_b + 1' bytes allocated), absorbing it, when the number of
+ *   characters is already known
+ */
+static ks_str make_n(ks_ssize_t len_b, ks_ssize_t len_c, char* data) {
+    if (len_b <= 1) return ks_str_newn(len_b, data);
+    return make(kst_str, len_b, len_c, data);
+}
+
+/* Return a new string of the bytes '[lo_b, hi_b)' of 'self' */
+static ks_str str_sub(ks_str self, ks_ssize_t lo_b, ks_ssize_t hi_b) {
+    ks_ssize_t len_b = hi_b - lo_b;
+    if (len_b <= 1) return ks_str_new(len_b, self->data + lo_b);
+
+    char* data = ks_malloc(len_b + 1);
+    memcpy(data, self->data + lo_b, len_b);
+    return make(kst_str, len_b, KS_STR_IS_ASCII(self) ? len_b : -1, data);
+}
 
 
 /* C-API */
@@ -15,28 +141,64 @@
 ks_str ks_str_newt(ks_type tp, ks_ssize_t len_b, const char* data) {
     if (len_b < 0) len_b = strlen(data);
 
+    /* Empty and single-byte strings are shared */
+    if (len_b <= 1 && tp == kst_str) return ks_str_intern_c(len_b, data);
+
     char* new_data = ks_zmalloc(1, len_b + 1);
     memcpy(new_data, data, len_b);
     new_data[len_b] = '\0';
 
-    return ks_str_newn(len_b, new_data);
+    return make(tp, len_b, -1, new_data);
 }
 
 ks_str ks_str_newnt(ks_type tp, ks_ssize_t len_b, char* data) {
     if (len_b < 0) len_b = strlen(data);
 
-    ks_str self = KSO_NEW(ks_str, tp);
+    if (len_b <= 1 && tp == kst_str) {
+        ks_str res = ks_str_intern_c(len_b, data);
+        ks_free(data);
+        return res;
+    }
 
-    
-    self->len_b = len_b;
-    self->len_c = ks_str_lenc(len_b, data);;
+    return make(tp, len_b, -1, data);
+}
 
-    self->data = data;
-    self->data[len_b] = '\0';
+ks_str ks_str_intern(ks_str self) {
+    if (self->interned) return (ks_str)KS_NEWREF(self);
+    if (self->type != kst_str) return ks_str_intern_c(self->len_b, self->data);
 
-    self->v_hash = ks_hash_bytes(len_b, (const unsigned char*)data);
+    if (intern_len > 0) {
+        ks_str res = *intern_find(self->len_b, self->data, KS_STR_HASH(self));
+        if (res) return (ks_str)KS_NEWREF(res);
+    }
 
-    return self;
+    KS_INCREF(self);
+    intern_add(self);
+    return (ks_str)KS_NEWREF(self);
+}
+
+ks_str ks_str_intern_c(ks_ssize_t len_b, const char* data) {
+    if (len_b < 0) len_b = strlen(data);
+    ks_hash_t hash = ks_hash_bytes(len_b, (const unsigned char*)data);
+
+    if (intern_len > 0) {
+        ks_str res = *intern_find(len_b, data, hash);
+        if (res) return (ks_str)KS_NEWREF(res);
+    }
+
+    char* new_data = ks_zmalloc(1, len_b + 1);
+    memcpy(new_data, data, len_b);
+    new_data[len_b] = '\0';
+    ks_str res = make(kst_str, len_b, -1, new_data);
+    res->v_hash = hash;
+    intern_add(res);
+    return (ks_str)KS_NEWREF(res);
+}
+
+
+ks_hash_t ks_str_hash(ks_str self) {
+    if (!self->v_hash) self->v_hash = ks_hash_bytes(self->len_b, (const unsigned char*)self->data);
+    return self->v_hash;
 }
 
 
@@ -56,7 +218,13 @@ int ks_str_cmp(ks_str L, ks_str R) {
     return c0 < 0 ? -1 : (c0 > 0 ? 1 : 0);
 }
 bool ks_str_eq(ks_str L, ks_str R) {
-    return ks_str_eq_c(L, R->data, R->len_b);
+    if (L == R) return true;
+
+    /* Interned strings are unique, and equal strings must have equal hashes (if both have been computed) */
+    if ((L->interned && R->interned) || L->len_b != R->len_b) return false;
+    if (L->v_hash && R->v_hash && L->v_hash != R->v_hash) return false;
+
+    return memcmp(L->data, R->data, L->len_b) == 0;
 }
 bool ks_str_eq_c(ks_str L, const char* data, ks_ssize_t len_b) {
     if (len_b < 0) len_b = strlen(data);
@@ -80,67 +248,99 @@ ks_ucp ks_str_ord(ks_str chr) {
     return res;
 }
 
-ks_str ks_str_upper(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
-    ksio_StringIO sio = ksio_StringIO_new();
-    ks_ucp c;
-    char utf8[5];
-    struct ksucd_info info;
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+/* Classes of ASCII characters, matching their Unicode general categories (i.e. what 'ksucd_get_info()'
+ *   would give, without the lookup)
+ */
+enum {
+    ASCII_SPACE = 0x1, /* Zs */
+    ASCII_ALPHA = 0x2, /* Lu, Ll */
+    ASCII_NUM   = 0x4, /* Nd */
+    ASCII_UNDER = 0x8, /* '_' */
+};
+
+static inline int ascii_class(unsigned char c) {
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') return ASCII_ALPHA;
+    if (c >= '0' && c <= '9') return ASCII_NUM;
+    if (c == ' ') return ASCII_SPACE;
+    if (c == '_') return ASCII_UNDER;
+    return 0;
+}
 
-        if (ksucd_get_info(&info, c) < 0 || info.case_upper == c || info.case_upper <= 0) {
-            /* Assume same case */
-            ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
-        } else {
-            /* Encode upper case */
-            int n;
-            KS_UCP_TO_UTF8(utf8, n, info.case_upper);
-            if (n <= 0) {
-                /* Error, just default back */
-                ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
-            } else {
-                /* Add encoded value */
-                ksio_addbuf(sio, n, utf8);
-            }
-        }
+/* Whether all the bytes in 'data' have one of the classes in 'cls' */
+static bool ascii_all(ks_size_t len_b, const char* data, int cls) {
+    ks_size_t i;
+    for (i = 0; i < len_b; ++i) {
+        if (!(ascii_class(data[i]) & cls)) return false;
     }
-
-    return ksio_StringIO_getf(sio);
+    return true;
 }
 
-ks_str ks_str_lower(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
+/* Convert the case of 'self', with 'ascii' for runs of ASCII, and 'upper' telling which case mapping to use
+ *   for other characters
+ */
+static ks_str str_case(ks_str self, void (*ascii)(ks_size_t, char*, const char*), bool upper) {
+    if (KS_STR_IS_ASCII(self)) {
+        char* data = ks_malloc(self->len_b + 1);
+        ascii(self->len_b, data, self->data);
+        return ks_str_newn(self->len_b, data);
+    }
+
     ksio_StringIO sio = ksio_StringIO_new();
-    ks_ucp c;
+    ks_size_t i = 0, n;
     char utf8[5];
     struct ksucd_info info;
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+    while (i < self->len_b) {
+        /* Add the run of ASCII characters, and convert in place */
+        n = ks_utf8_ascii(self->len_b - i, self->data + i);
+        if (n > 0) {
+            ksio_addbuf(sio, n, self->data + i);
+            char* run = (char*)sio->data + sio->len_b - n;
+            ascii(n, run, run);
+            i += n;
+            if (i >= self->len_b) break;
+        }
 
-        if (ksucd_get_info(&info, c) < 0 || info.case_lower == c || info.case_lower <= 0) {
+        ks_ucp c, to;
+        int sz;
+        KS_UCP_FROM_UTF8(c, self->data + i, sz);
+        if (sz <= 0 || i + sz > self->len_b) {
+            /* Invalid, so keep the byte as-is */
+            ksio_addbuf(sio, 1, self->data + i);
+            i++;
+            continue;
+        }
+
+        to = ksucd_get_info(&info, c) < 0 ? -1 : (upper ? info.case_upper : info.case_lower);
+        if (to <= 0 || to == c) {
             /* Assume same case */
-            ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
+            ksio_addbuf(sio, sz, self->data + i);
         } else {
-            /* Encode lower case */
-            int n;
-            KS_UCP_TO_UTF8(utf8, n, info.case_lower);
-            if (n <= 0) {
+            /* Encode the other case */
+            int m;
+            KS_UCP_TO_UTF8(utf8, m, to);
+            if (m <= 0) {
                 /* Error, just default back */
-                ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
+                ksio_addbuf(sio, sz, self->data + i);
             } else {
-                /* Add encoded value */
-                ksio_addbuf(sio, n, utf8);
+                ksio_addbuf(sio, m, utf8);
             }
         }
+        i += sz;
     }
 
     return ksio_StringIO_getf(sio);
 }
 
+ks_str ks_str_upper(ks_str self) {
+    return str_case(self, ks_ascii_upper, true);
+}
+
+ks_str ks_str_lower(ks_str self) {
+    return str_case(self, ks_ascii_lower, false);
+}
+
 bool ks_str_isspace(ks_str self) {
+    if (KS_STR_IS_ASCII(self)) return ascii_all(self->len_b, self->data, ASCII_SPACE);
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
     struct ksucd_info info;
@@ -176,6 +376,7 @@ bool ks_str_isprint(ks_str self) {
 }
 
 bool ks_str_isnum(ks_str self) {
+    if (KS_STR_IS_ASCII(self)) return ascii_all(self->len_b, self->data, ASCII_NUM);
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
     struct ksucd_info info;
@@ -192,6 +393,7 @@ bool ks_str_isnum(ks_str self) {
 }
 
 bool ks_str_isalpha(ks_str self) {
+    if (KS_STR_IS_ASCII(self)) return ascii_all(self->len_b, self->data, ASCII_ALPHA);
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
     struct ksucd_info info;
@@ -208,6 +410,7 @@ bool ks_str_isalpha(ks_str self) {
 }
 
 bool ks_str_isalnum(ks_str self) {
+    if (KS_STR_IS_ASCII(self)) return ascii_all(self->len_b, self->data, ASCII_ALPHA | ASCII_NUM);
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
     struct ksucd_info info;
@@ -228,6 +431,9 @@ bool ks_str_isalnum(ks_str self) {
 
 bool ks_str_isident(ks_str self) {
     if (self->len_b < 1) return false;
+    if (KS_STR_IS_ASCII(self)) {
+        return (ascii_class(self->data[0]) & ASCII_ALPHA) && ascii_all(self->len_b - 1, self->data + 1, ASCII_ALPHA | ASCII_NUM | ASCII_UNDER);
+    }
 
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
@@ -265,46 +471,43 @@ bool ks_str_isident(ks_str self) {
 
 
 
-ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data) {
-    if (len_b < 0) len_b = strlen(data);
-    ks_ssize_t p = 0, r = 0;
-    while (p < len_b) {
-        /* Found another character */
-        r += (data[p++] & 0xC0) != 0x80;
+ks_ssize_t ks_str_findall(ks_str self, ks_str sub, ks_ssize_t** offs) {
+    *offs = NULL;
+    if (sub->len_b == 0) return 0;
+
+    ks_ssize_t n = 0, max_n = 0, i, j = 0;
+    while ((i = ks_memfind(self->len_b - j, self->data + j, sub->len_b, sub->data)) >= 0) {
+        if (n >= max_n) {
+            max_n = max_n ? 2 * max_n : 16;
+            *offs = ks_zrealloc(*offs, sizeof(**offs), max_n);
+        }
+        (*offs)[n++] = j + i;
+        j += i + sub->len_b;
     }
 
-    return r;
+    return n;
 }
 
 ks_list ks_str_split(ks_str self, ks_str by) {
     ks_list res = ks_list_new(0, NULL);
-    if (self->len_b == 0) {
+    if (self->len_b == 0 || by->len_b == 0) {
         ks_list_push(res, (kso)self);
         return res;
     }
 
-    ks_size_t i, j = 0;
-    for (i = 0; i <= self->len_b - by->len_b; ++i) {
-        if (memcmp(self->data + i, by->data, by->len_b) == 0) {
-            /* Add characters pased until this */
-            ks_str ss = ks_str_new(i - j, self->data + j);
-            ks_list_push(res, (kso)ss);
-            KS_DECREF(ss);
+    /* Find all the separators first, so the list is allocated once */
+    ks_ssize_t* offs;
+    ks_ssize_t n = ks_str_findall(self, by, &offs), i, j = 0;
+    res->elems = ks_zrealloc(res->elems, sizeof(*res->elems), n + 1);
+    res->_max_len = n + 1;
 
-            i += by->len_b - 1;
-            j = i + 1;
-        } else {
-        }
-    }
-
-    i = self->len_b;
-
-    if (i >= j) {
-        ks_str ss = ks_str_new(i - j, self->data + j);
-        ks_list_push(res, (kso)ss);
-        KS_DECREF(ss);
+    for (i = 0; i < n; ++i) {
+        res->elems[res->len++] = (kso)str_sub(self, j, offs[i]);
+        j = offs[i] + by->len_b;
     }
+    res->elems[res->len++] = (kso)str_sub(self, j, self->len_b);
 
+    ks_free(offs);
     return res;
 }
 
@@ -358,56 +561,43 @@ ks_list ks_str_split_c(const char* self, const char* by) {
 
 ks_ssize_t ks_str_find(ks_str self, ks_str substr, ks_ssize_t min_c, ks_ssize_t max_c, ks_ssize_t* idx_b) {
     if (substr->len_b == 0) return -1;
-    else if (self->len_b < substr->len_b) return -1;
+    if (min_c < 0) min_c = 0;
+    if (max_c > self->len_c) max_c = self->len_c;
+    if (max_c - min_c < (ks_ssize_t)substr->len_c) return -1;
 
-    if (KS_STR_IS_ASCII(self)) {
-        // otherwise, search for it
-        /* ASCII search */
-        ks_ssize_t i;
-        for (i = min_c; i <= max_c - substr->len_b; ++i) {
-            if (self->data[i] == *substr->data) {
-                // possible match, now check full substring
-                if (memcmp(self->data + i, substr->data, substr->len_b) == 0) {
-                    if (idx_b != NULL) *idx_b = i;
-                    return i;
-                }
-            }
-        }
+    /* Search the bytes, and only convert to a character position if it was found */
+    ks_ssize_t lo_b = str_offb(self, min_c), hi_b = str_offb(self, max_c);
+    ks_ssize_t res = ks_memfind(hi_b - lo_b, self->data + lo_b, substr->len_b, substr->data);
+    if (res < 0) return -1;
 
-        // not found
-        return -1;
-    } else {
-        /* Generial unicode search */
-        struct ks_str_citer cit = ks_str_citer_make(self);
-
-        ks_size_t i = 0;
-        ks_str_citer_seek(&cit, min_c);
-
-        while (!cit.done && cit.cchi <= max_c) {
-            if (self->data[cit.cbyi] == *substr->data) {
-                // possible match, now check full substring
-                if (memcmp(self->data + cit.cbyi, substr->data, substr->len_b) == 0) {
-                    if (idx_b != NULL) *idx_b = cit.cbyi;
-                    return cit.cchi;
-                }
-            }
+    if (idx_b) *idx_b = lo_b + res;
+    return min_c + (KS_STR_IS_ASCII(self) ? res : ks_str_lenc(res, self->data + lo_b));
+}
 
-            ks_str_citer_next(&cit);
-        }
+ks_ssize_t ks_str_count(ks_str self, ks_str substr, ks_ssize_t min_c, ks_ssize_t max_c) {
+    if (substr->len_b == 0) return 0;
+    if (min_c < 0) min_c = 0;
+    if (max_c > self->len_c) max_c = self->len_c;
+    if (max_c < min_c) return 0;
 
-        return -1;
-    }
+    ks_ssize_t lo_b = str_offb(self, min_c), hi_b = str_offb(self, max_c);
+    return ks_memcount(hi_b - lo_b, self->data + lo_b, substr->len_b, substr->data);
 }
 
-ks_str ks_str_join(ks_str sep, kso objs) {
+/* Join arbitrary objects, by converting each to a string */
+static ks_str join_any(ks_str sep, kso objs) {
     ksio_StringIO sio = ksio_StringIO_new();
     ks_cit cit = ks_cit_make(objs);
     kso ob = NULL;
     int ct = 0;
     while ((ob = ks_cit_next(&cit)) != NULL) {
 
-        if (ct > 0) ksio_add(sio, "%S", sep);
-        if (!ksio_add(sio, "%S", ob)) {
+        if (ct > 0) ksio_addbuf(sio, sep->len_b, sep->data);
+        if (kso_issub(ob->type, kst_str)) {
+            ksio_addbuf(sio, ((ks_str)ob)->len_b, ((ks_str)ob)->data);
+        } else if (!ksio_add(sio, "%S", ob)) {
+            KS_DECREF(ob);
+            ks_cit_done(&cit);
             KS_DECREF(sio);
             return NULL;
         }
@@ -425,7 +615,42 @@ ks_str ks_str_join(ks_str sep, kso objs) {
     return ksio_StringIO_getf(sio);
 }
 
+ks_str ks_str_join(ks_str sep, kso objs) {
+    ks_ssize_t n, i;
+    kso* elems;
+    if (kso_issub(objs->type, kst_list)) {
+        n = ((ks_list)objs)->len;
+        elems = ((ks_list)objs)->elems;
+    } else if (kso_issub(objs->type, kst_tuple)) {
+        n = ((ks_tuple)objs)->len;
+        elems = ((ks_tuple)objs)->elems;
+    } else {
+        return join_any(sep, objs);
+    }
+    if (n == 0) return ks_str_new(0, NULL);
+
+    /* Sum the lengths, so the result can be allocated once */
+    ks_ssize_t len_b = (n - 1) * sep->len_b, len_c = (n - 1) * sep->len_c;
+    for (i = 0; i < n; ++i) {
+        ks_str s = (ks_str)elems[i];
+        if (!kso_issub(s->type, kst_str)) return join_any(sep, objs);
+        len_b += s->len_b;
+        len_c += s->len_c;
+    }
+
+    char* data = ks_malloc(len_b + 1), *p = data;
+    for (i = 0; i < n; ++i) {
+        ks_str s = (ks_str)elems[i];
+        if (i > 0) {
+            memcpy(p, sep->data, sep->len_b);
+            p += sep->len_b;
+        }
+        memcpy(p, s->data, s->len_b);
+        p += s->len_b;
+    }
 
+    return make_n(len_b, len_c, data);
+}
 
 
 /* C-style string iteration */
@@ -655,7 +880,7 @@ static KS_TFUNC(T, mod) {
 
     ksio_StringIO sio = ksio_StringIO_new();
 
-    if (!ks_fmt2((ksio_BaseIO)sio, self->data, args->len, args->elems)) {
+    if (!ks_fmt2s((ksio_BaseIO)sio, self, args->len, args->elems)) {
         KS_DECREF(sio);
         return NULL;
     }
@@ -747,7 +972,7 @@ static KS_TFUNC(T, startswith) {
     if (obj->type == kst_str) {
         ks_str sobj = (ks_str)obj;
 
-        bool res = self->len_b >= sobj->len_b && strncmp(self->data, sobj->data, sobj->len_b) == 0;
+        bool res = self->len_b >= sobj->len_b && memcmp(self->data, sobj->data, sobj->len_b) == 0;
         return KSO_BOOL(res);
 
     } else if (kso_issub(obj->type, kst_tuple)) {
@@ -760,7 +985,7 @@ static KS_TFUNC(T, startswith) {
                 return NULL;
             }
             // found match
-            if (self->len_b >= sobj->len_b && strncmp(self->data, sobj->data, sobj->len_b) == 0) return KSO_TRUE;
+            if (self->len_b >= sobj->len_b && memcmp(self->data, sobj->data, sobj->len_b) == 0) return KSO_TRUE;
         }
 
         // no match
@@ -780,7 +1005,7 @@ static KS_TFUNC(T, endswith) {
     if (obj->type == kst_str) {
         ks_str sobj = (ks_str)obj;
 
-        bool res = self->len_b >= sobj->len_b && strncmp(self->data + self->len_b - sobj->len_b, sobj->data, sobj->len_b) == 0;
+        bool res = self->len_b >= sobj->len_b && memcmp(self->data + self->len_b - sobj->len_b, sobj->data, sobj->len_b) == 0;
         return KSO_BOOL(res);
     } else if (kso_issub(obj->type, kst_tuple)) {
         ks_tuple tobj = (ks_tuple)obj;
@@ -792,7 +1017,7 @@ static KS_TFUNC(T, endswith) {
                 return NULL;
             }
             // found match
-            if (self->len_b >= sobj->len_b && strncmp(self->data + self->len_b - sobj->len_b, sobj->data, sobj->len_b) == 0) return KSO_TRUE;
+            if (self->len_b >= sobj->len_b && memcmp(self->data + self->len_b - sobj->len_b, sobj->data, sobj->len_b) == 0) return KSO_TRUE;
         }
 
         // no match
@@ -838,31 +1063,42 @@ static KS_TFUNC(T, find) {
     return (kso)ks_int_new(ks_str_find(self, sub, start, end, NULL));
 }
 
+static KS_TFUNC(T, count) {
+    ks_str self;
+    ks_str sub;
+    ks_cint start = 0, end = KS_CINT_MAX;
+    KS_ARGS("self:* sub:* ?start:cint ?end:cint", &self, kst_str, &sub, kst_str, &start, &end);
+
+    return (kso)ks_int_new(ks_str_count(self, sub, start, end));
+}
+
 static KS_TFUNC(T, replace) {
     ks_str self;
     ks_str sub, by;
     KS_ARGS("self:* sub:* by:*", &self, kst_str, &sub, kst_str, &by, kst_str);
 
-    /* General search/replace */
-    ksio_StringIO sio = ksio_StringIO_new();
-
-    ks_size_t i = 0, j = 0;
-    for (i = 0; i <= self->len_b - sub->len_b; ) {
-        if (memcmp(self->data + i, sub->data, sub->len_b) == 0) {
-            /* Add literal */
-            ksio_addbuf(sio, i - j, self->data + j);
-            /* Found substring, so emit the replaced by */
-            ksio_addbuf(sio, by->len_b, by->data);
-
-            /* Skip over it */
-            j = i += sub->len_b;
-        } else {
-            i++;
-        }
+    /* Find all occurrences first, so the result can be allocated once */
+    ks_ssize_t* offs;
+    ks_ssize_t n = ks_str_findall(self, sub, &offs), i, j = 0;
+    if (n == 0) return KS_NEWREF(self);
+
+    ks_ssize_t len_b = self->len_b + n * ((ks_ssize_t)by->len_b - (ks_ssize_t)sub->len_b);
+    ks_ssize_t len_c = self->len_c + n * ((ks_ssize_t)by->len_c - (ks_ssize_t)sub->len_c);
+    char* data = ks_malloc(len_b + 1), *p = data;
+    for (i = 0; i < n; ++i) {
+        /* Add literal, and then what it is replaced by */
+        memcpy(p, self->data + j, offs[i] - j);
+        p += offs[i] - j;
+        memcpy(p, by->data, by->len_b);
+        p += by->len_b;
+
+        /* Skip over it */
+        j = offs[i] + sub->len_b;
     }
-    i = self->len_b;
-    ksio_addbuf(sio, i - j, self->data + j);
-    return (kso)ksio_StringIO_getf(sio);
+    memcpy(p, self->data + j, self->len_b - j);
+
+    ks_free(offs);
+    return (kso)make_n(len_b, len_c, data);
 }
 
 
@@ -946,6 +1182,92 @@ static KS_TFUNC(TI, new) {
     return (kso)self;
 }
 
+static bool TI_next(kso ob, kso* res) {
+    ks_str_iter self = (ks_str_iter)ob;
+    if (self->pos >= self->of->len_b) {
+        *res = NULL;
+        return true;
+    }
+
+    /* Take the whole UTF-8 sequence for the character (the lead byte, and any continuation bytes) */
+    const unsigned char* data = (const unsigned char*)self->of->data;
+    ks_cint ct = 1;
+    while (self->pos + ct < self->of->len_b && KS_UCP_IS_CONT(data[self->pos + ct])) ct++;
+
+    *res = (kso)ks_str_new(ct, self->of->data + self->pos);
+    self->pos += ct;
+    return true;
+}
+
+
+/** Split Iterator **/
+
+static KS_TFUNC(TS, free) {
+    ks_str_splititer self;
+    KS_ARGS("self:*", &self, kst_str_splititer);
+
+    KS_DECREF(self->of);
+    KS_DECREF(self->by);
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TS, new) {
+    ks_type tp;
+    ks_str of, by;
+    KS_ARGS("tp:* of:* by:*", &tp, kst_type, &of, kst_str, &by, kst_str);
+
+    ks_str_splititer self = KSO_NEW(ks_str_splititer, tp);
+
+    KS_INCREF(of);
+    self->of = of;
+    KS_INCREF(by);
+    self->by = by;
+
+    self->pos = 0;
+
+    return (kso)self;
+}
+
+static bool TS_next(kso ob, kso* res) {
+    ks_str_splititer self = (ks_str_splititer)ob;
+    if (self->pos < 0) {
+        *res = NULL;
+        return true;
+    }
+
+    /* Same parts as 'ks_str_split()' */
+    ks_str of = self->of, by = self->by;
+    ks_cint i = -1, j = self->pos;
+    if (of->len_b > 0 && by->len_b > 0) {
+        i = ks_memfind(of->len_b - j, of->data + j, by->len_b, by->data);
+    }
+
+    if (i < 0) {
+        self->pos = -1;
+        *res = (kso)str_sub(of, j, of->len_b);
+    } else {
+        self->pos = j + i + by->len_b;
+        *res = (kso)str_sub(of, j, j + i);
+    }
+    return *res != NULL;
+}
+
+static KS_TFUNC(TS, next) {
+    ks_str_splititer self;
+    KS_ARGS("self:*", &self, kst_str_splititer);
+
+    return kso_next_f(TS_next, (kso)self);
+}
+
+static KS_TFUNC(T, splititer) {
+    ks_str self, by;
+    KS_ARGS("self:* by:*", &self, kst_str, &by, kst_str);
+
+    return kso_call((kso)kst_str_splititer, 2, (kso[]){ (kso)self, (kso)by });
+}
+
 
 /* Export */
 
@@ -955,6 +1277,9 @@ ks_type kst_str = &tp;
 static struct ks_type_s tp_iter;
 ks_type kst_str_iter = &tp_iter;
 
+static struct ks_type_s tp_splititer;
+ks_type kst_str_splititer = &tp_splititer;
+
 
 void _ksi_str() {
 
@@ -963,6 +1288,14 @@ void _ksi_str() {
         {"__new",                ksf_wrap(TI_new_, T_NAME ".__new(tp, of)", "")},
     ));
 
+    _ksinit(kst_str_splititer, kst_object, TS_NAME, sizeof(struct ks_str_splititer_s), -1, "Iterator over the parts of a string split by a separator, which are created as they are needed", KS_IKV(
+        {"__free",               ksf_wrap(TS_free_, TS_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(TS_new_, TS_NAME ".__new(tp, of, by)", "")},
+        {"__next",               ksf_wrap(TS_next_, TS_NAME ".__next(self)", "")},
+    ));
+    kst_str_iter->ob_next = TI_next;
+    kst_str_splititer->ob_next = TS_next;
+
     _ksinit(kst_str, kst_object, T_NAME, sizeof(struct ks_str_s), -1, "String (i.e. a collection of Unicode characters)\n\n    Indicies, operations, and so forth take character positions, not byte positions", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj=none)", "")},
@@ -996,9 +1329,11 @@ void _ksi_str() {
         
         {"join",                 ksf_wrap(T_join_, T_NAME ".join(self, objs)", "Joins an iterable by a seperator")},
         {"split",                ksf_wrap(T_split_, T_NAME ".split(self, by)", "Splits a string on a given seperator, which may be a 'str' or tuple of 'str's")},
+        {"splititer",            ksf_wrap(T_splititer_, T_NAME ".splititer(self, by)", "Returns an iterator over the same parts as 'self.split(by)', which creates each part as it is needed (instead of a list of them all)")},
         
         {"index",                ksf_wrap(T_index_, T_NAME ".index(self, sub, start=none, end=none)", "Find a substring within 'self[self:end]', or throw an error of it was not found")},
         {"find",                 ksf_wrap(T_find_, T_NAME ".find(self, sub, start=none, end=none)", "Find a substring within 'self[start:end]'")},
+        {"count",                ksf_wrap(T_count_, T_NAME ".count(self, sub, start=none, end=none)", "Count the non-overlapping occurrences of a substring within 'self[start:end]' (an empty substring is never found, like with 'find()', so it counts 0)")},
         {"replace",              ksf_wrap(T_replace_, T_NAME ".replace(self, sub, by)", "Replace instances of 'sub' with 'by'")},
 
         {"trim",                 ksf_wrap(T_trim_, T_NAME ".trim(self)", "Trims the left and right sides of 'self' of spaces, and returns what is left")},
@@ -192,6 +192,12 @@ static KS_TFUNC(TI, new) {
 
     return (kso)self;
 }
+
+static bool TI_next(kso ob, kso* res) {
+    ks_tuple_iter self = (ks_tuple_iter)ob;
+    *res = self->pos < self->of->len ? KS_NEWREF(self->of->elems[self->pos++]) : NULL;
+    return true;
+}
 /* Export */
 
 static struct ks_type_s tp;
@@ -207,6 +213,7 @@ void _ksi_tuple() {
         {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
     ));
+    kst_tuple_iter->ob_next = TI_next;
     _ksinit(kst_tuple, kst_object, T_NAME, sizeof(struct ks_tuple_s), -1, "Like 'list', but immutable", KS_IKV(
         {"__free",                 ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                  ksf_wrap(T_new_, T_NAME ".__new(self, objs=none)", "")},
@@ -34,6 +34,10 @@ void type_init(ks_type self, ks_type base, const char* name, int sz, int attr, c
     self->num_obs_del = self->num_obs_new = 0;
     self->ob_sz = sz == 0 ? base->ob_sz : sz;
     self->ob_attr = attr == 0 ? base->ob_attr : attr;
+    self->ob_slots = base->ob_slots;
+    self->ob_shape = self->ob_slots > 0 ? ks_shape_new() : NULL;
+    self->ob_buffer = base->ob_buffer;
+    self->ob_next = base->ob_next;
     ks_type_set(self, _ksva__base, (kso)base);
 
     kso tmp = (kso)ks_str_new(-1, name);
@@ -154,7 +158,7 @@ ks_type ks_type_template(ks_type base, int nargs, kso* args) {
 
 
 kso ks_type_get(ks_type self, ks_str attr) {
-    kso res = ks_dict_get_ih(self->attr, (kso)attr, attr->v_hash);
+    kso res = ks_dict_get_ih(self->attr, (kso)attr, KS_STR_HASH(attr));
     if (res) return res;
 
     if (self->i__base != self) return ks_type_get(self->i__base, attr);
@@ -173,14 +177,16 @@ bool ks_type_set(ks_type self, ks_str attr, kso val) {
         if (false) {}
         _KS_DO_SPEC(ACT)
         #undef ACTss
+
+        if (ks_str_eq_c(attr, "__next", 6)) self->ob_next = NULL;
     }
 
-    ks_dict_set_h(self->attr, (kso)attr, attr->v_hash, val);
+    ks_dict_set_h(self->attr, (kso)attr, KS_STR_HASH(attr), val);
     return true;
 }
 
 bool ks_type_set_c(ks_type self, const char* attr, kso val) {
-    ks_str k = ks_str_new(-1, attr);
+    ks_str k = ks_str_intern_c(-1, attr);
     bool res = ks_type_set(self, k, val);
     KS_DECREF(k);
     return res;
@@ -4,6 +4,11 @@
  * @author: Cade Brown <cade@kscript.org>
  */
 #include <ks/impl.h>
+#include <time.h>
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
 
 /* Calculate primality. TODO: Consider miller rabin? */
 static bool is_prime(ks_ssize_t x) {
@@ -62,19 +67,442 @@ bool ks_printf(const char* fmt, ...) {
 }
 
 
+/* Hashing
+ *
+ * This is based on wyhash (final version 4), which reads 8 (or 16, or 48) bytes at a time, and mixes them
+ *   with 64x64->128 bit multiplications. It is much faster than a byte-at-a-time hash for all but the shortest
+ *   inputs, and has good distribution in the low bits (which hash tables use)
+ *
+ * The seed is 0 by default, so hashes are the same every time. If 'KS_HASHSEED' is set, it is used instead (or
+ *   if it is 'random', a random seed is generated), which makes it infeasible for untrusted input (for example,
+ *   HTTP headers and query parameters) to be constructed to collide (see 'ks_init()')
+ *
+ * SEE: https://github.com/wangyi-fudan/wyhash
+ */
+
+/* Seed for all hashes (must not change once anything has been hashed) */
+static uint64_t hash_seed = 0;
+
+/* Secret parameters */
+static const uint64_t hash_p[4] = {
+    0xA0761D6478BD642FULL, 0xE7037ED1A0B428DBULL, 0x8EBC6AF09C88C6E3ULL, 0x589965CC75374CC3ULL,
+};
+
+/* Multiply 'A * B', and store the low 64 bits in 'A' and the high in 'B' */
+static inline void hash_mum(uint64_t* A, uint64_t* B) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*A * *B;
+    *A = (uint64_t)r;
+    *B = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *A >> 32, hb = *B >> 32, la = (uint32_t)*A, lb = (uint32_t)*B;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *A = lo;
+    *B = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t hash_mix(uint64_t A, uint64_t B) {
+    hash_mum(&A, &B);
+    return A ^ B;
+}
+
+/* Unaligned reads (the hash is only the same across platforms of the same endianness) */
+static inline uint64_t hash_r8(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+static inline uint64_t hash_r4(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+static inline uint64_t hash_r3(const unsigned char* p, ks_size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+void _ks_hash_init(const char* seed) {
+    if (!seed || !*seed) return;
+
+    uint64_t val = 0;
+    if (strcmp(seed, "random") == 0) {
+        /* Use the OS's random source, or the time and process ID if that isn't available */
+        FILE* fp = fopen("/dev/urandom", "rb");
+        if (!fp || fread(&val, sizeof(val), 1, fp) != 1) {
+            val = (uint64_t)time(NULL) ^ (uint64_t)(ks_uint)&val;
+#ifdef KS_HAVE_UNISTD_H
+            val ^= (uint64_t)getpid() << 32;
+#endif
+        }
+        if (fp) fclose(fp);
+    } else {
+        val = strtoull(seed, NULL, 0);
+    }
+
+    hash_seed = val;
+}
+
 ks_hash_t ks_hash_bytes(ks_ssize_t len_b, const unsigned char* data) {
-    /* djb2-based algorithm */
-    ks_hash_t res = 5381;
+    const unsigned char* p = data;
+    ks_size_t len = len_b;
+    uint64_t seed = hash_seed ^ hash_mix(hash_seed ^ hash_p[0], hash_p[1]);
+    uint64_t a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hash_r4(p) << 32) | hash_r4(p + ((len >> 3) << 2));
+            b = (hash_r4(p + len - 4) << 32) | hash_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = hash_r3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        ks_size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(hash_r8(p) ^ hash_p[1], hash_r8(p + 8) ^ seed);
+                see1 = hash_mix(hash_r8(p + 16) ^ hash_p[2], hash_r8(p + 24) ^ see1);
+                see2 = hash_mix(hash_r8(p + 32) ^ hash_p[3], hash_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_r8(p) ^ hash_p[1], hash_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_r8(p + i - 16);
+        b = hash_r8(p + i - 8);
+    }
+
+    a ^= hash_p[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+    ks_hash_t res = (ks_hash_t)hash_mix(a ^ hash_p[0] ^ len, b ^ hash_p[1]);
+
+    /* 0 is reserved for 'not yet computed' (see 'ks_str_hash()') */
+    return res ? res : 1;
+}
+
+
+/* Searching
+ *
+ * 'ks_memfind()' first filters candidate positions by comparing the first and last bytes of the needle
+ *   against 16 positions at a time (with SSE2, if available, and otherwise by 'memchr()' for the first byte,
+ *   which is vectorized by most C libraries). Only candidates that match both are compared in full, which is
+ *   very rare for typical text
+ *
+ * For inputs where many candidates fail (for example, searching for 'aaab' in 'aaaa...'), it switches to
+ *   the Two-Way algorithm, which is linear in the worst case
+ *
+ * SEE: http://0x80.pl/articles/simd-strfind.html
+ * SEE: https://www-igm.univ-mlv.fr/~lecroq/string/node26.html
+ */
+
+/* Whether the filter has had too many false candidates, at position 'i' */
+#define FIND_TOO_MANY(_fails, _i) ((_fails) > 16 + (_i) / 32)
+
+/* Two-Way search of 'n' in 'h' (based on the implementation in musl) */
+static ks_ssize_t find_twoway(const unsigned char* h, ks_size_t len_h, const unsigned char* n, ks_size_t len_n) {
+    const unsigned char* z = h + len_h, *h0 = h;
+    ks_size_t i, ip, jp, k, p, ms, p0, mem, mem0;
+    ks_size_t shift[256];
+    unsigned char inn[256];
+    memset(inn, 0, sizeof(inn));
+
+    /* Shift table, of the last position (plus 1) of each byte in the needle */
+    for (i = 0; i < len_n; ++i) {
+        inn[n[i]] = 1;
+        shift[n[i]] = i + 1;
+    }
+
+    /* Compute the maximal suffix (note: 'ip' starts at -1, and relies on unsigned wrapping) */
+    ip = -1; jp = 0; k = p = 1;
+    while (jp + k < len_n) {
+        if (n[ip + k] == n[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else k++;
+        } else if (n[ip + k] > n[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
+    }
+    ms = ip;
+    p0 = p;
 
-    ks_ssize_t i;
-    for (i = 0; i < len_b; ++i) {
-        res = (33 * res) + data[i];
+    /* And with the opposite comparison */
+    ip = -1; jp = 0; k = p = 1;
+    while (jp + k < len_n) {
+        if (n[ip + k] == n[jp + k]) {
+            if (k == p) {
+                jp += p;
+                k = 1;
+            } else k++;
+        } else if (n[ip + k] < n[jp + k]) {
+            jp += k;
+            k = 1;
+            p = jp - ip;
+        } else {
+            ip = jp++;
+            k = p = 1;
+        }
     }
+    if (ip + 1 > ms + 1) ms = ip;
+    else p = p0;
 
+    /* Check whether the needle is periodic */
+    if (memcmp(n, n + p, ms + 1)) {
+        mem0 = 0;
+        p = (ms > len_n - ms - 1 ? ms : len_n - ms - 1) + 1;
+    } else {
+        mem0 = len_n - p;
+    }
+    mem = 0;
+
+    while ((ks_size_t)(z - h) >= len_n) {
+        /* Check the last byte first, and skip ahead if it can't match */
+        if (inn[h[len_n - 1]]) {
+            k = len_n - shift[h[len_n - 1]];
+            if (k) {
+                if (k < mem) k = mem;
+                h += k;
+                mem = 0;
+                continue;
+            }
+        } else {
+            h += len_n;
+            mem = 0;
+            continue;
+        }
+
+        /* Compare the right half */
+        for (k = ms + 1 > mem ? ms + 1 : mem; k < len_n && n[k] == h[k]; k++);
+        if (k < len_n) {
+            h += k - ms;
+            mem = 0;
+            continue;
+        }
+
+        /* Compare the left half */
+        for (k = ms + 1; k > mem && n[k - 1] == h[k - 1]; k--);
+        if (k <= mem) return h - h0;
+        h += p;
+        mem = mem0;
+    }
+
+    return -1;
+}
+
+ks_ssize_t ks_memfind(ks_size_t len_h, const char* h, ks_size_t len_n, const char* n) {
+    if (len_n == 0) return 0;
+    if (len_n > len_h) return -1;
+    if (len_n == 1) {
+        const char* p = memchr(h, n[0], len_h);
+        return p ? p - h : -1;
+    }
+
+    /* Last position that a match may start at */
+    ks_size_t last = len_h - len_n, i = 0, fails = 0;
+
+#ifdef __SSE2__
+    __m128i F = _mm_set1_epi8(n[0]), L = _mm_set1_epi8(n[len_n - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(h + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(h + i + len_n - 1));
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, F), _mm_cmpeq_epi8(b, L)));
+        while (mask) {
+            int j = __builtin_ctz(mask);
+            if (memcmp(h + i + j + 1, n + 1, len_n - 2) == 0) return i + j;
+            fails++;
+            mask &= mask - 1;
+        }
+        if (FIND_TOO_MANY(fails, i)) goto twoway;
+    }
+#endif
+
+    while (i <= last) {
+        const char* p = memchr(h + i, n[0], last - i + 1);
+        if (!p) return -1;
+        i = p - h;
+        if (h[i + len_n - 1] == n[len_n - 1] && memcmp(h + i + 1, n + 1, len_n - 2) == 0) return i;
+        i++;
+        fails++;
+        if (FIND_TOO_MANY(fails, i)) goto twoway;
+    }
+    return -1;
+
+twoway:;
+    ks_ssize_t res = find_twoway((const unsigned char*)h + i, len_h - i, (const unsigned char*)n, len_n);
+    return res < 0 ? -1 : (ks_ssize_t)i + res;
+}
+
+ks_ssize_t ks_memcount(ks_size_t len_h, const char* h, ks_size_t len_n, const char* n) {
+    if (len_n == 0) return len_h + 1;
+
+    ks_ssize_t res = 0, i = 0, j;
+    while ((j = ks_memfind(len_h - i, h + i, len_n, n)) >= 0) {
+        res++;
+        i += j + len_n;
+    }
     return res;
 }
 
 
+/* UTF-8
+ *
+ * Most text is entirely (or mostly) ASCII, so these work on blocks of 16 bytes at a time (with SSE2, if
+ *   available, and otherwise 8 bytes at a time in a 64-bit word) while the input is ASCII, and only look at
+ *   the individual bytes of non-ASCII sequences
+ *
+ * Counting characters doesn't need to decode anything at all, since every character has exactly one byte
+ *   that is not a continuation byte (i.e. of the form '10xxxxxx')
+ *
+ * SEE: https://lemire.me/blog/2018/05/16/validating-utf-8-strings-using-as-little-as-0-7-cycles-per-byte/
+ */
+
+/* High bit of each byte in a word */
+#define UTF8_HI 0x8080808080808080ULL
+
+/* Number of bytes in a word that are not continuation bytes */
+static inline int utf8_nstarts(uint64_t w) {
+    /* Continuation bytes have the high bit set, and the next bit clear */
+    uint64_t cont = (w & ~(w << 1)) & UTF8_HI;
+    return 8 - (int)(((cont >> 7) * 0x0101010101010101ULL) >> 56);
+}
+
+ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data) {
+    if (len_b < 0) len_b = strlen(data);
+    ks_ssize_t i = 0, res = 0;
+
+#ifdef __SSE2__
+    /* Continuation bytes are '<= 0xBF' (i.e. '<= -65' as a signed byte) */
+    __m128i C = _mm_set1_epi8(-65), Z = _mm_setzero_si128();
+    while (i + 16 <= len_b) {
+        /* Sum up to 255 blocks per byte before they could overflow */
+        ks_ssize_t n = (len_b - i) / 16;
+        if (n > 255) n = 255;
+
+        __m128i acc = Z;
+        for (; n > 0; --n, i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, C));
+        }
+        acc = _mm_sad_epu8(acc, Z);
+        res += _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc));
+    }
+#endif
+
+    uint64_t w;
+    for (; i + 8 <= len_b; i += 8) {
+        memcpy(&w, data + i, 8);
+        res += utf8_nstarts(w);
+    }
+    for (; i < len_b; ++i) {
+        res += (data[i] & 0xC0) != 0x80;
+    }
+
+    return res;
+}
+
+ks_size_t ks_utf8_ascii(ks_size_t len_b, const char* data) {
+    ks_size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 16 <= len_b; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + i)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+#endif
+
+    uint64_t w;
+    for (; i + 8 <= len_b; i += 8) {
+        memcpy(&w, data + i, 8);
+        if (w & UTF8_HI) break;
+    }
+    while (i < len_b && !(data[i] & 0x80)) i++;
+
+    return i;
+}
+
+ks_ssize_t ks_utf8_check(ks_size_t len_b, const char* data) {
+    const unsigned char* p = (const unsigned char*)data;
+    ks_size_t i = 0;
+    while (true) {
+        i += ks_utf8_ascii(len_b - i, data + i);
+        if (i >= len_b) return -1;
+
+        /* Check a single multi-byte sequence (see the Unicode Standard, table 3-7), where 'lo' and 'hi'
+         *   are the range of the second byte (which is narrower after some leading bytes, to exclude
+         *   overlong encodings, surrogates, and characters past U+10FFFF)
+         */
+        unsigned char c = p[i], lo = 0x80, hi = 0xBF;
+        int n;
+        if (c >= 0xC2 && c <= 0xDF) {
+            n = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            n = 3;
+            if (c == 0xE0) lo = 0xA0;
+            else if (c == 0xED) hi = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            n = 4;
+            if (c == 0xF0) lo = 0x90;
+            else if (c == 0xF4) hi = 0x8F;
+        } else {
+            return i;
+        }
+
+        if (len_b - i < n || p[i + 1] < lo || p[i + 1] > hi) return i;
+        int j;
+        for (j = 2; j < n; ++j) {
+            if ((p[i + j] & 0xC0) != 0x80) return i;
+        }
+        i += n;
+    }
+}
+
+/* Case conversion of ASCII bytes, which adds 'delta' to each byte in '[lo, hi]' */
+static void ascii_case(ks_size_t len_b, char* dest, const char* src, char lo, char hi, char delta) {
+    ks_size_t i = 0;
+
+#ifdef __SSE2__
+    /* Bytes '>= 0x80' are negative when signed, so they are never in the range */
+    __m128i L = _mm_set1_epi8(lo - 1), H = _mm_set1_epi8(hi + 1), D = _mm_set1_epi8(delta);
+    for (; i + 16 <= len_b; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i m = _mm_and_si128(_mm_cmpgt_epi8(v, L), _mm_cmplt_epi8(v, H));
+        _mm_storeu_si128((__m128i*)(dest + i), _mm_add_epi8(v, _mm_and_si128(m, D)));
+    }
+#endif
+
+    for (; i < len_b; ++i) {
+        char c = src[i];
+        dest[i] = (c >= lo && c <= hi) ? c + delta : c;
+    }
+}
+
+void ks_ascii_upper(ks_size_t len_b, char* dest, const char* src) {
+    ascii_case(len_b, dest, src, 'a', 'z', 'A' - 'a');
+}
+
+void ks_ascii_lower(ks_size_t len_b, char* dest, const char* src) {
+    ascii_case(len_b, dest, src, 'A', 'Z', 'a' - 'A');
+}
+
+
 /* Utilities for emscripten/other projects */
 
 void _ksem_incref_(kso obj) {
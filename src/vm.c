@@ -60,18 +60,127 @@
     KS_GIL_LOCK(); \
 } while(0)
 
+/* Take a profiling sample, if one was requested (see 'os/profile.c')
+ * This is a safe point, since we are between instructions and hold the GIL
+ */
+#define VM_CHECK_PROF() do { \
+    if (_ksos_profile_pending) _ksos_profile_sample(); \
+} while (0)
+
 /* Dispatch/Execution (VMD==Virtual Machine Dispatch) */
 
+#ifdef KS_VMSTATS
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define VMS_TSC() ((ks_uint)__rdtsc())
+#else
+  #define VMS_TSC() ((ks_uint)0)
+#endif
+
+struct ksvm_stats _ksvm_stats;
+
+/* Last instruction executed (on any frame), and when it started */
+static int vms_last_any = -1;
+static ks_uint vms_tsc = 0;
+
+/* Record that 'op' is being executed, where 'last' was the previous instruction in the same code */
+static int vms_op(int op, int* last) {
+    ks_uint now = VMS_TSC();
+    if (vms_last_any >= 0) _ksvm_stats.cycles[vms_last_any] += now - vms_tsc;
+    vms_tsc = now;
+    vms_last_any = op;
+
+    _ksvm_stats.count[op]++;
+    if (*last >= 0) _ksvm_stats.pair[*last][op]++;
+    *last = op;
+    return op;
+}
+
+/* Pair of instructions, for sorting */
+struct vms_pair {
+    int a, b;
+    ks_uint count;
+};
+
+static int vms_pair_cmp(const void* _L, const void* _R) {
+    const struct vms_pair* L = _L, *R = _R;
+    return L->count == R->count ? 0 : (L->count > R->count ? -1 : 1);
+}
+
+void _ksvm_stats_reset() {
+    memset(&_ksvm_stats, 0, sizeof(_ksvm_stats));
+    vms_last_any = -1;
+}
+
+void _ksvm_stats_dump(FILE* fp) {
+    ks_uint total = 0;
+    int i, j, k;
+    for (i = 0; i < 256; ++i) total += _ksvm_stats.count[i];
+    if (total == 0) total = 1;
+
+    /* Selection sort is fine here, since there are at most 256 */
+    bool used[256] = { 0 };
+    fprintf(fp, "[VM]: instructions (%llu total):\n", (unsigned long long)total);
+    for (k = 0; k < 256; ++k) {
+        int b = -1;
+        for (i = 0; i < 256; ++i) {
+            if (!used[i] && _ksvm_stats.count[i] > 0 && (b < 0 || _ksvm_stats.count[i] > _ksvm_stats.count[b])) b = i;
+        }
+        if (b < 0) break;
+        used[b] = true;
+        const char* name = ks_code_opname(b);
+        fprintf(fp, "  %-16s %12llu %6.2f%%", name ? name : "?", (unsigned long long)_ksvm_stats.count[b], 100.0 * _ksvm_stats.count[b] / total);
+        if (_ksvm_stats.cycles[b] > 0) {
+            fprintf(fp, " %10.1f cycles/op", (double)_ksvm_stats.cycles[b] / _ksvm_stats.count[b]);
+        }
+        fprintf(fp, "\n");
+    }
+
+    /* Top pairs */
+    struct vms_pair* pairs = ks_malloc(sizeof(*pairs) * 256 * 256);
+    int n = 0;
+    for (i = 0; i < 256; ++i) for (j = 0; j < 256; ++j) {
+        if (_ksvm_stats.pair[i][j] > 0) {
+            pairs[n].a = i;
+            pairs[n].b = j;
+            pairs[n].count = _ksvm_stats.pair[i][j];
+            n++;
+        }
+    }
+    qsort(pairs, n, sizeof(*pairs), vms_pair_cmp);
+
+    fprintf(fp, "[VM]: pairs:\n");
+    for (k = 0; k < n && k < 32; ++k) {
+        const char* na = ks_code_opname(pairs[k].a), *nb = ks_code_opname(pairs[k].b);
+        fprintf(fp, "  %-16s %-16s %12llu\n", na ? na : "?", nb ? nb : "?", (unsigned long long)pairs[k].count);
+    }
+    ks_free(pairs);
+}
+
+/* Starts the VMD */
+#define VMD_START while (true) switch (vms_op(*pc, &vms_last))
+
+/* Declare state used by statistics */
+#define VMS_DECL int vms_last = -1;
+
+#else
+
 /* Starts the VMD */
 #define VMD_START while (true) switch (*pc)
 
+/* Declare state used by statistics */
+#define VMS_DECL
+
+#endif
+
 /* Catches unknown instruction */
 #define VMD_CATCH_REST default: fprintf(stderr, "[VM]: Unknown instruction encountered in <code @ %p>: %i (offset: %i)\n", bc, *pc, (int)(pc - bc->bc->data)); assert(false); break;
 
 /* Consume the next instruction 
  * TODO: switch based on instructions or time
  */
-#define VMD_NEXT() VM_ALLOW_GIL(); goto disp;
+#define VMD_NEXT() VM_ALLOW_GIL(); VM_CHECK_PROF(); goto disp;
 
 /* Declare code for a given operator */
 #define VMD_OP(_op) case _op: pc += sizeof(ksb);
@@ -113,7 +222,7 @@ static bool is_typeinfo(ks_type tp, kso info, bool* out) {
  * This method does not add anything to the thread's stack frames (that should be
  *   done in the caller, for example in 'kso_call_ext()')
  */
-kso _ks_exec(ks_code bc, ks_type _in) {
+static kso vm_exec(ks_code bc, ks_type _in) {
     /* Thread we are executing on */
     ksos_thread th = ksos_thread_get();
     assert(th && th->frames->len > 0);
@@ -147,6 +256,8 @@ kso _ks_exec(ks_code bc, ks_type _in) {
     int i, j;
     ksos_frame fit;
 
+    VMS_DECL
+
 
     /* Argument, if the instruction gave one */
     int arg;
@@ -192,7 +303,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
                 goto thrown; \
             } \
         } else { \
-            if (!ks_dict_set_h(frame->locals, (kso)_name, _name->v_hash, (kso)_obj)) { \
+            if (!ks_dict_set_h(frame->locals, (kso)_name, KS_STR_HASH(_name), (kso)_obj)) { \
                 goto thrown; \
             } \
         } \
@@ -242,7 +353,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             fit = frame;
             do {
                 if (fit->locals) {
-                    V = ks_dict_get_ih(fit->locals, (kso)name, name->v_hash);
+                    V = ks_dict_get_ih(fit->locals, (kso)name, KS_STR_HASH(name));
                     if (V) {
                         /* Found in this scope, so push it and execute the next */
                         ks_list_pushu(stk, V);
@@ -254,7 +365,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             } while (fit != NULL);
 
             /* Now, check globals */
-            V = ks_dict_get_ih(ksg_globals, (kso)name, name->v_hash);
+            V = ks_dict_get_ih(ksg_globals, (kso)name, KS_STR_HASH(name));
 
             if (!V) {
                 KS_THROW(kst_NameError, "Unknown name: %R", name);
@@ -525,8 +636,21 @@ kso _ks_exec(ks_code bc, ks_type _in) {
                 tattr = tsz;
                 tsz += sizeof(ks_dict);
             }
+
+            /* Instances store attributes by shape, with the dictionary as a fallback (unless the base type is
+             *   implemented in C, and uses its dictionary directly)
+             */
+            int tslots = tbase->ob_slots;
+            if (tslots <= 0 && (tbase == kst_object || tbase->ob_attr < 0)) {
+                tslots = tsz;
+                tsz += sizeof(struct ks_slots);
+            }
             ks_type tnew = ks_type_new(((ks_str)tinfo->elems[0])->data, tbase, tsz, tattr, ((ks_str)tinfo->elems[1])->data, NULL);
             KS_DECREF(tbase);
+            if (tnew->ob_slots <= 0 && tslots > 0) {
+                tnew->ob_slots = tslots;
+                tnew->ob_shape = ks_shape_new();
+            }
 
             /* Execute the body */
             V = kso_call_ext(tbc, 1, (kso[]){ (kso)tnew }, tnew->attr, frame);
@@ -612,14 +736,9 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OP_END
 
         VMD_OPA(KSB_FOR_NEXTT)
-            V = kso_next(stk->elems[stk->len - 1]);
+            if (!kso_advance(stk->elems[stk->len - 1], &V)) goto thrown;
             if (!V) {
-                if (th->exc->type == kst_OutOfIterException) {
-                    kso_catch_ignore();
-                    ks_list_popu(stk);
-                } else {
-                    goto thrown;
-                }
+                ks_list_popu(stk);
             } else {
                 pc += arg;
                 ks_list_pushu(stk, V);
@@ -627,15 +746,10 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OP_END
 
         VMD_OPA(KSB_FOR_NEXTF)
-            V = kso_next(stk->elems[stk->len - 1]);
+            if (!kso_advance(stk->elems[stk->len - 1], &V)) goto thrown;
             if (!V) {
-                if (th->exc->type == kst_OutOfIterException) {
-                    kso_catch_ignore();
-                    ks_list_popu(stk);
-                    pc += arg;
-                } else {
-                    goto thrown;
-                }
+                ks_list_popu(stk);
+                pc += arg;
             } else {
                 ks_list_pushu(stk, V);
             }
@@ -755,7 +869,43 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OP_END
         
         /* Binary operators */
-        T_BOP(KSB_BOP_ADD, add)
+        VMD_OP(KSB_BOP_ADD)
+            R = ks_list_pop(stk);
+            L = ks_list_pop(stk);
+
+            /* Appending to a string (or bytes) can be done in place, if nothing else refers to it */
+            if (L->type == R->type && (L->type == kst_bytes || (L->type == kst_str && !((ks_str)L)->interned))) {
+                if (L->refs == 2 && *pc == KSB_STORE && _in == NULL && frame->locals) {
+                    /* For 's = s + x', the other reference is the variable being stored to, so drop it (since
+                     *   it is about to be replaced anyway)
+                     */
+                    name = (ks_str)VC(((ksba*)pc)->arg);
+                    V = ks_dict_get_ih(frame->locals, (kso)name, KS_STR_HASH(name));
+                    if (V == L && !ks_dict_set_h(frame->locals, (kso)name, KS_STR_HASH(name), KSO_NONE)) {
+                        KS_DECREF(V);
+                        KS_DECREF(L);
+                        KS_DECREF(R);
+                        goto thrown;
+                    }
+                    KS_NDECREF(V);
+                }
+                if (L->refs == 1) {
+                    if (L->type == kst_str) {
+                        _ks_str_append((ks_str)L, (ks_str)R);
+                    } else {
+                        _ks_bytes_append((ks_bytes)L, (ks_bytes)R);
+                    }
+                    KS_DECREF(R);
+                    ks_list_pushu(stk, L);
+                    VMD_NEXT();
+                }
+            }
+
+            V = ks_bop_add(L, R);
+            KS_DECREF(L); KS_DECREF(R);
+            if (!V) goto thrown;
+            ks_list_pushu(stk, V);
+        VMD_OP_END
         T_BOP(KSB_BOP_SUB, sub)
         T_BOP(KSB_BOP_MUL, mul)
         T_BOP(KSB_BOP_MATMUL, matmul)
@@ -849,5 +999,9 @@ kso _ks_exec(ks_code bc, ks_type _in) {
     #undef stk
 }
 
+kso _ks_exec(ks_code bc, ks_type _in) {
+    /* Go through the code's trampoline, so native profilers can see it (see 'perf.c') */
+    if (_ks_perf_active) return _ks_perf_exec(bc, _in, vm_exec);
 
-
+    return vm_exec(bc, _in);
+}